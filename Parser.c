@@ -1,5 +1,15 @@
 //supported tables - cmap, glyf, head, hhea, hmtx, kern, loca, maxp and OS/2
 
+//needed only by ParseFontFromMappedFile
+#if defined(_WIN32)
+    #include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 //(PUBLIC)
 
 const short CMAP_TABLE = 24;
@@ -33,7 +43,7 @@ struct CMAP_Subtable_Format0
     unsigned int Typograph; //(INTERNAL-CONSTANT)
     unsigned short Length; //length of the table in bytes
     unsigned short Language;
-    unsigned char GlyphIndexArray[256];
+    const unsigned char* GlyphIndexArray; //256 elements; borrowed from the font data
 };
 
 typedef struct CMAP_Subtable_Format0 CMAP_Subtable_Format0;
@@ -55,12 +65,13 @@ struct CMAP_Subtable_Format4
     unsigned short SearchRange;
     unsigned short EntrySelector;
     unsigned short RangeShift;
-    unsigned short* EndCode; //length = SegmentCount; end character code for every segment last=0xFFFF
+    //(BIG-ENDIAN) the arrays are [uint16] borrowed from the font data; they are decoded with BE16 on access
+    const unsigned char* EndCode; //length = SegmentCount; end character code for every segment last=0xFFFF
     unsigned short ReservedPad;
-    unsigned short* StartCode; //length = SegmentCount; begin character code for every segment
-    unsigned short* IndexDelta; //length = SegmentCount; delta for every character in a segment
-    unsigned short* IndexRangeOffsets;
-    unsigned short* GlyphIndexArray;
+    const unsigned char* StartCode; //length = SegmentCount; begin character code for every segment
+    const unsigned char* IndexDelta; //length = SegmentCount; delta for every character in a segment
+    const unsigned char* IndexRangeOffsets;
+    const unsigned char* GlyphIndexArray;
 };
 
 typedef struct CMAP_Subtable_Format4 CMAP_Subtable_Format4;
@@ -81,7 +92,7 @@ struct CMAP_Subtable_Format6
     unsigned short Language;
     unsigned short FirstCode; //begin character code in the range
     unsigned short EntryCount; //number of the character codes in the range
-    unsigned short* GlyphIndexArray;
+    const unsigned char* GlyphIndexArray; //(BIG-ENDIAN) [uint16] borrowed from the font data
 };
 
 typedef struct CMAP_Subtable_Format6 CMAP_Subtable_Format6;
@@ -110,7 +121,7 @@ struct CMAP_Subtable_Format12
     unsigned int Length; //length of the table in bytes
     unsigned int Language; //(SEE LANGUAGE_USE)
     unsigned int NumberOfGroups;
-    struct SequentialMapGroup** Groups;
+    const unsigned char* Groups; //(BIG-ENDIAN) NumberOfGroups * 12 bytes borrowed from the font data; decoded with GetSequentialMapGroup
 };
 
 typedef struct CMAP_Subtable_Format12 CMAP_Subtable_Format12;
@@ -143,7 +154,7 @@ struct KERN_Subtable_Format0
     unsigned short SearchRange;
     unsigned short EntrySelector;
     unsigned short RangeShift;
-    struct KerningPair* Pairs;
+    const unsigned char* Pairs; //(BIG-ENDIAN) NumberOfPairs * 6 bytes borrowed from the font data; decoded with GetKerningPair
 };
 
 typedef struct KERN_Subtable_Format0 KERN_Subtable_Format0;
@@ -162,6 +173,10 @@ struct CMAP_Table
     unsigned short Version;
     unsigned short NumberOfSubtables;
     void** Subtables;
+    //(INTERNAL) the sub-tables compiled in a codepoint -> glyph index map (see CompileCodepointMap); 0xFFFF :: no glyph
+    unsigned short* BasicPlane; //65536 elements; the glyph indexes for the codepoints in the Basic Multilingual Plane
+    unsigned short** CodepointPages; //4352 pages with 256 elements; page N contains the codepoints N * 256 .. N * 256 + 255
+    unsigned short* EmptyPage; //shared by all pages that don't contain any glyphs
 };
 
 typedef struct CMAP_Table CMAP_Table;
@@ -188,6 +203,48 @@ EmptyGlyph* P_EmptyGlyph()
     return glyph;
 }
 
+//(PUBLIC)
+//the size-independent topology of a contour of a simple glyph (see DetermineContourTopology)
+struct ContourTopology
+{
+    short MinX; //the bounding box of the points of the contour
+    short MinY;
+    short MaxX;
+    short MaxY;
+    short Container; //the index of the contour with the smallest bounding box that encloses the bounding box of this contour; -1 :: none
+    short Depth; //the number of the (direct and indirect) containers of the contour
+    bool IsClockwise; //in a well-formed glyph the clockwise contours are filled, and the counterclockwise contours are holes
+};
+
+typedef struct ContourTopology ContourTopology;
+
+//(PUBLIC)
+//a contour of a PreparedGlyph
+struct PreparedContour
+{
+    int FirstPoint; //the index of the first point of the contour in the arrays of the PreparedGlyph
+    int NumberOfPoints;
+    int TopologyIndex; //the index of the contour in the SimpleGlyph (and in its Topology)
+};
+
+typedef struct PreparedContour PreparedContour;
+
+//(PUBLIC)
+/* the outline of a simple glyph in the form used for drawing (see PrepareGlyph); it doesn't depend on the size and the position of the glyph -
+   the contours with one point are removed, every contour begins with an ON point, and there is an explicit ON point in the middle of every
+   two consecutive OFF points, so every segment is a line (ON, ON) or a quadratic Bezier curve (ON, OFF, ON) */
+struct PreparedGlyph
+{
+    int NumberOfContours;
+    int NumberOfPoints;
+    PreparedContour* Contours;
+    float* X_Coordinates; //in font units; the inserted ON points can be in the middle of a unit, so the coordinates are multiples of 0.5
+    float* Y_Coordinates;
+    unsigned char* Flags; //1 :: ON point | 0 :: OFF point
+};
+
+typedef struct PreparedGlyph PreparedGlyph;
+
 //(PUBLIC)
 struct SimpleGlyph
 {
@@ -202,6 +259,8 @@ struct SimpleGlyph
     short* X_Coordinates;
     short* Y_Coordinates;
     unsigned short NumberOfPoints; //= EndPointsOfContours[NumberOfContours - 1] + 1
+    ContourTopology* Topology; //one element for every contour; it's determined when the glyph is extracted (NULL :: not determined)
+    PreparedGlyph* Prepared; //it's prepared when the glyph is extracted (NULL :: not prepared)
 };
 
 typedef struct SimpleGlyph SimpleGlyph;
@@ -210,6 +269,8 @@ SimpleGlyph* P_SimpleGlyph()
 {
     SimpleGlyph* glyph = malloc(sizeof(SimpleGlyph));
     glyph->Typograph = 0b01100101000000000000000000000000;
+    glyph->Topology = NULL;
+    glyph->Prepared = NULL;
     return glyph;
 }
 
@@ -250,7 +311,7 @@ struct CompositeGlyph
     short MinY;
     short MaxX;
     short MaxY;
-    GlyphComponent** Components; //[GlyphComponent]
+    GlyphComponent* Components; //[GlyphComponent]
     unsigned short NumberOfComponents;
 };
 
@@ -263,17 +324,46 @@ CompositeGlyph* P_CompositeGlyph()
     return glyph;
 }
 
+//(PRIVATE)
+/* storage for the extracted glyphs - the glyph objects and their arrays are allocated one after another in few large blocks, instead of
+   separately with malloc; the blocks are never moved, so the pointers into them remain valid until the arena is released or compacted */
+struct GlyphArena
+{
+    unsigned char** Blocks;
+    int NumberOfBlocks;
+    size_t BlockSize; //the size (in bytes) of the last block
+    size_t BlockUsage; //the used bytes in the last block
+    size_t Usage; //the used bytes in all blocks
+};
+
+typedef struct GlyphArena GlyphArena;
+
 //(PUBLIC)
 struct GLYF_Table
 {
     unsigned int Typograph; //(INTERNAL-CONSTANT)
     short NumberOfContours;
-    void** Glyphs; //[SimpleGlyph & CompositeGlyph]
-    short NumberOfGlyphs;
+    //[EmptyGlyph & SimpleGlyph & CompositeGlyph]; a glyph is decoded on its first access (see GetGlyphByIndex), until then it's NULL
+    void** Glyphs;
+    unsigned short NumberOfGlyphs;
     int X_Min;
     int Y_Min;
     int X_Max;
     int Y_Max;
+    //(INTERNAL) the location of the glyph data
+    const unsigned char* FontData;
+    size_t FontDataSize;
+    unsigned int Offset; //the position of the table in the font data
+    const struct LOCA_Table* Loca;
+    //(INTERNAL) used by TrimGlyphs; LastAccess[n] is the value of AccessClock at the last access of glyph n
+    unsigned int* LastAccess;
+    unsigned int AccessClock;
+    bool IsShared; //(INTERNAL) set by LoadAllGlyphs - the accesses are not tracked, so the glyphs can be read by multiple threads
+    GlyphArena Arena; //(INTERNAL) contains the extracted glyphs
+    //(INTERNAL) the offsets of the glyph records in the baked file (see LoadBakedFont); 0 :: the glyph is extracted from the font data
+    unsigned long long* BakedGlyphs; //NULL :: the font is not baked
+    unsigned char* BakedData;
+    size_t BakedDataSize;
 };
 
 typedef struct GLYF_Table GLYF_Table;
@@ -370,6 +460,14 @@ struct KERN_Table
     unsigned short Version;
     unsigned short NumberOfSubtables;
     void** Subtables;
+    //(INTERNAL) an index of the kerning-pairs in the first sub-table (see IndexKerningPairs)
+    unsigned int* PairKeys; //(Left << 16) | Right, in ascending order
+    short* PairValues;
+    int NumberOfIndexedPairs;
+    //(INTERNAL) a matrix with the pairs of the (up to) 128 glyphs that take part in most pairs
+    unsigned char* FrequentGlyphs; //65536 elements; glyph index -> row/column in FrequentPairValues; 0xFF :: not in the matrix
+    short* FrequentPairValues; //128 x 128
+    unsigned char* FrequentPairPresence; //128 x 128 bits; bit (row * 128 + column) is set if the pair exists
 };
 
 typedef struct KERN_Table KERN_Table;
@@ -411,7 +509,7 @@ HMTX_Table* P_HMTX_Table()
 struct LOCA_Table
 {
     unsigned int Typograph; //(INTERNAL-CONSTANT)
-    void* Offsets; //[uint16] | [uint32]
+    const unsigned char* Offsets; //(BIG-ENDIAN) [uint16] | [uint32] borrowed from the font data; decoded with GetGlyphOffset
     int ArrayType; //0 :: [uint16] | 1 :: [uint32]
 };
 
@@ -514,11 +612,32 @@ struct Font
 {
     int SFNT_VERSION;
     int NumberOfTables;
-    void** Tables;
+    void** Tables; //in the order of the table directory; NULL :: unsupported table
+    void* TableSlots[10]; //(INTERNAL) the table with identifier X (CMAP_TABLE..VHEA_TABLE) is in slot (X - CMAP_TABLE); NULL :: no such table
+    //the font file; the tables keep pointers into it, so it has to stay valid until ReleaseFont
+    const unsigned char* Data;
+    size_t DataSize;
+    int DataOwnership; //0 :: borrowed from the caller | 1 :: allocated by ParseFont | 2 :: mapped by ParseFontFromMappedFile | 3 :: a part of Baked
+    //(INTERNAL) the file loaded by LoadBakedFont (mapped copy-on-write); the compiled/decoded arrays of the tables are in it; NULL :: not baked
+    unsigned char* Baked;
+    size_t BakedSize;
+    //(INTERNAL) unique for every parsed font, so the caches of the rasterizer don't confuse two fonts that are allocated at the same address
+    unsigned int Serial;
 };
 
 typedef struct Font Font;
 
+//(PRIVATE)
+//a cursor over the font data; reading past the end of the data yields zeros
+struct FontStream
+{
+    const unsigned char* Data;
+    size_t Size;
+    size_t Position;
+};
+
+typedef struct FontStream FontStream;
+
 //_index >= 0 || _index <= 31 ->
 bool GetBit(unsigned int _number, int _index)
 {
@@ -528,378 +647,1484 @@ bool GetBit(unsigned int _number, int _index)
 }
 
 //(PRIVATE)
-unsigned char ReadI8(FILE* _file)
+//decodes a big-endian uint16 located at _bytes
+unsigned short BE16(const unsigned char* _bytes)
 {
-    return fgetc(_file);
+    return (_bytes[0] << 8) | _bytes[1];
 }
 
 //(PRIVATE)
-unsigned short ReadI16(FILE* _file)
+//decodes a big-endian uint32 located at _bytes
+unsigned int BE32(const unsigned char* _bytes)
 {
-    unsigned char byte1 = fgetc(_file);
-    unsigned char byte2 = fgetc(_file);
-    return byte2 | (byte1 << 8);
+    return ((unsigned int)_bytes[0] << 24) | ((unsigned int)_bytes[1] << 16) | ((unsigned int)_bytes[2] << 8) | _bytes[3];
 }
 
 //(PRIVATE)
-unsigned int ReadI32(FILE* _file)
+void Seek(FontStream* _stream, size_t _position)
 {
-    unsigned char byte1 = fgetc(_file);
-    unsigned char byte2 = fgetc(_file);
-    unsigned char byte3 = fgetc(_file);
-    unsigned char byte4 = fgetc(_file);
-    return (byte1 << 24) | (byte2 << 16) | (byte3 << 8) | byte4;
+    _stream->Position = _position;
 }
 
 //(PRIVATE)
-unsigned long long ReadI64(FILE* _file)
-{
-    unsigned char byte1 = fgetc(_file);
-    unsigned char byte2 = fgetc(_file);
-    unsigned char byte3 = fgetc(_file);
-    unsigned char byte4 = fgetc(_file);
-    unsigned char byte5 = fgetc(_file);
-    unsigned char byte6 = fgetc(_file);
-    unsigned char byte7 = fgetc(_file);
-    unsigned char byte8 = fgetc(_file);
-    return ((unsigned long long)byte1 << 56) |
-           ((unsigned long long)byte2 << 48) |
-           ((unsigned long long)byte3 << 40) |
-           ((unsigned long long)byte4 << 32) |
-           ((unsigned long long)byte5 << 24) |
-           ((unsigned long long)byte6 << 16) |
-           ((unsigned long long)byte7 << 8) |
-            (unsigned long long)byte8;
+void Skip(FontStream* _stream, size_t _length)
+{
+    _stream->Position += _length;
 }
 
 //(PRIVATE)
-void* ExtractSimpleGlyph(FILE* _file, short _numberOfContours)
+//returns a pointer to the next _length bytes in the stream and skips them (no copy is made)
+//the stream does not contain _length more bytes => NULL
+const unsigned char* Borrow(FontStream* _stream, size_t _length)
 {
-    SimpleGlyph* glyph = P_SimpleGlyph();
+    if (_stream->Position > _stream->Size || _length > _stream->Size - _stream->Position)
+    {
+        return NULL;
+    }
 
-    glyph->NumberOfContours = _numberOfContours;
-    glyph->MinX = ReadI16(_file);
-    glyph->MinY = ReadI16(_file);
-    glyph->MaxX = ReadI16(_file);
-    glyph->MaxY = ReadI16(_file);
-    glyph->NumberOfContours = _numberOfContours;
+    const unsigned char* bytes = _stream->Data + _stream->Position;
+    _stream->Position += _length;
+    return bytes;
+}
 
-    glyph->EndPointsOfContours = malloc(sizeof(unsigned short) * _numberOfContours);
-    for (int i = 0; i < _numberOfContours; i++)
-        glyph->EndPointsOfContours[i] = ReadI16(_file);
+//(PRIVATE)
+unsigned char ReadI8(FontStream* _stream)
+{
+    if (_stream->Position >= _stream->Size)
+    {
+        _stream->Position++;
+        return 0;
+    }
 
-    int instructionLength = ReadI16(_file);
+    return _stream->Data[_stream->Position++];
+}
 
-    //ignoring the instructions
-    fseek(_file, ftell(_file) + instructionLength, SEEK_SET);
+//(PRIVATE)
+unsigned short ReadI16(FontStream* _stream)
+{
+    if (_stream->Position + 2 > _stream->Size)
+    {
+        unsigned char byte1 = ReadI8(_stream);
+        unsigned char byte2 = ReadI8(_stream);
+        return byte2 | (byte1 << 8);
+    }
 
-    ///reading the flags
+    unsigned short value = BE16(_stream->Data + _stream->Position);
+    _stream->Position += 2;
+    return value;
+}
 
-    //total number of points for every contour in the glyph
-    int numberOfPointsInContours = glyph->EndPointsOfContours[_numberOfContours - 1] + 1;
+//(PRIVATE)
+unsigned int ReadI32(FontStream* _stream)
+{
+    if (_stream->Position + 4 > _stream->Size)
+    {
+        unsigned int word1 = ReadI16(_stream);
+        unsigned int word2 = ReadI16(_stream);
+        return (word1 << 16) | word2;
+    }
 
-    glyph->NumberOfPoints = numberOfPointsInContours;
+    unsigned int value = BE32(_stream->Data + _stream->Position);
+    _stream->Position += 4;
+    return value;
+}
 
-    int numberOfFlags = 0;
+//(PRIVATE)
+unsigned long long ReadI64(FontStream* _stream)
+{
+    unsigned long long high = ReadI32(_stream);
+    unsigned long long low = ReadI32(_stream);
+    return (high << 32) | low;
+}
 
-    glyph->Flags = malloc(sizeof(unsigned char) * numberOfPointsInContours);
+//(PRIVATE)
+//_index < _subtable->NumberOfGroups ->
+SequentialMapGroup GetSequentialMapGroup(const CMAP_Subtable_Format12* _subtable, int _index)
+{
+    const unsigned char* bytes = _subtable->Groups + _index * 12;
+    SequentialMapGroup group;
+    group.StartCharacterCode = BE32(bytes);
+    group.EndCharacterCode = BE32(bytes + 4);
+    group.StartGlyphIndex = BE32(bytes + 8);
+    return group;
+}
 
-    while (true)
-    {
-        unsigned char flags = ReadI8(_file);
-        glyph->Flags[numberOfFlags++] = flags;
+//(LOCAL-TO CompileCodepointMap)
+//_glyphIndex == -1 :: the codepoint has no glyph
+void setCodepointGlyph(CMAP_Table* _cmap, int _codepoint, int _glyphIndex)
+{
+    unsigned short* page = _cmap->CodepointPages[_codepoint >> 8];
 
-        //if the flag is repeated
-        if (GetBit(flags, 3) == true)
+    if (page == _cmap->EmptyPage)
+    {
+        if (_glyphIndex == -1)
         {
-            unsigned char numberOfRepetitions = ReadI8(_file);
-
-            //repeating the flag
-            for (int m = 0; m < numberOfRepetitions; m++)
-            {
-                glyph->Flags[numberOfFlags++] = flags;
-            }
+            return;
         }
 
-        if (numberOfFlags == numberOfPointsInContours) break;
+        page = malloc(sizeof(unsigned short) * 256);
+        for (int i = 0; i < 256; i++)
+            page[i] = 0xFFFF;
+        _cmap->CodepointPages[_codepoint >> 8] = page;
     }
 
-    ///reading the X-coordinates
+    page[_codepoint & 255] = _glyphIndex == -1 ? 0xFFFF : _glyphIndex;
+}
 
-    glyph->X_Coordinates = malloc(sizeof(short) * numberOfPointsInContours);
+//(PRIVATE)
+/* compiles the sub-tables of _cmap in a map (codepoint -> glyph index), so GetGlyphIndex doesn't have to walk the sub-tables;
+   the result for every codepoint is the same as the result of GetGlyphIndexFromSubtables */
+void CompileCodepointMap(CMAP_Table* _cmap)
+{
+    _cmap->BasicPlane = malloc(sizeof(unsigned short) * 65536);
+    _cmap->EmptyPage = malloc(sizeof(unsigned short) * 256);
+    _cmap->CodepointPages = malloc(sizeof(unsigned short*) * 4352);
+
+    for (int i = 0; i < 65536; i++)
+        _cmap->BasicPlane[i] = 0xFFFF;
+    for (int i = 0; i < 256; i++)
+        _cmap->EmptyPage[i] = 0xFFFF;
+    //the pages of the Basic Multilingual Plane are views into BasicPlane
+    for (int i = 0; i < 256; i++)
+        _cmap->CodepointPages[i] = _cmap->BasicPlane + i * 256;
+    for (int i = 256; i < 4352; i++)
+        _cmap->CodepointPages[i] = _cmap->EmptyPage;
+
+    /* (A) GetGlyphIndexFromSubtables uses the last sub-table that maps (the codepoint to a glyph index or to 'missing glyph'); formats 6 and 12
+           map every codepoint, so the sub-tables before the last one of them are never used; the sub-tables after it are applied in order,
+           each overwriting only the codepoints it maps (format 4 - the codepoints up to its last end code, format 0 - the codepoints below 256) */
+    int firstSubtable = 0;
+
+    for (int i = _cmap->NumberOfSubtables - 1; i > -1; i--)
+    {
+        if (_cmap->Subtables[i] != NULL && (Is(_cmap->Subtables[i], CMAP_SUBTABLE_FORMAT6) || Is(_cmap->Subtables[i], CMAP_SUBTABLE_FORMAT12)))
+        {
+            firstSubtable = i;
+            break;
+        }
+    }
 
-    for (int n = 0; n < numberOfPointsInContours; n++)
+    for (int i = firstSubtable; i < _cmap->NumberOfSubtables; i++)
     {
-        //if the X-coordinate is 1 byte
-        if (GetBit(glyph->Flags[n], 1) == true)
+        if (_cmap->Subtables[i] == NULL)
         {
-            unsigned char value = ReadI8(_file);
+            continue;
+        }
+        else if (Is(_cmap->Subtables[i], CMAP_SUBTABLE_FORMAT12))
+        {
+            CMAP_Subtable_Format12* subtable = (CMAP_Subtable_Format12*) _cmap->Subtables[i];
 
-            if (GetBit(glyph->Flags[n], 4) == false)
-            {
-                glyph->X_Coordinates[n] = (n == 0 ? 0 : glyph->X_Coordinates[n - 1]) - value;
-            }
-            else
+            //(NOTE) GetGlyphIndexFromSubtables uses the first group containing the codepoint, so the groups are applied in reverse order
+            for (int n = subtable->NumberOfGroups - 1; n > -1; n--)
             {
-                glyph->X_Coordinates[n] = (n == 0 ? 0 : glyph->X_Coordinates[n - 1]) + value;
+                SequentialMapGroup group = GetSequentialMapGroup(subtable, n);
+
+                for (unsigned int codepoint = group.StartCharacterCode; codepoint <= group.EndCharacterCode && codepoint <= 0x10FFFF; codepoint++)
+                {
+                    setCodepointGlyph(_cmap, codepoint, (group.StartGlyphIndex + codepoint - group.StartCharacterCode) % 65536);
+                }
             }
         }
-        //(STATE) the X-coordinate is 2 bytes
-        else
+        else if (Is(_cmap->Subtables[i], CMAP_SUBTABLE_FORMAT6))
         {
-            if (GetBit(glyph->Flags[n], 4) == true)
-            {
-                glyph->X_Coordinates[n] = n == 0 ? 0 : glyph->X_Coordinates[n - 1];
-            }
-            else
+            CMAP_Subtable_Format6* subtable = (CMAP_Subtable_Format6*) _cmap->Subtables[i];
+
+            for (int n = 0; n < subtable->EntryCount && subtable->FirstCode + n < 65536; n++)
             {
-                glyph->X_Coordinates[n] = (n == 0 ? 0 : glyph->X_Coordinates[n - 1]) + ReadI16(_file);
+                _cmap->BasicPlane[subtable->FirstCode + n] = BE16(subtable->GlyphIndexArray + n * 2);
             }
         }
-    }
+        else if (Is(_cmap->Subtables[i], CMAP_SUBTABLE_FORMAT4))
+        {
+            CMAP_Subtable_Format4* subtable = (CMAP_Subtable_Format4*) _cmap->Subtables[i];
 
-    //reading the Y-coordinates
+            int segmentCount = subtable->SegmentCountX2 / 2;
+            int glyphIndexArrayCount = (subtable->Length - (16 + 4 * (segmentCount * 2))) / 2;
+            int previousEndCode = -1;
 
-    glyph->Y_Coordinates = malloc(sizeof(short) * numberOfPointsInContours);
+            for (int n = 0; n < segmentCount; n++)
+            {
+                int endCode = BE16(subtable->EndCode + n * 2);
+                int startCode = BE16(subtable->StartCode + n * 2);
+                unsigned short indexDelta = BE16(subtable->IndexDelta + n * 2);
+                unsigned short indexRangeOffset = BE16(subtable->IndexRangeOffsets + n * 2);
 
-    for (int n = 0; n < numberOfPointsInContours; n++)
-    {
-        //if the Y-coordinate is 1 byte
-        if (GetBit(glyph->Flags[n], 2) == true)
-        {
-            unsigned char value = ReadI8(_file);
+                //the codepoints between the previous segment and this one map to 'missing glyph'
+                for (int codepoint = previousEndCode + 1; codepoint <= endCode; codepoint++)
+                {
+                    int glyphIndex = -1;
 
-            if (GetBit(glyph->Flags[n], 5) == false)
-            {
-                glyph->Y_Coordinates[n] = (n == 0 ? 0 : glyph->Y_Coordinates[n - 1]) - value;
-            }
-            else
-            {
-                glyph->Y_Coordinates[n] = (n == 0 ? 0 : glyph->Y_Coordinates[n - 1]) + value;
+                    if (codepoint >= startCode && indexRangeOffset != 0)
+                    {
+                        int glyphIndexArrayIndex = (indexRangeOffset / 2) - (segmentCount - n) + (codepoint - startCode);
+
+                        if (glyphIndexArrayIndex >= 0 && glyphIndexArrayIndex < glyphIndexArrayCount)
+                        {
+                            unsigned short glyphIndex_ = BE16(subtable->GlyphIndexArray + glyphIndexArrayIndex * 2);
+                            glyphIndex = glyphIndex_ != 0 ? (glyphIndex_ + indexDelta) % 65536 : -1;
+                        }
+                    }
+                    else if (codepoint >= startCode)
+                    {
+                        glyphIndex = (indexDelta + codepoint) % 65536;
+                    }
+
+                    _cmap->BasicPlane[codepoint] = glyphIndex == -1 ? 0xFFFF : glyphIndex;
+                }
+
+                if (endCode > previousEndCode)
+                {
+                    previousEndCode = endCode;
+                }
             }
         }
-            //(STATE) if Y-coordinate is 2 bytes
-        else
+        else if (Is(_cmap->Subtables[i], CMAP_SUBTABLE_FORMAT0))
         {
-            if (GetBit(glyph->Flags[n], 5) == true)
-            {
-                glyph->Y_Coordinates[n] = n == 0 ? 0 : glyph->Y_Coordinates[n - 1];
-            }
-            else
+            CMAP_Subtable_Format0* subtable = (CMAP_Subtable_Format0*) _cmap->Subtables[i];
+
+            for (int n = 0; n < 256; n++)
             {
-                glyph->Y_Coordinates[n] = (n == 0 ? 0 : glyph->Y_Coordinates[n - 1]) + ReadI16(_file);
+                _cmap->BasicPlane[n] = subtable->GlyphIndexArray[n];
             }
         }
     }
-
-    return (void*) glyph;
 }
 
-//(LOCAL-TO extend)
-//it copies segment (from _source to _destination) (beginning at_sourceBegin and ending at _sourceEnd)
-void copyRange(GlyphComponent* _source, GlyphComponent* _destination, int _sourceLength, int _destinationLength,
-int _sourceBegin, int _sourceEnd, int _destinationBegin)
-{
-    for (int n = 0; ; n++)
-    {
-        if (_destinationBegin + n == _destinationLength)
-        {
-            break;
-        }
-        else if (_sourceBegin + n == _sourceLength)
-        {
-            break;
-        }
-        else if (_sourceBegin + n > _sourceEnd)
-        {
-            break;
-        }
-
-        _destination[_destinationBegin + n] = _source[_sourceBegin + n];
-    }
+//(PUBLIC)
+//_index < _subtable->NumberOfPairs ->
+KerningPair GetKerningPair(const KERN_Subtable_Format0* _subtable, int _index)
+{
+    const unsigned char* bytes = _subtable->Pairs + _index * 6;
+    KerningPair pair;
+    pair.Left = BE16(bytes);
+    pair.Right = BE16(bytes + 2);
+    pair.Value = BE16(bytes + 4);
+    return pair;
 }
 
-//(LOCAL-TO ExtractCompositeGlyph)
-//_length specifies the length of _array
-//extend([1, 2, 3, 4, 5], 5, 2) >> [1, 2, 3, 4, 5, x, x]
-void extend(GlyphComponent* _array, int _length, int _extensor)
+//(LOCAL-TO IndexKerningPairs)
+struct IndexedKerningPair
 {
-    int newLength = _length + _extensor;
+    unsigned int Key; //(Left << 16) | Right
+    int Order; //position in the sub-table
+    short Value;
+};
 
-    GlyphComponent* newArray = malloc(sizeof(GlyphComponent) * newLength);
+typedef struct IndexedKerningPair IndexedKerningPair;
 
-    copyRange(_array, newArray, _length, newLength, 0, _length - 1, 0);
+//(LOCAL-TO IndexKerningPairs)
+//orders the pairs by key, and the pairs with equal keys by their position in the sub-table
+int compareKerningPairs(const void* _pair1, const void* _pair2)
+{
+    const IndexedKerningPair* pair1 = (const IndexedKerningPair*) _pair1;
+    const IndexedKerningPair* pair2 = (const IndexedKerningPair*) _pair2;
 
-    free(_array);
+    if (pair1->Key != pair2->Key)
+    {
+        return pair1->Key < pair2->Key ? -1 : 1;
+    }
 
-    _array = newArray;
+    return pair1->Order - pair2->Order;
 }
 
-//(PRIVATE)
-//(RECURSIVE)
-void* ExtractCompositeGlyph(FILE* _file)
+//(LOCAL-TO IndexKerningPairs)
+//orders the glyphs by descending frequency, and the glyphs with equal frequency by ascending glyph index
+int compareGlyphFrequencies(const void* _glyph1, const void* _glyph2)
 {
-    CompositeGlyph* glyph = P_CompositeGlyph();
+    const int* glyph1 = (const int*) _glyph1; //[glyph index, frequency]
+    const int* glyph2 = (const int*) _glyph2;
 
-    glyph->MinX = ReadI16(_file);
-    glyph->MinY = ReadI16(_file);
-    glyph->MaxX = ReadI16(_file);
-    glyph->MaxY = ReadI16(_file);
-
-    int size = 20;
+    if (glyph1[1] != glyph2[1])
+    {
+        return glyph2[1] - glyph1[1];
+    }
 
-    GlyphComponent** components = malloc(sizeof(GlyphComponent*) * size);
-    int componentCount = 0;
+    return glyph1[0] - glyph2[0];
+}
 
-    //while there are more sub-glyphs
-    while (true)
+//(PRIVATE)
+/* builds the kerning index of _kern - the pairs of the first sub-table sorted by key (for binary search), and a dense matrix
+   with the pairs of the most frequent glyphs; as the format requires, the pairs in the file are sorted, so usually they are only
+   validated; if a pair is present more than once, only its first occurrence is used (as in a linear search) */
+void IndexKerningPairs(KERN_Table* _kern)
+{
+    _kern->PairKeys = NULL;
+    _kern->PairValues = NULL;
+    _kern->NumberOfIndexedPairs = 0;
+    _kern->FrequentGlyphs = NULL;
+    _kern->FrequentPairValues = NULL;
+    _kern->FrequentPairPresence = NULL;
+
+    if (_kern->NumberOfSubtables == 0 || _kern->Subtables[0] == NULL || ((KERN_Subtable_Format0*) _kern->Subtables[0])->NumberOfPairs == 0)
     {
-        GlyphComponent* component = P_GlyphComponent();
-        component->Flags = ReadI16(_file);
-        component->GlyphIndex = ReadI16(_file);
+        return;
+    }
 
-        bool flags_bit_0 = GetBit(component->Flags, 0);
-        bool flags_bit_1 = GetBit(component->Flags, 1);
+    KERN_Subtable_Format0* subtable = (KERN_Subtable_Format0*) _kern->Subtables[0];
 
-        component->ArgumentMode = flags_bit_1;
+    int numberOfPairs = subtable->NumberOfPairs;
+    unsigned int* keys = malloc(sizeof(unsigned int) * numberOfPairs);
+    short* values = malloc(sizeof(short) * numberOfPairs);
+    bool isSorted = true;
 
-        if (flags_bit_0 == false && flags_bit_1 == false)
-        {
-            component->Argument1 = ReadI8(_file);
-            component->Argument2 = ReadI8(_file);
-        }
-        else if (flags_bit_0 == false && flags_bit_1 == true)
-        {
-            component->Argument1 = (char)ReadI8(_file);
-            component->Argument2 = (char)ReadI8(_file);
-        }
-        else if (flags_bit_0 == true && flags_bit_1 == false)
-        {
-            component->Argument1 = ReadI16(_file);
-            component->Argument2 = ReadI16(_file);
-        }
-        else if (flags_bit_0 == true && flags_bit_1 == true)
+    for (int i = 0; i < numberOfPairs; i++)
+    {
+        KerningPair pair = GetKerningPair(subtable, i);
+        keys[i] = ((unsigned int) pair.Left << 16) | pair.Right;
+        values[i] = pair.Value;
+
+        if (i > 0 && keys[i] <= keys[i - 1])
         {
-            component->Argument1 = (short)ReadI16(_file);
-            component->Argument2 = (short)ReadI16(_file);
+            isSorted = false;
         }
+    }
 
-        //transformation fields
+    //(STATE) the pairs are not sorted or there are duplicates
+    if (!isSorted)
+    {
+        IndexedKerningPair* pairs = malloc(sizeof(IndexedKerningPair) * numberOfPairs);
 
-        //'simple' scaling (SOURCE:MICROSOFT)
-        if (GetBit(component->Flags, 3) == true)
+        for (int i = 0; i < numberOfPairs; i++)
         {
-            component->Scale[0] = ReadI16(_file);
+            pairs[i].Key = keys[i];
+            pairs[i].Order = i;
+            pairs[i].Value = values[i];
         }
-            //X and Y scaling
-        else if (GetBit(component->Flags, 6) == true)
-        {
-            component->Scale[0] = ReadI16(_file);
-            component->Scale[1] = ReadI16(_file);
-        }
-            //2x2 scaling
-        else if (GetBit(component->Flags, 7) == true)
-        {
-            component->Scale[0] = ReadI16(_file);
-            component->Scale[1] = ReadI16(_file);
-            component->Scale[2] = ReadI16(_file);
-            component->Scale[3] = ReadI16(_file);
-        } //
 
-        component->UseMetrics = GetBit(component->Flags, 9);
+        qsort(pairs, numberOfPairs, sizeof(IndexedKerningPair), compareKerningPairs);
 
-        components[componentCount++] = component;
+        int uniquePairs = 0;
 
-        if (componentCount == size)
+        for (int i = 0; i < numberOfPairs; i++)
         {
-            extend(*components, size, size / 2);
+            if (uniquePairs == 0 || pairs[i].Key != keys[uniquePairs - 1])
+            {
+                keys[uniquePairs] = pairs[i].Key;
+                values[uniquePairs] = pairs[i].Value;
+                uniquePairs++;
+            }
         }
 
-        //if there are instructions for &glyph following (if present, they're always located after the last sub-glyph in the parent composite glyph)
-        if (GetBit(component->Flags, 8) == true)
-        {
-            unsigned short numberOfInstructions = ReadI16(_file);
+        free(pairs);
+        numberOfPairs = uniquePairs;
+    }
 
-            //ignoring the instructions
-            fseek(_file, ftell(_file) + numberOfInstructions, SEEK_SET);
-        }
+    _kern->PairKeys = keys;
+    _kern->PairValues = values;
+    _kern->NumberOfIndexedPairs = numberOfPairs;
 
-        //(STATE) if there are no more sub-glyphs
-        if (GetBit(component->Flags, 5) == false)
-        {
-            break;
-        }
+    ///BUILDING THE MATRIX
+
+    int* frequencies = malloc(sizeof(int) * 65536);
+    for (int i = 0; i < 65536; i++)
+        frequencies[i] = 0;
+
+    for (int i = 0; i < numberOfPairs; i++)
+    {
+        frequencies[keys[i] >> 16]++;
+        frequencies[keys[i] & 0xFFFF]++;
     }
 
-    glyph->Components = malloc(sizeof(GlyphComponent) * componentCount);
+    int numberOfGlyphs = 0;
+    int* glyphs = malloc(sizeof(int) * 2 * 65536); //[glyph index, frequency]
 
-    for (int i = 0; i < componentCount; i++)
+    for (int i = 0; i < 65536; i++)
     {
-        glyph->Components[i] = components[i];
+        if (frequencies[i] > 0)
+        {
+            glyphs[numberOfGlyphs * 2] = i;
+            glyphs[numberOfGlyphs * 2 + 1] = frequencies[i];
+            numberOfGlyphs++;
+        }
     }
 
-    glyph->NumberOfComponents = componentCount;
+    qsort(glyphs, numberOfGlyphs, sizeof(int) * 2, compareGlyphFrequencies);
 
-    free(components);
+    _kern->FrequentGlyphs = malloc(65536);
+    for (int i = 0; i < 65536; i++)
+        _kern->FrequentGlyphs[i] = 0xFF;
+    for (int i = 0; i < numberOfGlyphs && i < 128; i++)
+        _kern->FrequentGlyphs[glyphs[i * 2]] = i;
 
-    return (void*) glyph;
-}
+    _kern->FrequentPairValues = malloc(sizeof(short) * 128 * 128);
+    _kern->FrequentPairPresence = malloc(128 * 128 / 8);
+    for (int i = 0; i < 128 * 128 / 8; i++)
+        _kern->FrequentPairPresence[i] = 0;
 
-//(PUBLIC)
-void* GetTable(const Font* _font, short _identifier)
-{
-    for (int i = 0; i < _font->NumberOfTables; i++)
+    for (int i = 0; i < numberOfPairs; i++)
     {
-        if (_font->Tables[i] != NULL && Is(_font->Tables[i], _identifier))
+        int row = _kern->FrequentGlyphs[keys[i] >> 16];
+        int column = _kern->FrequentGlyphs[keys[i] & 0xFFFF];
+
+        if (row != 0xFF && column != 0xFF)
         {
-            return _font->Tables[i];
+            _kern->FrequentPairValues[row * 128 + column] = values[i];
+            _kern->FrequentPairPresence[(row * 128 + column) >> 3] |= 1 << ((row * 128 + column) & 7);
         }
     }
 
-    return NULL;
+    free(glyphs);
+    free(frequencies);
 }
 
-//(PUBLIC)
-//_file is a valid file object ->
-Font* ParseFont(FILE* _file)
+//(PRIVATE)
+//returns the position (in bytes, relative to the beginning of table glyf) of the specified glyph
+//_glyphIndex <= NumberOfGlyphs ->
+unsigned int GetGlyphOffset(const LOCA_Table* _loca, int _glyphIndex)
 {
-    Font* font = malloc(sizeof(Font));
+    if (_loca->ArrayType == 0)
+    {
+        return BE16(_loca->Offsets + _glyphIndex * 2) * 2;
+    }
+    else
+    {
+        return BE32(_loca->Offsets + _glyphIndex * 4);
+    }
+}
 
-    //reading the table font-directory
+//(PRIVATE)
+void InitializeArena(GlyphArena* _arena)
+{
+    _arena->Blocks = NULL;
+    _arena->NumberOfBlocks = 0;
+    _arena->BlockSize = 0;
+    _arena->BlockUsage = 0;
+    _arena->Usage = 0;
+}
 
-    font->SFNT_VERSION = ReadI32(_file); //65536 :: TrueType contours | 1330926671 :: CFF data
-    font->NumberOfTables = ReadI16(_file);
-    font->Tables = malloc(sizeof(void*) * font->NumberOfTables);
-    for (int i = 0; i < font->NumberOfTables; i++)
-        font->Tables[i] = NULL; //as some tables are not supported, null values have to be added to each table slot
+//(PRIVATE)
+//the returned memory is 8-byte aligned and it's not initialized
+void* ArenaAllocate(GlyphArena* _arena, size_t _size)
+{
+    _size = (_size + 7) & ~((size_t) 7);
+
+    //if a new block is needed
+    if (_arena->NumberOfBlocks == 0 || _arena->BlockUsage + _size > _arena->BlockSize)
+    {
+        //every block is two times larger than the previous one (up to 4MB), so even the large fonts need only a few blocks
+        size_t blockSize = _arena->NumberOfBlocks == 0 ? 65536 : _arena->BlockSize * 2;
+
+        if (blockSize > 4194304)
+        {
+            blockSize = 4194304;
+        }
+
+        if (blockSize < _size)
+        {
+            blockSize = _size;
+        }
+
+        _arena->Blocks = realloc(_arena->Blocks, sizeof(unsigned char*) * (_arena->NumberOfBlocks + 1));
+        _arena->Blocks[_arena->NumberOfBlocks++] = malloc(blockSize);
+        _arena->BlockSize = blockSize;
+        _arena->BlockUsage = 0;
+    }
+
+    void* memory = _arena->Blocks[_arena->NumberOfBlocks - 1] + _arena->BlockUsage;
+    _arena->BlockUsage += _size;
+    _arena->Usage += _size;
+    return memory;
+}
+
+//(PRIVATE)
+void ReleaseArena(GlyphArena* _arena)
+{
+    for (int i = 0; i < _arena->NumberOfBlocks; i++)
+    {
+        free(_arena->Blocks[i]);
+    }
+
+    free(_arena->Blocks);
+    InitializeArena(_arena);
+}
+
+//(LOCAL-TO DetermineContourTopology)
+/* orders the contours by the left edge of their bounding box, and the contours with equal left edge by descending size of the box, so
+   every contour is preceded by the contours that can contain it */
+int compareContourBoxes(const void* _topology1, const void* _topology2)
+{
+    const ContourTopology* topology1 = *(const ContourTopology**) _topology1;
+    const ContourTopology* topology2 = *(const ContourTopology**) _topology2;
+
+    if (topology1->MinX != topology2->MinX)
+    {
+        return topology1->MinX - topology2->MinX;
+    }
+    else if (topology1->MaxX != topology2->MaxX)
+    {
+        return topology2->MaxX - topology1->MaxX;
+    }
+    else if (topology1->MinY != topology2->MinY)
+    {
+        return topology1->MinY - topology2->MinY;
+    }
+    else if (topology1->MaxY != topology2->MaxY)
+    {
+        return topology2->MaxY - topology1->MaxY;
+    }
+
+    //(NOTE) the contours with equal bounding boxes keep their order
+    return topology1 < topology2 ? -1 : 1;
+}
+
+//(PRIVATE)
+/* determines the bounding box, the orientation and the container of every contour of the glyph; the containers are found with a sweep
+   over the contours ordered by their bounding boxes, so only the contours whose box is not passed yet are compared */
+//the topology is allocated in the arena
+//_glyph->NumberOfContours > 0 ->
+ContourTopology* DetermineContourTopology(const SimpleGlyph* _glyph, GlyphArena* _arena)
+{
+    int numberOfContours = _glyph->NumberOfContours;
+    ContourTopology* topology = ArenaAllocate(_arena, sizeof(ContourTopology) * numberOfContours);
+
+    for (int contourIndex = 0; contourIndex < numberOfContours; contourIndex++)
+    {
+        int indexOfFirstPoint = contourIndex > 0 ? _glyph->EndPointsOfContours[contourIndex - 1] + 1 : 0;
+        int indexOfLastPoint = _glyph->EndPointsOfContours[contourIndex];
+        ContourTopology* contour = &topology[contourIndex];
+        contour->MinX = _glyph->X_Coordinates[indexOfFirstPoint];
+        contour->MinY = _glyph->Y_Coordinates[indexOfFirstPoint];
+        contour->MaxX = contour->MinX;
+        contour->MaxY = contour->MinY;
+        contour->Container = -1;
+        contour->Depth = 0;
+
+        //(SOURCE) https://stackoverflow.com/questions/1165647/how-to-determine-if-a-list-of-polygon-points-are-in-clockwise-order
+        long long signedArea = 0;
+
+        for (int i = indexOfFirstPoint; i <= indexOfLastPoint; i++)
+        {
+            int x1 = _glyph->X_Coordinates[i];
+            int y1 = _glyph->Y_Coordinates[i];
+            int x2 = _glyph->X_Coordinates[i < indexOfLastPoint ? i + 1 : indexOfFirstPoint];
+            int y2 = _glyph->Y_Coordinates[i < indexOfLastPoint ? i + 1 : indexOfFirstPoint];
+
+            signedArea += ((long long) x1 * y2) - ((long long) x2 * y1);
+
+            if (x1 < contour->MinX) contour->MinX = x1;
+            if (y1 < contour->MinY) contour->MinY = y1;
+            if (x1 > contour->MaxX) contour->MaxX = x1;
+            if (y1 > contour->MaxY) contour->MaxY = y1;
+        }
+
+        contour->IsClockwise = signedArea < 0;
+    }
+
+    ContourTopology** order = malloc(sizeof(ContourTopology*) * numberOfContours);
+    for (int i = 0; i < numberOfContours; i++)
+        order[i] = &topology[i];
+
+    qsort(order, numberOfContours, sizeof(ContourTopology*), compareContourBoxes);
+
+    //the contours whose bounding box is not passed yet (i.e. it reaches the left edge of the current contour)
+    ContourTopology** active = malloc(sizeof(ContourTopology*) * numberOfContours);
+    int numberOfActiveContours = 0;
+
+    for (int i = 0; i < numberOfContours; i++)
+    {
+        ContourTopology* contour = order[i];
+        ContourTopology* container = NULL;
+        long long containerArea = 0;
+        int remainingContours = 0;
+
+        for (int n = 0; n < numberOfActiveContours; n++)
+        {
+            ContourTopology* candidate = active[n];
+
+            if (candidate->MaxX < contour->MinX)
+            {
+                continue;
+            }
+
+            active[remainingContours++] = candidate;
+
+            //(NOTE) candidate->MinX <= contour->MinX, because of the order of the contours
+            if (candidate->MaxX >= contour->MaxX && candidate->MinY <= contour->MinY && candidate->MaxY >= contour->MaxY)
+            {
+                long long area = (long long) (candidate->MaxX - candidate->MinX) * (candidate->MaxY - candidate->MinY);
+
+                if (container == NULL || area < containerArea)
+                {
+                    container = candidate;
+                    containerArea = area;
+                }
+            }
+        }
+
+        numberOfActiveContours = remainingContours;
+        active[numberOfActiveContours++] = contour;
+
+        //the container precedes the contour in the order, so its depth is already determined
+        if (container != NULL)
+        {
+            contour->Container = container - topology;
+            contour->Depth = container->Depth + 1;
+        }
+    }
+
+    free(order);
+    free(active);
+    return topology;
+}
+
+//(PRIVATE)
+/* prepares the outline of the glyph for drawing (see PreparedGlyph) - every contour begins with its first ON point, and an ON point is inserted
+   between every two consecutive OFF points; a contour with only OFF points begins with the point inserted between its last and first point */
+//the prepared glyph is allocated in the arena
+//_glyph->NumberOfContours > 0 ->
+PreparedGlyph* PrepareGlyph(const SimpleGlyph* _glyph, GlyphArena* _arena)
+{
+    int numberOfContours = 0;
+    int numberOfPoints = 0;
+
+    //the number of the points (including the inserted points) of the contours with more than one point
+    for (int contourIndex = 0; contourIndex < _glyph->NumberOfContours; contourIndex++)
+    {
+        int indexOfFirstPoint = contourIndex > 0 ? _glyph->EndPointsOfContours[contourIndex - 1] + 1 : 0;
+        int indexOfLastPoint = _glyph->EndPointsOfContours[contourIndex];
+
+        /* (E) it's possible that a contour contains only one point;
+           (SOURCE) https://github.com/MicrosoftDocs/typography-issues/issues/720?) */
+        if (indexOfLastPoint - indexOfFirstPoint < 1)
+        {
+            continue;
+        }
+
+        numberOfContours++;
+
+        for (int i = indexOfFirstPoint; i <= indexOfLastPoint; i++)
+        {
+            int previous = i > indexOfFirstPoint ? i - 1 : indexOfLastPoint;
+            numberOfPoints += !GetBit(_glyph->Flags[i], 0) && !GetBit(_glyph->Flags[previous], 0) ? 2 : 1;
+        }
+    }
+
+    PreparedGlyph* prepared = ArenaAllocate(_arena, sizeof(PreparedGlyph));
+    prepared->NumberOfContours = numberOfContours;
+    prepared->NumberOfPoints = numberOfPoints;
+    prepared->Contours = ArenaAllocate(_arena, sizeof(PreparedContour) * numberOfContours);
+    prepared->X_Coordinates = ArenaAllocate(_arena, sizeof(float) * numberOfPoints);
+    prepared->Y_Coordinates = ArenaAllocate(_arena, sizeof(float) * numberOfPoints);
+    prepared->Flags = ArenaAllocate(_arena, sizeof(unsigned char) * numberOfPoints);
+
+    int pointIndex = 0;
+
+    for (int contourIndex = 0, preparedContourIndex = 0; contourIndex < _glyph->NumberOfContours; contourIndex++)
+    {
+        int indexOfFirstPoint = contourIndex > 0 ? _glyph->EndPointsOfContours[contourIndex - 1] + 1 : 0;
+        int indexOfLastPoint = _glyph->EndPointsOfContours[contourIndex];
+        int length = (indexOfLastPoint - indexOfFirstPoint) + 1;
+
+        if (length < 2)
+        {
+            continue;
+        }
+
+        PreparedContour* contour = &prepared->Contours[preparedContourIndex++];
+        contour->FirstPoint = pointIndex;
+        contour->TopologyIndex = contourIndex;
+
+        int beginIndex = -1;
+
+        for (int i = indexOfFirstPoint; i <= indexOfLastPoint; i++)
+        {
+            if (GetBit(_glyph->Flags[i], 0))
+            {
+                beginIndex = i;
+                break;
+            }
+        }
+
+        //(NOTE) the contour begins with an ON point, so a point is never inserted between its last and first point (except here)
+        if (beginIndex == -1)
+        {
+            beginIndex = indexOfFirstPoint;
+        }
+
+        for (int n = 0; n < length; n++)
+        {
+            int i = indexOfFirstPoint + (((beginIndex - indexOfFirstPoint) + n) % length);
+            int previous = i > indexOfFirstPoint ? i - 1 : indexOfLastPoint;
+
+            /* (NOTE) the inserted point is exact in font units and it's scaled like the other points, so after the scaling it can be off
+               the middle of its scaled neighbours in the last bit; that is enough to move a sample or a crossing over a pixel border */
+            if (!GetBit(_glyph->Flags[i], 0) && !GetBit(_glyph->Flags[previous], 0))
+            {
+                prepared->X_Coordinates[pointIndex] = (_glyph->X_Coordinates[previous] + _glyph->X_Coordinates[i]) / 2.0f;
+                prepared->Y_Coordinates[pointIndex] = (_glyph->Y_Coordinates[previous] + _glyph->Y_Coordinates[i]) / 2.0f;
+                prepared->Flags[pointIndex++] = 1;
+            }
+
+            prepared->X_Coordinates[pointIndex] = _glyph->X_Coordinates[i];
+            prepared->Y_Coordinates[pointIndex] = _glyph->Y_Coordinates[i];
+            prepared->Flags[pointIndex++] = GetBit(_glyph->Flags[i], 0) ? 1 : 0;
+        }
+
+        contour->NumberOfPoints = pointIndex - contour->FirstPoint;
+    }
+
+    return prepared;
+}
+
+//(PRIVATE)
+void* ExtractSimpleGlyph(FontStream* _stream, GlyphArena* _arena, short _numberOfContours)
+{
+    SimpleGlyph* glyph = ArenaAllocate(_arena, sizeof(SimpleGlyph));
+    glyph->Typograph = 0b01100101000000000000000000000000;
+
+    glyph->NumberOfContours = _numberOfContours;
+    glyph->MinX = ReadI16(_stream);
+    glyph->MinY = ReadI16(_stream);
+    glyph->MaxX = ReadI16(_stream);
+    glyph->MaxY = ReadI16(_stream);
+    glyph->NumberOfContours = _numberOfContours;
+
+    glyph->EndPointsOfContours = ArenaAllocate(_arena, sizeof(unsigned short) * _numberOfContours);
+    for (int i = 0; i < _numberOfContours; i++)
+        glyph->EndPointsOfContours[i] = ReadI16(_stream);
+
+    //(SHOULD-NOT-HAPPEN) a non-empty glyph without contours
+    if (_numberOfContours == 0)
+    {
+        glyph->NumberOfPoints = 0;
+        glyph->Flags = NULL;
+        glyph->X_Coordinates = NULL;
+        glyph->Y_Coordinates = NULL;
+        glyph->Topology = NULL;
+        glyph->Prepared = NULL;
+        return (void*) glyph;
+    }
+
+    int instructionLength = ReadI16(_stream);
+
+    //ignoring the instructions
+    Skip(_stream, instructionLength);
+
+    ///reading the flags
+
+    //total number of points for every contour in the glyph
+    int numberOfPointsInContours = glyph->EndPointsOfContours[_numberOfContours - 1] + 1;
+
+    glyph->NumberOfPoints = numberOfPointsInContours;
+
+    int numberOfFlags = 0;
+
+    //(NOTE) the arrays of the points are allocated together, so the coordinates of the glyph are contiguous in the arena
+    glyph->X_Coordinates = ArenaAllocate(_arena, sizeof(short) * numberOfPointsInContours);
+    glyph->Y_Coordinates = ArenaAllocate(_arena, sizeof(short) * numberOfPointsInContours);
+    glyph->Flags = ArenaAllocate(_arena, sizeof(unsigned char) * numberOfPointsInContours);
+
+    while (true)
+    {
+        unsigned char flags = ReadI8(_stream);
+        glyph->Flags[numberOfFlags++] = flags;
+
+        //if the flag is repeated
+        if (GetBit(flags, 3) == true)
+        {
+            unsigned char numberOfRepetitions = ReadI8(_stream);
+
+            //repeating the flag
+            for (int m = 0; m < numberOfRepetitions; m++)
+            {
+                glyph->Flags[numberOfFlags++] = flags;
+            }
+        }
+
+        if (numberOfFlags == numberOfPointsInContours) break;
+    }
+
+    ///reading the X-coordinates
+
+    for (int n = 0; n < numberOfPointsInContours; n++)
+    {
+        //if the X-coordinate is 1 byte
+        if (GetBit(glyph->Flags[n], 1) == true)
+        {
+            unsigned char value = ReadI8(_stream);
+
+            if (GetBit(glyph->Flags[n], 4) == false)
+            {
+                glyph->X_Coordinates[n] = (n == 0 ? 0 : glyph->X_Coordinates[n - 1]) - value;
+            }
+            else
+            {
+                glyph->X_Coordinates[n] = (n == 0 ? 0 : glyph->X_Coordinates[n - 1]) + value;
+            }
+        }
+        //(STATE) the X-coordinate is 2 bytes
+        else
+        {
+            if (GetBit(glyph->Flags[n], 4) == true)
+            {
+                glyph->X_Coordinates[n] = n == 0 ? 0 : glyph->X_Coordinates[n - 1];
+            }
+            else
+            {
+                glyph->X_Coordinates[n] = (n == 0 ? 0 : glyph->X_Coordinates[n - 1]) + ReadI16(_stream);
+            }
+        }
+    }
+
+    //reading the Y-coordinates
+
+    for (int n = 0; n < numberOfPointsInContours; n++)
+    {
+        //if the Y-coordinate is 1 byte
+        if (GetBit(glyph->Flags[n], 2) == true)
+        {
+            unsigned char value = ReadI8(_stream);
+
+            if (GetBit(glyph->Flags[n], 5) == false)
+            {
+                glyph->Y_Coordinates[n] = (n == 0 ? 0 : glyph->Y_Coordinates[n - 1]) - value;
+            }
+            else
+            {
+                glyph->Y_Coordinates[n] = (n == 0 ? 0 : glyph->Y_Coordinates[n - 1]) + value;
+            }
+        }
+            //(STATE) if Y-coordinate is 2 bytes
+        else
+        {
+            if (GetBit(glyph->Flags[n], 5) == true)
+            {
+                glyph->Y_Coordinates[n] = n == 0 ? 0 : glyph->Y_Coordinates[n - 1];
+            }
+            else
+            {
+                glyph->Y_Coordinates[n] = (n == 0 ? 0 : glyph->Y_Coordinates[n - 1]) + ReadI16(_stream);
+            }
+        }
+    }
+
+    glyph->Topology = DetermineContourTopology(glyph, _arena);
+    glyph->Prepared = PrepareGlyph(glyph, _arena);
+
+    return (void*) glyph;
+}
+
+//(PRIVATE)
+//(RECURSIVE)
+void* ExtractCompositeGlyph(FontStream* _stream, GlyphArena* _arena)
+{
+    CompositeGlyph* glyph = ArenaAllocate(_arena, sizeof(CompositeGlyph));
+    glyph->Typograph = 0b01100110000000000000000000000000;
+
+    glyph->MinX = ReadI16(_stream);
+    glyph->MinY = ReadI16(_stream);
+    glyph->MaxX = ReadI16(_stream);
+    glyph->MaxY = ReadI16(_stream);
+
+    int size = 20;
+
+    GlyphComponent* components = malloc(sizeof(GlyphComponent) * size);
+    int componentCount = 0;
+
+    //while there are more sub-glyphs
+    while (true)
+    {
+        if (componentCount == size)
+        {
+            size += size / 2;
+            components = realloc(components, sizeof(GlyphComponent) * size);
+        }
+
+        GlyphComponent* component = &components[componentCount++];
+        component->Scale[0] = 0;
+        component->Scale[1] = 0;
+        component->Scale[2] = 0;
+        component->Scale[3] = 0;
+        component->Flags = ReadI16(_stream);
+        component->GlyphIndex = ReadI16(_stream);
+
+        bool flags_bit_0 = GetBit(component->Flags, 0);
+        bool flags_bit_1 = GetBit(component->Flags, 1);
+
+        component->ArgumentMode = flags_bit_1;
+
+        if (flags_bit_0 == false && flags_bit_1 == false)
+        {
+            component->Argument1 = ReadI8(_stream);
+            component->Argument2 = ReadI8(_stream);
+        }
+        else if (flags_bit_0 == false && flags_bit_1 == true)
+        {
+            component->Argument1 = (char)ReadI8(_stream);
+            component->Argument2 = (char)ReadI8(_stream);
+        }
+        else if (flags_bit_0 == true && flags_bit_1 == false)
+        {
+            component->Argument1 = ReadI16(_stream);
+            component->Argument2 = ReadI16(_stream);
+        }
+        else if (flags_bit_0 == true && flags_bit_1 == true)
+        {
+            component->Argument1 = (short)ReadI16(_stream);
+            component->Argument2 = (short)ReadI16(_stream);
+        }
+
+        //transformation fields
+
+        //'simple' scaling (SOURCE:MICROSOFT)
+        if (GetBit(component->Flags, 3) == true)
+        {
+            component->Scale[0] = ReadI16(_stream);
+        }
+            //X and Y scaling
+        else if (GetBit(component->Flags, 6) == true)
+        {
+            component->Scale[0] = ReadI16(_stream);
+            component->Scale[1] = ReadI16(_stream);
+        }
+            //2x2 scaling
+        else if (GetBit(component->Flags, 7) == true)
+        {
+            component->Scale[0] = ReadI16(_stream);
+            component->Scale[1] = ReadI16(_stream);
+            component->Scale[2] = ReadI16(_stream);
+            component->Scale[3] = ReadI16(_stream);
+        } //
+
+        component->UseMetrics = GetBit(component->Flags, 9);
+
+        //if there are instructions for &glyph following (if present, they're always located after the last sub-glyph in the parent composite glyph)
+        if (GetBit(component->Flags, 8) == true)
+        {
+            unsigned short numberOfInstructions = ReadI16(_stream);
+
+            //ignoring the instructions
+            Skip(_stream, numberOfInstructions);
+        }
+
+        //(STATE) if there are no more sub-glyphs
+        if (GetBit(component->Flags, 5) == false)
+        {
+            break;
+        }
+    }
+
+    glyph->Components = ArenaAllocate(_arena, sizeof(GlyphComponent) * componentCount);
+
+    for (int i = 0; i < componentCount; i++)
+    {
+        glyph->Components[i] = components[i];
+    }
+
+    glyph->NumberOfComponents = componentCount;
+
+    free(components);
+
+    return (void*) glyph;
+}
+
+//(PRIVATE)
+/* the header of a file written by BakeFont; it's followed by the sections - the font file, and the data that is computed when the font is
+   parsed (the compiled cmap, the kerning index, the decoded horizontal metrics and the extracted glyphs); the data is stored in the same
+   format as in the memory, so the file (once mapped) is used directly - only the pointers in the glyph records are fixed */
+/* (NOTE) all the offsets are relative to the beginning of the file and they are multiple of 8; offset 0 :: no such section;
+          the file is little-endian, and it's valid only on machines with the same pointer size as the one which created it */
+struct BakedFontHeader
+{
+    char Signature[4]; //"TTBK"
+    unsigned int Version; //BAKED_FONT_VERSION
+    unsigned int ByteOrder; //0x01020304
+    unsigned int PointerSize;
+    unsigned long long FontDataOffset;
+    unsigned long long FontDataSize;
+    //cmap (see CompileCodepointMap)
+    unsigned long long BasicPlaneOffset; //[uint16] 65536 elements
+    unsigned long long CodepointPagesOffset; //[uint64] 4352 elements; the offsets of the pages outside the BMP ([uint16] 256 elements); 0 :: empty page
+    //kern (see IndexKerningPairs)
+    unsigned long long NumberOfIndexedPairs;
+    unsigned long long PairKeysOffset;
+    unsigned long long PairValuesOffset;
+    unsigned long long FrequentGlyphsOffset;
+    unsigned long long FrequentPairValuesOffset;
+    unsigned long long FrequentPairPresenceOffset;
+    //hmtx
+    unsigned long long NumberOfHorizontalMetrics;
+    unsigned long long HorizontalMetricsOffset;
+    unsigned long long NumberOfLeftSideBearings;
+    unsigned long long LeftSideBearingsOffset;
+    //glyf
+    unsigned long long NumberOfGlyphs;
+    unsigned long long GlyphsOffset; //[uint64] NumberOfGlyphs elements; the offsets of the glyph records (their pointers are offsets as well)
+};
+
+typedef struct BakedFontHeader BakedFontHeader;
+
+const unsigned int BAKED_FONT_VERSION = 3;
+
+//(PRIVATE)
+//the section is outside of the file or it's not aligned => NULL
+unsigned char* GetBakedSection(const FontStream* _baked, unsigned long long _offset, unsigned long long _size)
+{
+    if (_offset == 0 || (_offset & 7) != 0 || _offset > _baked->Size || _size > _baked->Size - _offset)
+    {
+        return NULL;
+    }
+
+    //(NOTE) the baked file is mapped copy-on-write, so the glyph records can be fixed in-place
+    return (unsigned char*) _baked->Data + _offset;
+}
+
+//(PRIVATE)
+//uses the compiled map in the baked file instead of CompileCodepointMap
+//the baked file does not contain the map => false
+bool LoadBakedCodepointMap(CMAP_Table* _cmap, const FontStream* _baked)
+{
+    const BakedFontHeader* header = (const BakedFontHeader*) _baked->Data;
+
+    unsigned short* basicPlane = (unsigned short*) GetBakedSection(_baked, header->BasicPlaneOffset, sizeof(unsigned short) * 65536);
+    const unsigned long long* pageOffsets = (const unsigned long long*) GetBakedSection(_baked, header->CodepointPagesOffset, sizeof(unsigned long long) * 4352);
+
+    if (basicPlane == NULL || pageOffsets == NULL)
+    {
+        return false;
+    }
+
+    _cmap->BasicPlane = basicPlane;
+    _cmap->EmptyPage = malloc(sizeof(unsigned short) * 256);
+    _cmap->CodepointPages = malloc(sizeof(unsigned short*) * 4352);
+
+    for (int i = 0; i < 256; i++)
+        _cmap->EmptyPage[i] = 0xFFFF;
+    for (int i = 0; i < 256; i++)
+        _cmap->CodepointPages[i] = _cmap->BasicPlane + i * 256;
+
+    for (int i = 256; i < 4352; i++)
+    {
+        unsigned short* page = (unsigned short*) GetBakedSection(_baked, pageOffsets[i], sizeof(unsigned short) * 256);
+        _cmap->CodepointPages[i] = page != NULL ? page : _cmap->EmptyPage;
+    }
+
+    return true;
+}
+
+//(PRIVATE)
+//uses the kerning index in the baked file instead of IndexKerningPairs
+//the baked file does not contain the index => false
+bool LoadBakedKerningIndex(KERN_Table* _kern, const FontStream* _baked)
+{
+    const BakedFontHeader* header = (const BakedFontHeader*) _baked->Data;
+
+    _kern->PairKeys = NULL;
+    _kern->PairValues = NULL;
+    _kern->NumberOfIndexedPairs = 0;
+    _kern->FrequentGlyphs = NULL;
+    _kern->FrequentPairValues = NULL;
+    _kern->FrequentPairPresence = NULL;
+
+    //(STATE) the font has no kerning pairs (see IndexKerningPairs)
+    if (header->NumberOfIndexedPairs == 0)
+    {
+        return header->PairKeysOffset == 0;
+    }
+
+    if (header->NumberOfIndexedPairs > _baked->Size)
+    {
+        return false;
+    }
+
+    unsigned int* keys = (unsigned int*) GetBakedSection(_baked, header->PairKeysOffset, sizeof(unsigned int) * header->NumberOfIndexedPairs);
+    short* values = (short*) GetBakedSection(_baked, header->PairValuesOffset, sizeof(short) * header->NumberOfIndexedPairs);
+    unsigned char* frequentGlyphs = GetBakedSection(_baked, header->FrequentGlyphsOffset, 65536);
+    short* frequentPairValues = (short*) GetBakedSection(_baked, header->FrequentPairValuesOffset, sizeof(short) * 128 * 128);
+    unsigned char* frequentPairPresence = GetBakedSection(_baked, header->FrequentPairPresenceOffset, 128 * 128 / 8);
+
+    if (keys == NULL || values == NULL || frequentGlyphs == NULL || frequentPairValues == NULL || frequentPairPresence == NULL)
+    {
+        return false;
+    }
+
+    _kern->PairKeys = keys;
+    _kern->PairValues = values;
+    _kern->NumberOfIndexedPairs = header->NumberOfIndexedPairs;
+    _kern->FrequentGlyphs = frequentGlyphs;
+    _kern->FrequentPairValues = frequentPairValues;
+    _kern->FrequentPairPresence = frequentPairPresence;
+    return true;
+}
+
+//(PRIVATE)
+//uses the decoded metrics in the baked file instead of decoding table hmtx
+//the baked file does not contain the metrics (of _numberOfGlyphs glyphs) => false
+bool LoadBakedHorizontalMetrics(HMTX_Table* _hmtx, const FontStream* _baked, int _numberOfGlyphs, int _numberOfHorizontalMetrics)
+{
+    const BakedFontHeader* header = (const BakedFontHeader*) _baked->Data;
+
+    if (header->NumberOfHorizontalMetrics != (unsigned long long) _numberOfGlyphs ||
+        header->NumberOfLeftSideBearings != (unsigned long long) (_numberOfGlyphs - _numberOfHorizontalMetrics))
+    {
+        return false;
+    }
+
+    LongHorizontalMetric* metrics = (LongHorizontalMetric*) GetBakedSection(_baked, header->HorizontalMetricsOffset, sizeof(LongHorizontalMetric) * _numberOfGlyphs);
+    short* leftSideBearings = (short*) GetBakedSection(_baked, header->LeftSideBearingsOffset, sizeof(short) * header->NumberOfLeftSideBearings);
+
+    if (metrics == NULL || leftSideBearings == NULL)
+    {
+        return false;
+    }
+
+    _hmtx->HorizontalMetrics = metrics;
+    _hmtx->LeftSideBearings = leftSideBearings;
+    return true;
+}
+
+//(PRIVATE)
+//uses the glyph records in the baked file; a record is used on the first access of its glyph (see FixBakedGlyph)
+//the baked file does not contain the glyphs => false
+bool LoadBakedGlyphs(GLYF_Table* _glyf, const FontStream* _baked)
+{
+    const BakedFontHeader* header = (const BakedFontHeader*) _baked->Data;
+
+    if (header->NumberOfGlyphs != _glyf->NumberOfGlyphs)
+    {
+        return false;
+    }
+
+    unsigned long long* recordOffsets = (unsigned long long*) GetBakedSection(_baked, header->GlyphsOffset, sizeof(unsigned long long) * _glyf->NumberOfGlyphs);
+
+    if (recordOffsets == NULL)
+    {
+        return false;
+    }
+
+    _glyf->BakedGlyphs = recordOffsets;
+    _glyf->BakedData = (unsigned char*) _baked->Data;
+    _glyf->BakedDataSize = _baked->Size;
+    return true;
+}
+
+//(PRIVATE)
+/* fixes the pointers in the baked glyph record (they contain offsets in the baked file); the record is used only once - if the glyph is released
+   (see ReleaseGlyph/TrimGlyphs), the next time it's extracted from the font data */
+//the record is invalid => NULL
+void* FixBakedGlyph(GLYF_Table* _glyf, int _glyphIndex)
+{
+    FontStream baked;
+    baked.Data = _glyf->BakedData;
+    baked.Size = _glyf->BakedDataSize;
+    baked.Position = 0;
+
+    unsigned long long recordOffset = _glyf->BakedGlyphs[_glyphIndex];
+    _glyf->BakedGlyphs[_glyphIndex] = 0;
+
+    void* glyph = GetBakedSection(&baked, recordOffset, sizeof(EmptyGlyph));
+
+    if (glyph == NULL)
+    {
+        return NULL;
+    }
+    else if (Is(glyph, SIMPLE_GLYPH) && GetBakedSection(&baked, recordOffset, sizeof(SimpleGlyph)) != NULL)
+    {
+        SimpleGlyph* record = (SimpleGlyph*) glyph;
+
+        record->EndPointsOfContours = (unsigned short*) GetBakedSection(&baked, (size_t) record->EndPointsOfContours,
+                                                                        sizeof(unsigned short) * record->NumberOfContours);
+        record->X_Coordinates = (short*) GetBakedSection(&baked, (size_t) record->X_Coordinates, sizeof(short) * record->NumberOfPoints);
+        record->Y_Coordinates = (short*) GetBakedSection(&baked, (size_t) record->Y_Coordinates, sizeof(short) * record->NumberOfPoints);
+        record->Flags = GetBakedSection(&baked, (size_t) record->Flags, record->NumberOfPoints);
+        record->Topology = (ContourTopology*) GetBakedSection(&baked, (size_t) record->Topology, sizeof(ContourTopology) * record->NumberOfContours);
+        record->Prepared = (PreparedGlyph*) GetBakedSection(&baked, (size_t) record->Prepared, sizeof(PreparedGlyph));
+
+        if ((record->NumberOfContours > 0 && (record->EndPointsOfContours == NULL || record->Topology == NULL || record->Prepared == NULL)) ||
+            (record->NumberOfPoints > 0 && (record->X_Coordinates == NULL || record->Y_Coordinates == NULL || record->Flags == NULL)))
+        {
+            return NULL;
+        }
+
+        if (record->Prepared != NULL)
+        {
+            PreparedGlyph* prepared = record->Prepared;
+
+            prepared->Contours = (PreparedContour*) GetBakedSection(&baked, (size_t) prepared->Contours,
+                                                                    sizeof(PreparedContour) * prepared->NumberOfContours);
+            prepared->X_Coordinates = (float*) GetBakedSection(&baked, (size_t) prepared->X_Coordinates, sizeof(float) * prepared->NumberOfPoints);
+            prepared->Y_Coordinates = (float*) GetBakedSection(&baked, (size_t) prepared->Y_Coordinates, sizeof(float) * prepared->NumberOfPoints);
+            prepared->Flags = GetBakedSection(&baked, (size_t) prepared->Flags, prepared->NumberOfPoints);
+
+            if ((prepared->NumberOfContours > 0 && prepared->Contours == NULL) ||
+                (prepared->NumberOfPoints > 0 && (prepared->X_Coordinates == NULL || prepared->Y_Coordinates == NULL || prepared->Flags == NULL)))
+            {
+                return NULL;
+            }
+        }
+
+        return glyph;
+    }
+    else if (Is(glyph, COMPOSITE_GLYPH) && GetBakedSection(&baked, recordOffset, sizeof(CompositeGlyph)) != NULL)
+    {
+        CompositeGlyph* record = (CompositeGlyph*) glyph;
+
+        record->Components = (GlyphComponent*) GetBakedSection(&baked, (size_t) record->Components, sizeof(GlyphComponent) * record->NumberOfComponents);
+
+        if (record->NumberOfComponents > 0 && record->Components == NULL)
+        {
+            return NULL;
+        }
+
+        return glyph;
+    }
+
+    return Is(glyph, EMPTY_GLYPH) ? glyph : NULL;
+}
+
+//(PRIVATE)
+//extracts the glyph with the specified index from the font data (or takes it from the baked file)
+//the glyph is allocated in the arena of the table
+//_glyphIndex < _glyf->NumberOfGlyphs ->
+void* ExtractGlyph(GLYF_Table* _glyf, int _glyphIndex)
+{
+    //the glyph is in the baked file (see LoadBakedFont)
+    if (_glyf->BakedGlyphs != NULL && _glyf->BakedGlyphs[_glyphIndex] != 0)
+    {
+        void* glyph = FixBakedGlyph(_glyf, _glyphIndex);
+
+        if (glyph != NULL)
+        {
+            return glyph;
+        }
+    }
+
+    //determine the position (relative to the beginning of table glyf) of the glyph
+    unsigned int glyphOffset = GetGlyphOffset(_glyf->Loca, _glyphIndex);
+    unsigned int nextGlyphOffset = GetGlyphOffset(_glyf->Loca, _glyphIndex + 1);
+
+    //if the glyph has no contours
+    if (glyphOffset >= nextGlyphOffset)
+    {
+        EmptyGlyph* glyph = ArenaAllocate(&_glyf->Arena, sizeof(EmptyGlyph));
+        glyph->Typograph = 0b01100100000000000000000000000000;
+        return glyph;
+    }
+
+    FontStream stream;
+    stream.Data = _glyf->FontData;
+    stream.Size = _glyf->FontDataSize;
+    stream.Position = _glyf->Offset + glyphOffset;
+
+    //reading the header
+
+    short numberOfContours = ReadI16(&stream);
+
+    //if the glyph is simple
+    if (numberOfContours >= 0)
+    {
+        return ExtractSimpleGlyph(&stream, &_glyf->Arena, numberOfContours);
+    }
+    //(STATE) the glyph is composite
+    else
+    {
+        return ExtractCompositeGlyph(&stream, &_glyf->Arena);
+    }
+}
+
+//(PRIVATE)
+//copies a glyph returned by ExtractGlyph (with its arrays) to the specified arena
+void* CopyGlyph(GlyphArena* _arena, const void* _glyph)
+{
+    if (Is(_glyph, SIMPLE_GLYPH))
+    {
+        const SimpleGlyph* source = (const SimpleGlyph*) _glyph;
+        SimpleGlyph* glyph = ArenaAllocate(_arena, sizeof(SimpleGlyph));
+        *glyph = *source;
+
+        glyph->EndPointsOfContours = ArenaAllocate(_arena, sizeof(unsigned short) * source->NumberOfContours);
+        for (int i = 0; i < source->NumberOfContours; i++)
+        {
+            glyph->EndPointsOfContours[i] = source->EndPointsOfContours[i];
+        }
+
+        if (source->Topology != NULL)
+        {
+            glyph->Topology = ArenaAllocate(_arena, sizeof(ContourTopology) * source->NumberOfContours);
+            for (int i = 0; i < source->NumberOfContours; i++)
+            {
+                glyph->Topology[i] = source->Topology[i];
+            }
+        }
+
+        if (source->Prepared != NULL)
+        {
+            const PreparedGlyph* prepared = source->Prepared;
+            glyph->Prepared = ArenaAllocate(_arena, sizeof(PreparedGlyph));
+            *glyph->Prepared = *prepared;
+
+            glyph->Prepared->Contours = ArenaAllocate(_arena, sizeof(PreparedContour) * prepared->NumberOfContours);
+            for (int i = 0; i < prepared->NumberOfContours; i++)
+            {
+                glyph->Prepared->Contours[i] = prepared->Contours[i];
+            }
+
+            glyph->Prepared->X_Coordinates = ArenaAllocate(_arena, sizeof(float) * prepared->NumberOfPoints);
+            glyph->Prepared->Y_Coordinates = ArenaAllocate(_arena, sizeof(float) * prepared->NumberOfPoints);
+            glyph->Prepared->Flags = ArenaAllocate(_arena, sizeof(unsigned char) * prepared->NumberOfPoints);
+
+            for (int i = 0; i < prepared->NumberOfPoints; i++)
+            {
+                glyph->Prepared->X_Coordinates[i] = prepared->X_Coordinates[i];
+                glyph->Prepared->Y_Coordinates[i] = prepared->Y_Coordinates[i];
+                glyph->Prepared->Flags[i] = prepared->Flags[i];
+            }
+        }
+
+        if (source->NumberOfPoints > 0)
+        {
+            glyph->X_Coordinates = ArenaAllocate(_arena, sizeof(short) * source->NumberOfPoints);
+            glyph->Y_Coordinates = ArenaAllocate(_arena, sizeof(short) * source->NumberOfPoints);
+            glyph->Flags = ArenaAllocate(_arena, sizeof(unsigned char) * source->NumberOfPoints);
+
+            for (int i = 0; i < source->NumberOfPoints; i++)
+            {
+                glyph->X_Coordinates[i] = source->X_Coordinates[i];
+                glyph->Y_Coordinates[i] = source->Y_Coordinates[i];
+                glyph->Flags[i] = source->Flags[i];
+            }
+        }
+
+        return glyph;
+    }
+    else if (Is(_glyph, COMPOSITE_GLYPH))
+    {
+        const CompositeGlyph* source = (const CompositeGlyph*) _glyph;
+        CompositeGlyph* glyph = ArenaAllocate(_arena, sizeof(CompositeGlyph));
+        *glyph = *source;
+
+        glyph->Components = ArenaAllocate(_arena, sizeof(GlyphComponent) * source->NumberOfComponents);
+        for (int i = 0; i < source->NumberOfComponents; i++)
+        {
+            glyph->Components[i] = source->Components[i];
+        }
+
+        return glyph;
+    }
+    //(STATE) the glyph is empty
+    else
+    {
+        EmptyGlyph* glyph = ArenaAllocate(_arena, sizeof(EmptyGlyph));
+        *glyph = *(const EmptyGlyph*) _glyph;
+        return glyph;
+    }
+}
+
+//(PUBLIC)
+//the font does not contain such table => NULL
+void* GetTable(const Font* _font, short _identifier)
+{
+    if (_identifier < CMAP_TABLE || _identifier > VHEA_TABLE)
+    {
+        return NULL;
+    }
+
+    return _font->TableSlots[_identifier - CMAP_TABLE];
+}
+
+//(PRIVATE)
+//stores a table at position _index in the table directory, and in the slot for its identifier
+void SetTable(Font* _font, int _index, void* _table)
+{
+    _font->Tables[_index] = _table;
+    _font->TableSlots[((*(unsigned int*)_table) >> 24) - CMAP_TABLE] = _table;
+}
+
+//(PRIVATE)
+//the serial number of the last parsed font (see Font)
+#if defined(_WIN32)
+volatile LONG LastFontSerial = 0;
+#else
+unsigned int LastFontSerial = 0;
+#endif
+
+//(PRIVATE)
+//(LOCAL-TO ParseFontStream)
+//the serial number of a new font; it's taken atomically, so fonts parsed at the same time by different threads get different serials
+unsigned int NewFontSerial()
+{
+    #if defined(_WIN32)
+        return (unsigned int) InterlockedIncrement(&LastFontSerial);
+    #elif defined(__GNUC__) || defined(__clang__)
+        return __sync_add_and_fetch(&LastFontSerial, 1);
+    #else
+        return ++LastFontSerial; //(NOTE) not atomic - with such a compiler the fonts have to be parsed on one thread
+    #endif
+}
+
+//(PUBLIC)
+void ReleaseFont(Font* _font);
+
+//(PRIVATE)
+//(LOCAL-TO ParseFontStream)
+//releases a font whose parsing failed, with the tables extracted so far (the data is not released) => NULL
+Font* DiscardFont(Font* _font)
+{
+    ReleaseFont(_font);
+    return NULL;
+}
+
+//(PRIVATE)
+//the tables keep pointers into the data of _stream, so the data has to outlive the returned font
+//_baked != NULL :: the data computed during the parsing is taken from the baked file (see LoadBakedFont), if it's there
+//the data is not a supported font file => NULL
+Font* ParseFontStream(FontStream* _stream, const FontStream* _baked)
+{
+    Font* font = malloc(sizeof(Font));
+    font->Data = _stream->Data;
+    font->DataSize = _stream->Size;
+    font->DataOwnership = 0;
+    //(NOTE) before any table takes an array from the baked file, so ReleaseFont doesn't free such an array if the parsing fails
+    font->Baked = _baked != NULL ? (unsigned char*) _baked->Data : NULL;
+    font->BakedSize = _baked != NULL ? _baked->Size : 0;
+    font->Serial = NewFontSerial();
+
+    //reading the table font-directory
+
+    font->SFNT_VERSION = ReadI32(_stream); //65536 :: TrueType contours | 1330926671 :: CFF data
+    font->NumberOfTables = ReadI16(_stream);
+    font->Tables = malloc(sizeof(void*) * font->NumberOfTables);
+    for (int i = 0; i < font->NumberOfTables; i++)
+        font->Tables[i] = NULL; //as some tables are not supported, null values have to be added to each table slot
+    for (int i = 0; i < 10; i++)
+        font->TableSlots[i] = NULL;
 
     //position the file at the beginning of the table list
-    fseek(_file, 12, SEEK_SET);
+    Seek(_stream, 12);
 
     //reading the tables
     for (int i = 0; i < font->NumberOfTables; i++)
     {
-        unsigned char tagCharacter1 = ReadI8(_file);
-        unsigned char tagCharacter2 = ReadI8(_file);
-        unsigned char tagCharacter3 = ReadI8(_file);
+        unsigned char tagCharacter1 = ReadI8(_stream);
+        unsigned char tagCharacter2 = ReadI8(_stream);
+        unsigned char tagCharacter3 = ReadI8(_stream);
 
-        unsigned char tagCharacter4 = ReadI8(_file);
-        fseek(_file, ftell(_file) + 4, SEEK_SET); //ignoring the Checksum field
-        unsigned int tableOffset = ReadI32(_file);
-        fseek(_file, ftell(_file) + 4, SEEK_SET); //ignoring the Length field
+        unsigned char tagCharacter4 = ReadI8(_stream);
+        Skip(_stream, 4); //ignoring the Checksum field
+        unsigned int tableOffset = ReadI32(_stream);
+        Skip(_stream, 4); //ignoring the Length field
 
         //this variable is needed because a jump (to the header of the next table) has to be performed after extraction of this table
-        int tableHeaderBegin = ftell(_file);
+        int tableHeaderBegin = _stream->Position;
 
-        fseek(_file, tableOffset, SEEK_SET);
+        Seek(_stream, tableOffset);
 
         if (tagCharacter1 == 'c' && tagCharacter2 == 'm' && tagCharacter3 == 'a' && tagCharacter4 == 'p')
         {
             CMAP_Table* table = P_CMAP_Table();
 
-            table->Version = ReadI16(_file);
-            table->NumberOfSubtables = ReadI16(_file);
+            table->Version = ReadI16(_stream);
+            table->NumberOfSubtables = ReadI16(_stream);
             table->Subtables = malloc(sizeof(void*) * table->NumberOfSubtables);
+            table->BasicPlane = NULL;
+            table->EmptyPage = NULL;
+            table->CodepointPages = NULL;
+
+            for (int n = 0; n < table->NumberOfSubtables; n++)
+                table->Subtables[n] = NULL;
+
+            //(NOTE) the table is in the font before it's complete, so it's released with the font if the parsing fails
+            SetTable(font, i, (void*) table);
 
             for (int n = 0; n < table->NumberOfSubtables; n++)
             {
@@ -907,186 +2132,193 @@ Font* ParseFont(FILE* _file)
                           format 14 (Unicode Variation Sequences) is not so important and it also won't be supported for now */
 
                 //reading the sub-table descriptor
-                unsigned short platformID = ReadI16(_file);
-                unsigned short encodingID = ReadI16(_file);
-                unsigned int subtableOffset = ReadI32(_file);
+                unsigned short platformID = ReadI16(_stream);
+                unsigned short encodingID = ReadI16(_stream);
+                unsigned int subtableOffset = ReadI32(_stream);
 
-                int nextSubtableDescriptorPosition = ftell(_file);
+                int nextSubtableDescriptorPosition = _stream->Position;
 
                 //reading the sub-table
 
-                fseek(_file, tableOffset + subtableOffset, SEEK_SET);
+                Seek(_stream, tableOffset + subtableOffset);
 
-                unsigned short tableFormat = ReadI16(_file);
+                unsigned short tableFormat = ReadI16(_stream);
 
                 if (tableFormat == 0)
                 {
                     CMAP_Subtable_Format0* subtable = P_CMAP_Subtable_Format0();
-                    subtable->Length = ReadI16(_file);
-                    subtable->Language = ReadI16(_file);
+                    subtable->Length = ReadI16(_stream);
+                    subtable->Language = ReadI16(_stream);
 
-                    for (int x = 0; x < 256; x++)
-                    {
-                        subtable->GlyphIndexArray[x] = ReadI8(_file);
-                    }
+                    subtable->GlyphIndexArray = Borrow(_stream, 256);
 
                     table->Subtables[n] = (void*) subtable;
 
-                    fseek(_file, nextSubtableDescriptorPosition, SEEK_SET);
+                    if (subtable->GlyphIndexArray == NULL)
+                    {
+                        return DiscardFont(font);
+                    }
+
+                    Seek(_stream, nextSubtableDescriptorPosition);
                 }
                 else if (tableFormat == 4)
                 {
                     CMAP_Subtable_Format4* subtable = P_CMAP_Subtable_Format4();
-                    subtable->Length = ReadI16(_file);
-                    subtable->Language = ReadI16(_file);
-                    subtable->SegmentCountX2 = ReadI16(_file);
+                    subtable->Length = ReadI16(_stream);
+                    subtable->Language = ReadI16(_stream);
+                    subtable->SegmentCountX2 = ReadI16(_stream);
                     int segmentCount = subtable->SegmentCountX2 / 2;
-                    subtable->SearchRange = ReadI16(_file);
-                    subtable->EntrySelector = ReadI16(_file);
-                    subtable->RangeShift = ReadI16(_file);
-                    //
-                    subtable->EndCode = malloc(sizeof(unsigned short) * segmentCount);
-                    for (int m = 0; m < segmentCount; m++)
-                        subtable->EndCode[m] = ReadI16(_file);
-                    //
-                    subtable->ReservedPad = ReadI16(_file);
-                    //
-                    subtable->StartCode = malloc(sizeof(unsigned short) * segmentCount);
-                    for (int m = 0; m < segmentCount; m++)
-                        subtable->StartCode[m] = ReadI16(_file);
+                    subtable->SearchRange = ReadI16(_stream);
+                    subtable->EntrySelector = ReadI16(_stream);
+                    subtable->RangeShift = ReadI16(_stream);
                     //
-                    subtable->IndexDelta = malloc(sizeof(unsigned short) * segmentCount);
-                    for (int m = 0; m < segmentCount; m++)
-                        subtable->IndexDelta[m] = ReadI16(_file);
-                    //
-                    subtable->IndexRangeOffsets = malloc(sizeof(unsigned short) * segmentCount);
-                    for (int m = 0; m < segmentCount; m++)
-                        subtable->IndexRangeOffsets[m] = ReadI16(_file);
+                    subtable->EndCode = Borrow(_stream, segmentCount * 2);
+                    subtable->ReservedPad = ReadI16(_stream);
+                    subtable->StartCode = Borrow(_stream, segmentCount * 2);
+                    subtable->IndexDelta = Borrow(_stream, segmentCount * 2);
+                    subtable->IndexRangeOffsets = Borrow(_stream, segmentCount * 2);
                     //
                     int glyphIndexArrayCount = (subtable->Length -
                                                 ((16 /*8 2-byte fields*/) + (4 * (segmentCount * 2) /*4 arrays with (2-byte elements) with length = &segmentCount*/))) / 2;
-                    subtable->GlyphIndexArray = malloc(sizeof(unsigned short) * glyphIndexArrayCount);
-                    for (int m = 0; m < glyphIndexArrayCount; m++)
-                    {
-                        subtable->GlyphIndexArray[m] = ReadI16(_file);
-                    }
+                    subtable->GlyphIndexArray = Borrow(_stream, glyphIndexArrayCount > 0 ? glyphIndexArrayCount * 2 : 0);
 
                     table->Subtables[n] = (void*) subtable;
 
-                    fseek(_file, nextSubtableDescriptorPosition, SEEK_SET);
+                    if (subtable->EndCode == NULL || subtable->StartCode == NULL || subtable->IndexDelta == NULL ||
+                        subtable->IndexRangeOffsets == NULL || subtable->GlyphIndexArray == NULL)
+                    {
+                        return DiscardFont(font);
+                    }
+
+                    Seek(_stream, nextSubtableDescriptorPosition);
                 }
                 else if (tableFormat == 6)
                 {
                     CMAP_Subtable_Format6* subtable = P_CMAP_Subtable_Format6();
-                    subtable->Length = ReadI16(_file);
-                    subtable->Language = ReadI16(_file);
-                    subtable->FirstCode = ReadI16(_file);
-                    subtable->EntryCount = ReadI16(_file);
-                    subtable->GlyphIndexArray = malloc(sizeof(unsigned short) * subtable->EntryCount);
-                    for (int m = 0; m < subtable->EntryCount; m++)
-                        subtable->GlyphIndexArray[m] = ReadI16(_file);
+                    subtable->Length = ReadI16(_stream);
+                    subtable->Language = ReadI16(_stream);
+                    subtable->FirstCode = ReadI16(_stream);
+                    subtable->EntryCount = ReadI16(_stream);
+                    subtable->GlyphIndexArray = Borrow(_stream, subtable->EntryCount * 2);
 
                     table->Subtables[n] = (void*) subtable;
 
-                    fseek(_file, nextSubtableDescriptorPosition, SEEK_SET);
+                    if (subtable->GlyphIndexArray == NULL)
+                    {
+                        return DiscardFont(font);
+                    }
+
+                    Seek(_stream, nextSubtableDescriptorPosition);
                 }
                 else if (tableFormat == 12)
                 {
                     CMAP_Subtable_Format12* subtable = P_CMAP_Subtable_Format12();
-                    subtable->Length = ReadI32(_file);
-                    subtable->Language = ReadI32(_file);
-                    subtable->NumberOfGroups = ReadI32(_file);
-                    subtable->Groups = malloc(sizeof(SequentialMapGroup) * subtable->NumberOfGroups);
+                    Skip(_stream, 2); //ignoring the Reserved field (the format is 16.16)
+                    subtable->Length = ReadI32(_stream);
+                    subtable->Language = ReadI32(_stream);
+                    subtable->NumberOfGroups = ReadI32(_stream);
+                    subtable->Groups = subtable->NumberOfGroups <= _stream->Size / 12 ? Borrow(_stream, subtable->NumberOfGroups * 12) : NULL;
+
+                    table->Subtables[n] = (void*) subtable;
 
-                    for (int m = 0; m < subtable->NumberOfGroups; m++)
+                    if (subtable->Groups == NULL)
                     {
-                        SequentialMapGroup* group = malloc(sizeof(SequentialMapGroup));
-                        group->StartCharacterCode = ReadI32(_file);
-                        group->EndCharacterCode = ReadI32(_file);
-                        group->StartGlyphIndex = ReadI32(_file);
-                        subtable->Groups[m] = group;
+                        return DiscardFont(font);
                     }
 
-                    table->Subtables[n] = (void*) subtable;
-
-                    fseek(_file, nextSubtableDescriptorPosition, SEEK_SET);
+                    Seek(_stream, nextSubtableDescriptorPosition);
                 }
                 else if (tableFormat == 14)
                 {
                     table->Subtables[n] = NULL;
-                    fseek(_file, nextSubtableDescriptorPosition, SEEK_SET);
+                    Seek(_stream, nextSubtableDescriptorPosition);
                 }
                 else
                 {
-                    return NULL;
+                    return DiscardFont(font);
                 }
             }
 
-            font->Tables[i] = (void*) table;
+            if (_baked == NULL || !LoadBakedCodepointMap(table, _baked))
+            {
+                CompileCodepointMap(table);
+            }
         }
         else if (tagCharacter1 == 'h' && tagCharacter2 == 'e' && tagCharacter3 == 'a' && tagCharacter4 == 'd')
         {
             HEAD_Table* table = P_HEAD_Table();
-            table->MajorVersion = ReadI16(_file);
-            table->MinorVersion = ReadI16(_file);
-            table->FontMajorRevision = ReadI16(_file);
-            table->FontMinorRevision = ReadI16(_file);
-            table->ChecksumAdjacement = ReadI32(_file);
-            table->MagicNumber = ReadI32(_file);
-            table->Flags = ReadI16(_file);
-            table->UnitsPerEm = ReadI16(_file);
-            table->Created = ReadI64(_file);
-            table->Modified = ReadI64(_file);
-            table->MinX = ReadI16(_file);
-            table->MinY = ReadI16(_file);
-            table->MaxX = ReadI16(_file);
-            table->MaxY = ReadI16(_file);
-            table->MacStyle = ReadI16(_file);
-            table->LowestRecPPEM = ReadI16(_file);
-            table->FontDirectionHint = ReadI16(_file);
-            table->IndexToLocationFormat = ReadI16(_file);
-            table->GlyphDataFormat = ReadI16(_file);
-            font->Tables[i] = (void*) table;
+            table->MajorVersion = ReadI16(_stream);
+            table->MinorVersion = ReadI16(_stream);
+            table->FontMajorRevision = ReadI16(_stream);
+            table->FontMinorRevision = ReadI16(_stream);
+            table->ChecksumAdjacement = ReadI32(_stream);
+            table->MagicNumber = ReadI32(_stream);
+            table->Flags = ReadI16(_stream);
+            table->UnitsPerEm = ReadI16(_stream);
+            table->Created = ReadI64(_stream);
+            table->Modified = ReadI64(_stream);
+            table->MinX = ReadI16(_stream);
+            table->MinY = ReadI16(_stream);
+            table->MaxX = ReadI16(_stream);
+            table->MaxY = ReadI16(_stream);
+            table->MacStyle = ReadI16(_stream);
+            table->LowestRecPPEM = ReadI16(_stream);
+            table->FontDirectionHint = ReadI16(_stream);
+            table->IndexToLocationFormat = ReadI16(_stream);
+            table->GlyphDataFormat = ReadI16(_stream);
+            SetTable(font, i, (void*) table);
         }
         else if (tagCharacter1 == 'h' && tagCharacter2 == 'h' && tagCharacter3 == 'e' && tagCharacter4 == 'a')
         {
             HHEA_Table* table = P_HHEA_Table();
-            table->MajorVersion = ReadI16(_file);
-            table->MinorVersion = ReadI16(_file);
-            table->Ascender = ReadI16(_file);
-            table->Descender = ReadI16(_file);
-            table->LineGap = ReadI16(_file);
-            table->AdvancedWidthMax = ReadI16(_file);
-            table->MinLeftSideBearing = ReadI16(_file);
-            table->MinRightSideBearing = ReadI16(_file);
-            table->X_MaxExtent = ReadI16(_file);
-            table->CaretSlopeRise = ReadI16(_file);
-            table->CaretSlopeRun = ReadI16(_file);
-            table->CaretOffset = ReadI16(_file);
-            fseek(_file, ftell(_file) + 8, SEEK_SET); //ignoring a reserved segment
-            table->MetricDataFormat = ReadI16(_file);
-            table->NumberOfHorizontalMetrics = ReadI16(_file);
-            font->Tables[i] = (void*) table;
+            table->MajorVersion = ReadI16(_stream);
+            table->MinorVersion = ReadI16(_stream);
+            table->Ascender = ReadI16(_stream);
+            table->Descender = ReadI16(_stream);
+            table->LineGap = ReadI16(_stream);
+            table->AdvancedWidthMax = ReadI16(_stream);
+            table->MinLeftSideBearing = ReadI16(_stream);
+            table->MinRightSideBearing = ReadI16(_stream);
+            table->X_MaxExtent = ReadI16(_stream);
+            table->CaretSlopeRise = ReadI16(_stream);
+            table->CaretSlopeRun = ReadI16(_stream);
+            table->CaretOffset = ReadI16(_stream);
+            Skip(_stream, 8); //ignoring a reserved segment
+            table->MetricDataFormat = ReadI16(_stream);
+            table->NumberOfHorizontalMetrics = ReadI16(_stream);
+            SetTable(font, i, (void*) table);
         }
         else if (tagCharacter1 == 'v' && tagCharacter2 == 'h' && tagCharacter3 == 'e' && tagCharacter4 == 'a')
         {
-            font->Tables[i] = (void*) P_VHEA_Table();
+            SetTable(font, i, (void*) P_VHEA_Table());
         }
         else if (tagCharacter1 == 'k' && tagCharacter2 == 'e' && tagCharacter3 == 'r' && tagCharacter4 == 'n')
         {
             //(NOTE) kern-subtable-format-2 (not used in Windows) and it won't be supported for now
 
             KERN_Table* table = P_KERN_Table();
-            table->Version = ReadI16(_file);
-            table->NumberOfSubtables = ReadI16(_file);
+            table->Version = ReadI16(_stream);
+            table->NumberOfSubtables = ReadI16(_stream);
             table->Subtables = malloc(sizeof(void*) * table->NumberOfSubtables);
+            table->PairKeys = NULL;
+            table->PairValues = NULL;
+            table->FrequentGlyphs = NULL;
+            table->FrequentPairValues = NULL;
+            table->FrequentPairPresence = NULL;
+
+            for (int n = 0; n < table->NumberOfSubtables; n++)
+                table->Subtables[n] = NULL;
+
+            //(NOTE) the table is in the font before it's complete, so it's released with the font if the parsing fails
+            SetTable(font, i, (void*) table);
 
             //extracting the sub-tables
             for (int i = 0; i < table->NumberOfSubtables; i++)
             {
-                unsigned int version = ReadI16(_file);
-                unsigned int length = ReadI16(_file);
-                unsigned short coverage = ReadI16(_file);
+                size_t subtableBegin = _stream->Position;
+                unsigned int version = ReadI16(_stream);
+                unsigned int length = ReadI16(_stream);
+                unsigned short coverage = ReadI16(_stream);
 
                 //kern-subtable-format-0
                 if (version == 0)
@@ -1094,298 +2326,513 @@ Font* ParseFont(FILE* _file)
                     KERN_Subtable_Format0* subtable = P_KERN_Subtable_Format0();
                     subtable->Length = length;
                     subtable->Coverage = coverage;
-                    subtable->NumberOfPairs = ReadI16(_file);
-                    subtable->SearchRange = ReadI16(_file);
-                    subtable->EntrySelector = ReadI16(_file);
-                    subtable->RangeShift = ReadI16(_file);
-                    subtable->Pairs = malloc(sizeof(KerningPair) * subtable->NumberOfPairs);
-
-                    //extracting the kerning-pairs
-                    for (int i = 0; i < subtable->NumberOfPairs; i++)
+                    subtable->NumberOfPairs = ReadI16(_stream);
+                    subtable->SearchRange = ReadI16(_stream);
+                    subtable->EntrySelector = ReadI16(_stream);
+                    subtable->RangeShift = ReadI16(_stream);
+                    subtable->Pairs = Borrow(_stream, subtable->NumberOfPairs * 6);
+
+                    table->Subtables[i] = (void*) subtable;
+
+                    if (subtable->Pairs == NULL)
                     {
-                        KerningPair pair;
-                        pair.Left = ReadI16(_file);
-                        pair.Right = ReadI16(_file);
-                        pair.Value = ReadI16(_file);
-                        subtable->Pairs[i] = pair;
+                        return DiscardFont(font);
                     }
+                }
+                else
+                {
+                    table->Subtables[i] = NULL;
+                }
 
-                    table->Subtables[i] = (void*) subtable;
+                //(NOTE) the Length field is only 16 bits, so it's not reliable for subtables with more than ~10920 pairs
+                if (version != 0)
+                {
+                    Seek(_stream, subtableBegin + length);
                 }
             }
 
-            font->Tables[i] = (void*) table;
+            if (_baked == NULL || !LoadBakedKerningIndex(table, _baked))
+            {
+                IndexKerningPairs(table);
+            }
         }
         else if (tagCharacter1 == 'm' && tagCharacter2 == 'a' && tagCharacter3 == 'x' && tagCharacter4 == 'p')
         {
             MAXP_Table* table = P_MAXP_Table();
-            table->MajorVersion = ReadI16(_file);
-            table->MinorVersion = ReadI16(_file);
-            table->NumberOfGlyphs = ReadI16(_file);
-            table->MaxPoints = ReadI16(_file);
-            table->MaxContours = ReadI16(_file);
-            table->MaxCompositePoints = ReadI16(_file);
-            table->MaxCompositeContours = ReadI16(_file);
-            table->MaxZones = ReadI16(_file);
-            table->MaxTwilightPoints = ReadI16(_file);
-            table->MaxStorage = ReadI16(_file);
-            table->MaxFunctionDefinitions = ReadI16(_file);
-            table->MaxInstructionDefinitions = ReadI16(_file);
-            table->MaxStackElements = ReadI16(_file);
-            table->MaxSizeOfInstructions = ReadI16(_file);
-            table->MaxComponentElements = ReadI16(_file);
-            table->MaxComponentDepth = ReadI16(_file);
-            font->Tables[i] = (void*) table;
+            table->MajorVersion = ReadI16(_stream);
+            table->MinorVersion = ReadI16(_stream);
+            table->NumberOfGlyphs = ReadI16(_stream);
+            table->MaxPoints = ReadI16(_stream);
+            table->MaxContours = ReadI16(_stream);
+            table->MaxCompositePoints = ReadI16(_stream);
+            table->MaxCompositeContours = ReadI16(_stream);
+            table->MaxZones = ReadI16(_stream);
+            table->MaxTwilightPoints = ReadI16(_stream);
+            table->MaxStorage = ReadI16(_stream);
+            table->MaxFunctionDefinitions = ReadI16(_stream);
+            table->MaxInstructionDefinitions = ReadI16(_stream);
+            table->MaxStackElements = ReadI16(_stream);
+            table->MaxSizeOfInstructions = ReadI16(_stream);
+            table->MaxComponentElements = ReadI16(_stream);
+            table->MaxComponentDepth = ReadI16(_stream);
+            SetTable(font, i, (void*) table);
         }
         else if (tagCharacter1 == 'O' && tagCharacter2 == 'S' && tagCharacter3 == '/' && tagCharacter4 == '2')
         {
             OS2_Table* table = P_OS2_Table();
-            table->Version = ReadI16(_file);
-            table->X_AverageCharacterWidth = ReadI16(_file);
-            table->US_WeightClass = ReadI16(_file);
-            table->US_WidthClass = ReadI16(_file);
-            table->FS_Type = ReadI16(_file);
-            table->Y_SubscriptXSize = ReadI16(_file);
-            table->Y_SubscriptYSize = ReadI16(_file);
-            table->Y_SubscriptXOffset = ReadI16(_file);
-            table->Y_SubscriptYOffset = ReadI16(_file);
-            table->Y_SuperscriptXSize = ReadI16(_file);
-            table->Y_SuperscriptYSize = ReadI16(_file);
-            table->Y_SuperscriptXOffset = ReadI16(_file);
-            table->Y_SuperscriptYOffset = ReadI16(_file);
-            table->Y_StrikeoutSize = ReadI16(_file);
-            table->Y_StrikeoutPosition = ReadI16(_file);
-            table->S_FamilyClass = ReadI16(_file);
+            table->Version = ReadI16(_stream);
+            table->X_AverageCharacterWidth = ReadI16(_stream);
+            table->US_WeightClass = ReadI16(_stream);
+            table->US_WidthClass = ReadI16(_stream);
+            table->FS_Type = ReadI16(_stream);
+            table->Y_SubscriptXSize = ReadI16(_stream);
+            table->Y_SubscriptYSize = ReadI16(_stream);
+            table->Y_SubscriptXOffset = ReadI16(_stream);
+            table->Y_SubscriptYOffset = ReadI16(_stream);
+            table->Y_SuperscriptXSize = ReadI16(_stream);
+            table->Y_SuperscriptYSize = ReadI16(_stream);
+            table->Y_SuperscriptXOffset = ReadI16(_stream);
+            table->Y_SuperscriptYOffset = ReadI16(_stream);
+            table->Y_StrikeoutSize = ReadI16(_stream);
+            table->Y_StrikeoutPosition = ReadI16(_stream);
+            table->S_FamilyClass = ReadI16(_stream);
             for (int n = 0; n < 10; n++)
-                table->Panose[i] = ReadI8(_file);
-            table->UL_UnicodeRange[0] = ReadI32(_file);
-            table->UL_UnicodeRange[1] = ReadI32(_file);
-            table->UL_UnicodeRange[2] = ReadI32(_file);
-            table->UL_UnicodeRange[3] = ReadI32(_file);
+                table->Panose[n] = ReadI8(_stream);
+            table->UL_UnicodeRange[0] = ReadI32(_stream);
+            table->UL_UnicodeRange[1] = ReadI32(_stream);
+            table->UL_UnicodeRange[2] = ReadI32(_stream);
+            table->UL_UnicodeRange[3] = ReadI32(_stream);
             for (int n = 0; n < 4; n++)
-                table->VendorID[i] = ReadI8(_file);
-            table->FS_Selection = ReadI16(_file);
-            table->US_FirstCharIndex = ReadI16(_file);
-            table->US_LastCharIndex = ReadI16(_file);
-            table->S_TypographicAscender = ReadI16(_file);
-            table->S_TypographicDescender = ReadI16(_file);
-            table->S_TypographicLineGap = ReadI16(_file);
-            table->US_WinAscent = ReadI16(_file);
-            table->US_WinDescent = ReadI16(_file);
+                table->VendorID[n] = ReadI8(_stream);
+            table->FS_Selection = ReadI16(_stream);
+            table->US_FirstCharIndex = ReadI16(_stream);
+            table->US_LastCharIndex = ReadI16(_stream);
+            table->S_TypographicAscender = ReadI16(_stream);
+            table->S_TypographicDescender = ReadI16(_stream);
+            table->S_TypographicLineGap = ReadI16(_stream);
+            table->US_WinAscent = ReadI16(_stream);
+            table->US_WinDescent = ReadI16(_stream);
+
+            if (table->Version > 0)
+            {
+                table->UL_CodePageRange1 = ReadI32(_stream);
+                table->UL_CodePageRange2 = ReadI32(_stream);
+            }
+
+            if (table->Version > 1)
+            {
+                table->SX_Height = ReadI16(_stream);
+                table->S_CapHeight = ReadI16(_stream);
+                table->US_DefaultChar = ReadI16(_stream);
+                table->US_BreakChar = ReadI16(_stream);
+                table->US_MaxContext = ReadI16(_stream);
+            }
+
+            if (table->Version > 4)
+            {
+                table->US_LowerOpticalPointSize = ReadI16(_stream);
+                table->US_UpperOpticalPointSize = ReadI16(_stream);
+            }
+
+            SetTable(font, i, (void*) table);
+        }
+
+        //position the file at the beginning for the next table header
+        Seek(_stream, tableHeaderBegin);
+    }
+
+    ///EXTRACTING THE DATA FROM TABLES hmtx AND loca
+
+    /* (A) (hmtx depends on hhea and maxp), (loca depends on head and maxp), and there is no guarantee that (tested with ROCKWELL.ttf in Windows 11),
+        hhea, head and maxp will be located before hmtx/loca in the file; that's why the data from these two tables must be extracted
+        after extraction of the other tables (with exception of glyf) */
+
+    //(E) the tables on which hmtx, loca and glyf depend are missing (a truncated file, for example)
+    if (GetTable(font, HEAD_TABLE) == NULL || GetTable(font, HHEA_TABLE) == NULL || GetTable(font, MAXP_TABLE) == NULL)
+    {
+        return DiscardFont(font);
+    }
+
+    LOCA_Table* locaTable = NULL;
+
+    //position the file at the beginning of the of the table list
+    Seek(_stream, 12);
+
+    for (int i = 0; i < font->NumberOfTables; i++)
+    {
+        unsigned char tagCharacter1 = ReadI8(_stream);
+        unsigned char tagCharacter2 = ReadI8(_stream);
+        unsigned char tagCharacter3 = ReadI8(_stream);
+        unsigned char tagCharacter4 = ReadI8(_stream);
+        Skip(_stream, 4); //ignoring the Checksum field
+        unsigned int tableOffset = ReadI32(_stream);
+        Skip(_stream, 4); //ignoring the Length field
+
+        //this variable is needed because a jump (to the header of the next table) has to be performed after extraction of this table
+        int tableHeaderBegin = _stream->Position;
+
+        Seek(_stream, tableOffset);
+
+        if (tagCharacter1 == 'h' && tagCharacter2 == 'm' && tagCharacter3 == 't' && tagCharacter4 == 'x')
+        {
+            HMTX_Table* table = P_HMTX_Table();
+
+            unsigned short numberOfHorizontalMetrics = ((HHEA_Table*) GetTable(font, HHEA_TABLE))->NumberOfHorizontalMetrics;
+            unsigned short numberOfGlyphs = ((MAXP_Table*) GetTable(font, MAXP_TABLE))->NumberOfGlyphs;
+
+            //(E) there are more metrics than glyphs (a damaged file)
+            if (numberOfHorizontalMetrics > numberOfGlyphs)
+            {
+                free(table);
+                return DiscardFont(font);
+            }
+
+            if (_baked == NULL || !LoadBakedHorizontalMetrics(table, _baked, numberOfGlyphs, numberOfHorizontalMetrics))
+            {
+                table->HorizontalMetrics = malloc(sizeof(LongHorizontalMetric) * numberOfGlyphs);
+                table->LeftSideBearings = malloc(sizeof(short) * (numberOfGlyphs - numberOfHorizontalMetrics));
+
+                int lastAdvanceWidth;
+
+                //extracting horizontal metrics
+                for (int n = 0; n < numberOfHorizontalMetrics; n++)
+                {
+                    LongHorizontalMetric metric;
+                    metric.AdvanceWidth = ReadI16(_stream);
+                    metric.LeftSideBearing = ReadI16(_stream);
+                    table->HorizontalMetrics[n] = metric;
+                    lastAdvanceWidth = metric.AdvanceWidth;
+                }
+
+                //extracting left side bearings
+                for (int n = numberOfHorizontalMetrics; n < numberOfGlyphs; n++)
+                {
+                    table->LeftSideBearings[n - numberOfHorizontalMetrics] = ReadI16(_stream);
+                    table->HorizontalMetrics[n].AdvanceWidth = lastAdvanceWidth;
+                    table->HorizontalMetrics[n].LeftSideBearing = table->LeftSideBearings[n - numberOfHorizontalMetrics];
+                }
+            }
+
+            SetTable(font, i, (void*) table);
+        }
+        else if (tagCharacter1 == 'l' && tagCharacter2 == 'o' && tagCharacter3 == 'c' && tagCharacter4 == 'a')
+        {
+            short tableType = ((HEAD_Table*)GetTable(font, HEAD_TABLE))->IndexToLocationFormat;
+            unsigned short numberOfGlyphs = ((MAXP_Table*)GetTable(font, MAXP_TABLE))->NumberOfGlyphs;
+
+            locaTable = P_LOCA_Table();
+
+            //0 :: 'short' version | 1 :: 'long' version
+            locaTable->ArrayType = tableType == 0 ? 0 : 1;
+            locaTable->Offsets = Borrow(_stream, (numberOfGlyphs + 1) * (tableType == 0 ? 2 : 4));
+
+            SetTable(font, i, (void*) locaTable);
+
+            if (locaTable->Offsets == NULL)
+            {
+                return DiscardFont(font);
+            }
+        }
+
+        //positioning the file at the beginning of the next table header
+        Seek(_stream, tableHeaderBegin);
+    }
+
+    ///EXTRACTING THE DATA FROM TABLE glyf
+
+    /* (A) (glyf depends on loca and maxp), and there is no guarantee (tested with ROCKWELL.ttf in Windows 11), that loca and maxp
+           will be located before table glyf in the file; that's why the data from these two tables must be extracted after the
+           extraction of the other tables */
+
+    //position the file at the beginning of the of the table list
+    Seek(_stream, 12);
+
+    for (int i = 0; i < font->NumberOfTables; i++)
+    {
+        unsigned char tagCharacter1 = ReadI8(_stream);
+        unsigned char tagCharacter2 = ReadI8(_stream);
+        unsigned char tagCharacter3 = ReadI8(_stream);
+        unsigned char tagCharacter4 = ReadI8(_stream);
+        Skip(_stream, 4); //ignoring the Checksum field
+        unsigned int tableOffset = ReadI32(_stream);
+        Skip(_stream, 4); //ignoring the Length field
+
+        //this variable is needed because a jump (to the header of the next table) has to be performed after extraction of this table
+        int tableHeaderBegin = _stream->Position;
+
+        Seek(_stream, tableOffset);
+
+        if (tagCharacter1 == 'g' && tagCharacter2 == 'l' && tagCharacter3 == 'y' && tagCharacter4 == 'f')
+        {
+            //(E) the glyphs cannot be located without the loca table
+            if (locaTable == NULL)
+            {
+                return DiscardFont(font);
+            }
+
+            GLYF_Table* table = P_GLYF_Table();
+
+            unsigned short numberOfGlyphs = ((MAXP_Table*)GetTable(font, MAXP_TABLE))->NumberOfGlyphs;
+
+            table->NumberOfGlyphs = numberOfGlyphs;
+            table->FontData = _stream->Data;
+            table->FontDataSize = _stream->Size;
+            table->Offset = tableOffset;
+            table->Loca = locaTable;
+            table->AccessClock = 0;
+            table->IsShared = false;
+            InitializeArena(&table->Arena);
+            table->BakedGlyphs = NULL;
+
+            //(NOTE) the glyphs are not extracted here - every glyph is extracted on its first access (see GetGlyphByIndex)
+            table->Glyphs = malloc(sizeof(void*) * numberOfGlyphs);
+            table->LastAccess = malloc(sizeof(unsigned int) * numberOfGlyphs);
+
+            for (int n = 0; n < numberOfGlyphs; n++)
+            {
+                table->Glyphs[n] = NULL;
+                table->LastAccess[n] = 0;
+            }
+
+            if (_baked != NULL)
+            {
+                LoadBakedGlyphs(table, _baked);
+            }
+
+            SetTable(font, i, (void*) table);
+        }
+
+        //position the file at the beginning for the next table header
+        Seek(_stream, tableHeaderBegin);
+    }
+
+    return font;
+}
+
+//(PUBLIC)
+//the font is parsed in-place - no copy of _data is made, so _data has to stay valid (and unchanged) until ReleaseFont is called
+//_data is not a supported font file => NULL
+Font* ParseFontFromMemory(const void* _data, size_t _size)
+{
+    FontStream stream;
+    stream.Data = (const unsigned char*) _data;
+    stream.Size = _size;
+    stream.Position = 0;
+    return ParseFontStream(&stream, NULL);
+}
+
+//(PUBLIC)
+//the whole file is read in a buffer owned by the font
+//_file is a valid file object positioned at the beginning of the font ->
+Font* ParseFont(FILE* _file)
+{
+    long begin = ftell(_file);
+    fseek(_file, 0, SEEK_END);
+    long size = ftell(_file) - begin;
+    fseek(_file, begin, SEEK_SET);
 
-            if (table->Version > 0)
-            {
-                table->UL_CodePageRange1 = ReadI32(_file);
-                table->UL_CodePageRange2 = ReadI32(_file);
-            }
+    if (size <= 0)
+    {
+        return NULL;
+    }
 
-            if (table->Version > 1)
-            {
-                table->SX_Height = ReadI16(_file);
-                table->S_CapHeight = ReadI16(_file);
-                table->US_DefaultChar = ReadI16(_file);
-                table->US_BreakChar = ReadI16(_file);
-                table->US_MaxContext = ReadI16(_file);
-            }
+    unsigned char* data = malloc(size);
 
-            if (table->Version > 4)
-            {
-                table->US_LowerOpticalPointSize = ReadI16(_file);
-                table->US_UpperOpticalPointSize = ReadI16(_file);
-            }
+    if (fread(data, 1, size, _file) != (size_t) size)
+    {
+        free(data);
+        return NULL;
+    }
 
-            font->Tables[i] = (void*) table;
-        }
+    Font* font = ParseFontFromMemory(data, size);
 
-        //position the file at the beginning for the next table header
-        fseek(_file, tableHeaderBegin, SEEK_SET);
+    if (font == NULL)
+    {
+        free(data);
+        return NULL;
     }
 
-    ///EXTRACTING THE DATA FROM TABLES hmtx AND loca
+    font->DataOwnership = 1;
+    return font;
+}
 
-    /* (A) (hmtx depends on hhea and maxp), (loca depends on head and maxp), and there is no guarantee that (tested with ROCKWELL.ttf in Windows 11),
-        hhea, head and maxp will be located before hmtx/loca in the file; that's why the data from these two tables must be extracted
-        after extraction of the other tables (with exception of glyf) */
+//(PRIVATE)
+/* maps the file in the memory - read-only, or copy-on-write if _writable is set (the changes are private and they are not written to the file);
+   the view is released with UnmapFile */
+//(NOTE) on systems without mmap/MapViewOfFile the file is read in a buffer
+//the file cannot be opened or it's empty => NULL
+void* MapFile(const char* _filePath, bool _writable, size_t* _size)
+{
+    #if defined(_WIN32)
 
-    LOCA_Table* locaTable = P_LOCA_Table();
+    HANDLE file = CreateFileA(_filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
 
-    //position the file at the beginning of the of the table list
-    fseek(_file, 12, SEEK_SET);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return NULL;
+    }
 
-    for (int i = 0; i < font->NumberOfTables; i++)
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    void* data = NULL;
+    *_size = 0;
+
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
     {
-        unsigned char tagCharacter1 = ReadI8(_file);
-        unsigned char tagCharacter2 = ReadI8(_file);
-        unsigned char tagCharacter3 = ReadI8(_file);
-        unsigned char tagCharacter4 = ReadI8(_file);
-        fseek(_file, ftell(_file) + 4, SEEK_SET); //ignoring the Checksum field
-        unsigned int tableOffset = ReadI32(_file);
-        fseek(_file, ftell(_file) + 4, SEEK_SET); //ignoring the Length field
+        *_size = (size_t) size.QuadPart;
+        mapping = CreateFileMappingA(file, NULL, _writable ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    }
 
-        //this variable is needed because a jump (to the header of the next table) has to be performed after extraction of this table
-        int tableHeaderBegin = ftell(_file);
+    if (mapping != NULL)
+    {
+        data = MapViewOfFile(mapping, _writable ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping); //the view keeps the mapping alive
+    }
 
-        fseek(_file, tableOffset, SEEK_SET);
+    CloseHandle(file);
 
-        if (tagCharacter1 == 'h' && tagCharacter2 == 'm' && tagCharacter3 == 't' && tagCharacter4 == 'x')
-        {
-            HMTX_Table* table = P_HMTX_Table();
+    return data;
 
-            unsigned short numberOfHorizontalMetrics = ((HHEA_Table*) GetTable(font, HHEA_TABLE))->NumberOfHorizontalMetrics;
-            unsigned short numberOfGlyphs = ((MAXP_Table*) GetTable(font, MAXP_TABLE))->NumberOfGlyphs;
+    #elif defined(__unix__) || defined(__APPLE__)
 
-            table->HorizontalMetrics = malloc(sizeof(LongHorizontalMetric) * numberOfGlyphs);
-            table->LeftSideBearings = malloc(sizeof(short) * (numberOfGlyphs - numberOfHorizontalMetrics));
+    int file = open(_filePath, O_RDONLY);
 
-            int lastAdvanceWidth;
+    if (file == -1)
+    {
+        return NULL;
+    }
 
-            //extracting horizontal metrics
-            for (int n = 0; n < numberOfHorizontalMetrics; n++)
-            {
-                LongHorizontalMetric metric;
-                metric.AdvanceWidth = ReadI16(_file);
-                metric.LeftSideBearing = ReadI16(_file);
-                table->HorizontalMetrics[n] = metric;
-                lastAdvanceWidth = metric.AdvanceWidth;
-            }
+    struct stat status;
+    void* data = MAP_FAILED;
+    *_size = 0;
 
-            //extracting left side bearings
-            for (int n = numberOfHorizontalMetrics; n < numberOfGlyphs; n++)
-            {
-                table->LeftSideBearings[n - numberOfHorizontalMetrics] = ReadI16(_file);
-                table->HorizontalMetrics[n].AdvanceWidth = lastAdvanceWidth;
-                table->HorizontalMetrics[n].LeftSideBearing = table->LeftSideBearings[n - numberOfHorizontalMetrics];
-            }
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        *_size = status.st_size;
+        data = mmap(NULL, status.st_size, _writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, file, 0);
+    }
 
-            font->Tables[i] = (void*) table;
-        }
-        else if (tagCharacter1 == 'l' && tagCharacter2 == 'o' && tagCharacter3 == 'c' && tagCharacter4 == 'a')
-        {
-            short tableType = ((HEAD_Table*)GetTable(font, HEAD_TABLE))->IndexToLocationFormat;
-            unsigned short numberOfGlyphs = ((MAXP_Table*)GetTable(font, MAXP_TABLE))->NumberOfGlyphs;
+    close(file); //the mapping keeps the file alive
 
-            //'short' version
-            if (tableType == 0)
-            {
-                unsigned short* array = malloc(sizeof(unsigned short) * (numberOfGlyphs + 1));
+    return data == MAP_FAILED ? NULL : data;
 
-                for (int i = 0; i < numberOfGlyphs + 1; i++)
-                {
-                    array[i] = ReadI16(_file);
-                }
+    #else
 
-                locaTable->Offsets = (void*) array;
-                locaTable->ArrayType = 0;
-            }
-                //'long' version
-            else
-            {
-                unsigned int* array = malloc(sizeof(unsigned int) * (numberOfGlyphs + 1));
+    FILE* file = fopen(_filePath, "rb");
 
-                for (int i = 0; i < numberOfGlyphs + 1; i++)
-                {
-                    array[i] = ReadI32(_file);
-                }
+    if (file == NULL)
+    {
+        return NULL;
+    }
 
-                locaTable->Offsets = (void*) array;
-                locaTable->ArrayType = 1;
-            }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
 
-            font->Tables[i] = (void*) locaTable;
-        }
+    void* data = size > 0 ? malloc(size) : NULL;
 
-        //positioning the file at the beginning of the next table header
-        fseek(_file, tableHeaderBegin, SEEK_SET);
+    if (data != NULL && fread(data, 1, size, file) != (size_t) size)
+    {
+        free(data);
+        data = NULL;
     }
 
-    ///EXTRACTING THE DATA FROM TABLE glyf
-
-    /* (A) (glyf depends on loca and maxp), and there is no guarantee (tested with ROCKWELL.ttf in Windows 11), that loca and maxp
-           will be located before table glyf in the file; that's why the data from these two tables must be extracted after the
-           extraction of the other tables */
+    fclose(file);
 
-    //position the file at the beginning of the of the table list
-    fseek(_file, 12, SEEK_SET);
+    *_size = size > 0 ? size : 0;
+    return data;
 
-    for (int i = 0; i < font->NumberOfTables; i++)
-    {
-        unsigned char tagCharacter1 = ReadI8(_file);
-        unsigned char tagCharacter2 = ReadI8(_file);
-        unsigned char tagCharacter3 = ReadI8(_file);
-        unsigned char tagCharacter4 = ReadI8(_file);
-        fseek(_file, ftell(_file) + 4, SEEK_SET); //ignoring the Checksum field
-        unsigned int tableOffset = ReadI32(_file);
-        fseek(_file, ftell(_file) + 4, SEEK_SET); //ignoring the Length field
+    #endif
+}
 
-        //this variable is needed because a jump (to the header of the next table) has to be performed after extraction of this table
-        int tableHeaderBegin = ftell(_file);
+//(PRIVATE)
+//releases a view returned by MapFile
+void UnmapFile(void* _data, size_t _size)
+{
+    #if defined(_WIN32)
+        UnmapViewOfFile(_data);
+    #elif defined(__unix__) || defined(__APPLE__)
+        munmap(_data, _size);
+    #else
+        free(_data);
+    #endif
+}
 
-        fseek(_file, tableOffset, SEEK_SET);
+//(PUBLIC)
+//the file is mapped (read-only) in the memory and the font is parsed in-place; the mapping is released by ReleaseFont
+//(NOTE) on systems without mmap/MapViewOfFile the file is read in a buffer, as with ParseFont
+//the file cannot be opened or it's not a supported font file => NULL
+Font* ParseFontFromMappedFile(const char* _filePath)
+{
+    size_t size;
+    void* data = MapFile(_filePath, false, &size);
 
-        if (tagCharacter1 == 'g' && tagCharacter2 == 'l' && tagCharacter3 == 'y' && tagCharacter4 == 'f')
-        {
-            GLYF_Table* table = P_GLYF_Table();
+    if (data == NULL)
+    {
+        return NULL;
+    }
 
-            unsigned short numberOfGlyphs = ((MAXP_Table*)GetTable(font, MAXP_TABLE))->NumberOfGlyphs;
+    Font* font = ParseFontFromMemory(data, size);
 
-            table->NumberOfGlyphs = numberOfGlyphs;
-            table->Glyphs = malloc(sizeof(void*) * numberOfGlyphs);
+    if (font == NULL)
+    {
+        UnmapFile(data, size);
+        return NULL;
+    }
 
-            //for every glyph in the table
-            for (int n = 0; n < numberOfGlyphs; n++)
-            {
-                //determine the position (relative to the beginning of table glyf) of glyph (index)'n'
+    font->DataOwnership = 2;
+    return font;
+}
 
-                int glyphOffset;
-                int nextGlyphOffset;
+//(PUBLIC)
+/* loads a file written by BakeFont; the file is mapped (copy-on-write) in the memory, and the compiled cmap, the kerning index, the metrics and
+   the glyphs are used directly from it, so only the small tables are parsed; the mapping is released by ReleaseFont */
+//the file cannot be opened or it's not a baked font (or it's baked by another version of the library / on another kind of machine) => NULL
+Font* LoadBakedFont(const char* _filePath)
+{
+    size_t size;
+    unsigned char* data = MapFile(_filePath, true, &size);
 
-                //uint16 values
-                if (n < numberOfGlyphs && locaTable->ArrayType == 0)
-                {
-                    glyphOffset = ((unsigned short*)locaTable->Offsets)[n] * 2;
-                    nextGlyphOffset = ((unsigned short*)locaTable->Offsets)[n + 1] * 2;
-                }
-                    //uint32 values
-                else if (n < numberOfGlyphs)
-                {
-                    glyphOffset = ((unsigned int*)locaTable->Offsets)[n];
-                    nextGlyphOffset = ((unsigned int*)locaTable->Offsets)[n + 1];
-                }
+    if (data == NULL)
+    {
+        return NULL;
+    }
 
-                //if the contour has no glyphs
-                if (glyphOffset == nextGlyphOffset)
-                {
-                    table->Glyphs[n] = P_EmptyGlyph();
-                    continue;
-                }
+    const BakedFontHeader* header = (const BakedFontHeader*) data;
 
-                fseek(_file, tableOffset + glyphOffset, SEEK_SET);
+    FontStream baked;
+    baked.Data = data;
+    baked.Size = size;
+    baked.Position = 0;
 
-                ///reading the glyph
+    const unsigned char* fontData = NULL;
 
-                //reading the header
+    if (size >= sizeof(BakedFontHeader) && header->Signature[0] == 'T' && header->Signature[1] == 'T' && header->Signature[2] == 'B' &&
+        header->Signature[3] == 'K' && header->Version == BAKED_FONT_VERSION && header->ByteOrder == 0x01020304 && header->PointerSize == sizeof(void*))
+    {
+        fontData = GetBakedSection(&baked, header->FontDataOffset, header->FontDataSize);
+    }
 
-                short numberOfContours = ReadI16(_file);
+    if (fontData == NULL)
+    {
+        UnmapFile(data, size);
+        return NULL;
+    }
 
-                //if the glyph is simple
-                if (numberOfContours >= 0)
-                {
-                    table->Glyphs[n] = ExtractSimpleGlyph(_file, numberOfContours);
-                }
-                //(STATE) the glyph is composite
-                else
-                {
-                    table->Glyphs[n] = ExtractCompositeGlyph(_file);
-                }
-            }
+    FontStream stream;
+    stream.Data = fontData;
+    stream.Size = header->FontDataSize;
+    stream.Position = 0;
 
-            font->Tables[i] = (void*) table;
-        }
+    Font* font = ParseFontStream(&stream, &baked);
 
-        //position the file at the beginning for the next table header
-        fseek(_file, tableHeaderBegin, SEEK_SET);
+    if (font == NULL)
+    {
+        UnmapFile(data, size);
+        return NULL;
     }
 
+    font->DataOwnership = 3;
     return font;
 }
 
@@ -1395,6 +2842,24 @@ int GetGlyphIndex(const Font* _font, int _codepoint)
 {
     CMAP_Table* cmap = (CMAP_Table*) GetTable(_font, CMAP_TABLE);
 
+    if (_codepoint < 0 || _codepoint > 0x10FFFF)
+    {
+        return -1;
+    }
+
+    //the Basic Multilingual Plane is looked up directly, the other planes through their pages
+    unsigned short glyphIndex = _codepoint < 65536 ? cmap->BasicPlane[_codepoint] : cmap->CodepointPages[_codepoint >> 8][_codepoint & 255];
+
+    return glyphIndex == 0xFFFF ? -1 : glyphIndex;
+}
+
+//(PUBLIC)
+//the same as GetGlyphIndex, but it walks the sub-tables instead of using the compiled map; it's slow and it's meant for testing only
+//(the glyph corresponding to the specified codepoint) does not exist in the file => -1
+int GetGlyphIndexFromSubtables(const Font* _font, int _codepoint)
+{
+    CMAP_Table* cmap = (CMAP_Table*) GetTable(_font, CMAP_TABLE);
+
     for (int i = cmap->NumberOfSubtables - 1; i > -1; i--)
     {
         if (cmap->Subtables[i] == NULL)
@@ -1409,9 +2874,11 @@ int GetGlyphIndex(const Font* _font, int _codepoint)
 
             for (int i = 0; i < subtable->NumberOfGroups; i++)
             {
-                if (_codepoint >= subtable->Groups[i]->StartCharacterCode && _codepoint <= subtable->Groups[i]->EndCharacterCode)
+                SequentialMapGroup group = GetSequentialMapGroup(subtable, i);
+
+                if (_codepoint >= group.StartCharacterCode && _codepoint <= group.EndCharacterCode)
                 {
-                    return subtable->Groups[i]->StartGlyphIndex + _codepoint - subtable->Groups[i]->StartCharacterCode;
+                    return group.StartGlyphIndex + _codepoint - group.StartCharacterCode;
                 }
             }
 
@@ -1429,7 +2896,7 @@ int GetGlyphIndex(const Font* _font, int _codepoint)
             }
             else
             {
-                return subtable->GlyphIndexArray[_codepoint - subtable->FirstCode];
+                return BE16(subtable->GlyphIndexArray + (_codepoint - subtable->FirstCode) * 2);
             }
         }
         else if (Is(cmap->Subtables[i], CMAP_SUBTABLE_FORMAT4))
@@ -1440,9 +2907,11 @@ int GetGlyphIndex(const Font* _font, int _codepoint)
 
             for (int n = 0; n < segmentCount; n++)
             {
-                if (subtable->EndCode[n] >= _codepoint)
+                if (BE16(subtable->EndCode + n * 2) >= _codepoint)
                 {
-                    int correspondingStartCode = subtable->StartCode[n];
+                    int correspondingStartCode = BE16(subtable->StartCode + n * 2);
+                    unsigned short indexRangeOffset = BE16(subtable->IndexRangeOffsets + n * 2);
+                    unsigned short indexDelta = BE16(subtable->IndexDelta + n * 2);
 
                     /* (SOURCE Apple) "If the corresponding startCode is less than or equal to the character code, then use the corresponding idDelta and
                         idRangeOffset to map the character code to the glyph index. Otherwise, the missing character glyph is returned. " */
@@ -1450,16 +2919,16 @@ int GetGlyphIndex(const Font* _font, int _codepoint)
                     {
                         /* (SOURCE Apple) "If the idRangeOffset value for the segment is not 0, the mapping of the character codes
                             relies on the glyphIndexArray." */
-                        if (subtable->IndexRangeOffsets[n] != 0)
+                        if (indexRangeOffset != 0)
                         {
-                            unsigned short glyphIndex = subtable->GlyphIndexArray[
-                                    (subtable->IndexRangeOffsets[n] / 2 /*as these indexes are in bytes*/) - (segmentCount - n) + (_codepoint - subtable->StartCode[n])];
+                            unsigned short glyphIndex = BE16(subtable->GlyphIndexArray + 2 *
+                                    ((indexRangeOffset / 2 /*as these indexes are in bytes*/) - (segmentCount - n) + (_codepoint - correspondingStartCode)));
 
                             /* (SOURCE Apple) "Once the glyph indexing operation is complete, the glyph ID at the indicated address is checked.
                                 If it's not 0 (that is, if it's not the missing glyph), the value is added to idDelta[i] to get the actual glyph ID to use." */
                             if (glyphIndex != 0)
                             {
-                                return glyphIndex + subtable->IndexDelta[n];
+                                return (glyphIndex + indexDelta) % 65536;
                             }
                             else
                             {
@@ -1469,7 +2938,7 @@ int GetGlyphIndex(const Font* _font, int _codepoint)
                             //(SOURCE Apple) "If the idRangeOffset is 0, the idDelta value is added directly to the character code to get the corresponding glyph index."
                         else
                         {
-                            return (subtable->IndexDelta[n] + _codepoint) % 65536;
+                            return (indexDelta + _codepoint) % 65536;
                         }
                     }
                     else
@@ -1494,32 +2963,195 @@ int GetGlyphIndex(const Font* _font, int _codepoint)
     return -1;
 }
 
+//(PUBLIC)
+//the glyph is extracted from the font data on its first access; the returned glyph is valid until it's released by ReleaseGlyph/TrimGlyphs/ReleaseFont
+//(NOTE) the first access of a glyph modifies the font, so the font must not be used by multiple threads unless LoadAllGlyphs is called first
+//_glyphIndex is not a valid glyph index => NULL
+void* GetGlyphByIndex(const Font* _font, int _glyphIndex)
+{
+    GLYF_Table* glyf = (GLYF_Table*) GetTable(_font, GLYF_TABLE);
+
+    if (glyf == NULL || _glyphIndex < 0 || _glyphIndex >= glyf->NumberOfGlyphs)
+    {
+        return NULL;
+    }
+
+    if (glyf->Glyphs[_glyphIndex] == NULL)
+    {
+        glyf->Glyphs[_glyphIndex] = ExtractGlyph(glyf, _glyphIndex);
+    }
+
+    if (!glyf->IsShared)
+    {
+        glyf->LastAccess[_glyphIndex] = ++glyf->AccessClock;
+    }
+
+    return glyf->Glyphs[_glyphIndex];
+}
+
 //(PUBLIC)
 //the codepoint does not exist in the file => NULL
 //_characterIndex < 0 :: index in the table glyf | _characterIndex >= 0 :: codepoint
 void* GetGlyph(const Font* _font, int _characterIndex)
 {
-    GLYF_Table* glyf = (GLYF_Table*) GetTable(_font, GLYF_TABLE);
+    int glyphIndex;
+
+    if (_characterIndex >= 0)
+    {
+        glyphIndex = GetGlyphIndex(_font, _characterIndex);
+    }
+    else
+    {
+        glyphIndex = -_characterIndex;
+    }
+
+    if (glyphIndex != -1)
+    {
+        return GetGlyphByIndex(_font, glyphIndex);
+    }
+    else
+    {
+        return NULL;
+    }
+}
+
+//(PUBLIC)
+//converts the characters of _string to glyph indexes (in _glyphIndexes); a character without a glyph is converted to glyph 0 (the 'missing glyph')
+//returns the number of characters without a glyph
+//_glyphIndexes has space for (atleast) _stringLength elements ->
+int MapString(const Font* _font, const wchar_t* _string, int _stringLength, unsigned short* _glyphIndexes)
+{
+    int missingGlyphs = 0;
+
+    for (int i = 0; i < _stringLength; i++)
+    {
+        int glyphIndex = GetGlyphIndex(_font, _string[i]);
+
+        if (glyphIndex == -1)
+        {
+            glyphIndex = 0;
+            missingGlyphs++;
+        }
+
+        _glyphIndexes[i] = glyphIndex;
+    }
+
+    return missingGlyphs;
+}
+
+//(PUBLIC)
+//the return value is in Funit-s
+//_glyphIndex is a valid glyph index ->
+int GetGlyphLeftSideBearing(const Font* _font, int _glyphIndex)
+{
+    HMTX_Table* hmtx = (HMTX_Table*) GetTable(_font, HMTX_TABLE);
+    return hmtx->HorizontalMetrics[_glyphIndex].LeftSideBearing;
+}
+
+//(PUBLIC)
+//the return value is in Funit-s
+//_glyphIndex is a valid glyph index ->
+int GetGlyphRightSideBearing(const Font* _font, int _glyphIndex)
+{
+    HMTX_Table* hmtx = (HMTX_Table*) GetTable(_font, HMTX_TABLE);
+    int advanceWidth = hmtx->HorizontalMetrics[_glyphIndex].AdvanceWidth;
+    void* glyph = GetGlyphByIndex(_font, _glyphIndex);
+
+    if (Is(glyph, EMPTY_GLYPH))
+    {
+        return 0;
+    }
+    else if (Is(glyph, SIMPLE_GLYPH))
+    {
+        SimpleGlyph* glyph_ = (SimpleGlyph*) glyph;
+
+        if (glyph_->MinX < 0)
+        {
+            return advanceWidth - (glyph_->MaxX - (0 - glyph_->MinX));
+        }
+        else
+        {
+            return advanceWidth - glyph_->MaxX;
+        }
+    }
+    else
+    {
+        CompositeGlyph* glyph_ = (CompositeGlyph*) glyph;
+
+        if (glyph_->MinX < 0)
+        {
+            return advanceWidth - (glyph_->MaxX - (0 - glyph_->MinX));
+        }
+        else
+        {
+            return advanceWidth - glyph_->MaxX;
+        }
+    }
+}
+
+//(PUBLIC)
+//the return value is in Funit-s
+//_glyphIndex is a valid glyph index ->
+int GetGlyphAdvanceWidth(const Font* _font, int _glyphIndex)
+{
+    HMTX_Table* hmtx = (HMTX_Table*) GetTable(_font, HMTX_TABLE);
+    return hmtx->HorizontalMetrics[_glyphIndex].AdvanceWidth;
+}
+
+//(PUBLIC)
+//returns the distance (in Funit-s) from the (baseline) to (the highest graphemic point of the glyphs)
+//returns negative value if the highest graphemic point of the glyphs is below the baseline
+//the glyph indexes are valid ->
+double GetGlyphRunAscent(const Font* _font, const unsigned short* _glyphIndexes, int _numberOfGlyphs)
+{
+    int maxY = -1;
+
+    for (int i = 0; i < _numberOfGlyphs; i++)
+    {
+        void* glyph = GetGlyphByIndex(_font, _glyphIndexes[i]);
+
+        if (Is(glyph, EMPTY_GLYPH))
+        {
+            continue;
+        }
+
+        int glyphMaxY = Is(glyph, SIMPLE_GLYPH) ? ((SimpleGlyph*) glyph)->MaxY : ((CompositeGlyph*) glyph)->MaxY;
+
+        if (maxY == -1 || glyphMaxY > maxY)
+        {
+            maxY = glyphMaxY;
+        }
+    }
+
+    return maxY;
+}
 
-    int glyphIndex;
+//(PUBLIC)
+//returns the distance (in Funit-s) from the (baseline) to (the lowest graphemic point of the glyphs)
+//returns positive value if the lowest graphemic point of the glyphs is above the baseline
+//the glyph indexes are valid ->
+double GetGlyphRunDescent(const Font* _font, const unsigned short* _glyphIndexes, int _numberOfGlyphs)
+{
+    int minY = -1;
 
-    if (_characterIndex >= 0)
-    {
-        glyphIndex = GetGlyphIndex(_font, _characterIndex);
-    }
-    else
+    for (int i = 0; i < _numberOfGlyphs; i++)
     {
-        glyphIndex = -_characterIndex;
-    }
+        void* glyph = GetGlyphByIndex(_font, _glyphIndexes[i]);
 
-    if (glyphIndex != -1)
-    {
-        return glyf->Glyphs[glyphIndex];
-    }
-    else
-    {
-        return NULL;
+        if (Is(glyph, EMPTY_GLYPH))
+        {
+            continue;
+        }
+
+        int glyphMinY = Is(glyph, SIMPLE_GLYPH) ? ((SimpleGlyph*) glyph)->MinY : ((CompositeGlyph*) glyph)->MinY;
+
+        if (minY == -1 || glyphMinY < minY)
+        {
+            minY = glyphMinY;
+        }
     }
+
+    return minY;
 }
 
 //(PUBLIC)
@@ -1530,15 +3162,13 @@ void* GetGlyph(const Font* _font, int _characterIndex)
 //the specified character (codepoint) exists in the file  ->
 int GetLeftSideBearing(const Font* _font, int _characterCode)
 {
-    HMTX_Table* hmtx = (HMTX_Table*) GetTable(_font, HMTX_TABLE);
-
     if (_characterCode < 0)
     {
-        return hmtx->HorizontalMetrics[0 - _characterCode].LeftSideBearing;
+        return GetGlyphLeftSideBearing(_font, 0 - _characterCode);
     }
     else
     {
-        return hmtx->HorizontalMetrics[GetGlyphIndex(_font, _characterCode)].LeftSideBearing;
+        return GetGlyphLeftSideBearing(_font, GetGlyphIndex(_font, _characterCode));
     }
 }
 
@@ -1547,42 +3177,7 @@ int GetLeftSideBearing(const Font* _font, int _characterCode)
 //the specified character (codepoint) exists in the glyph ->
 int GetRightSideBearing(const Font* _font, int _codepoint)
 {
-    HMTX_Table* hmtx = (HMTX_Table*) GetTable(_font, HMTX_TABLE);
-    GLYF_Table* glyf = (GLYF_Table*) GetTable(_font, GLYF_TABLE);
-    int glyphIndex = GetGlyphIndex(_font, _codepoint);
-    int advanceWidth = hmtx->HorizontalMetrics[glyphIndex].AdvanceWidth;
-    void* glyph = glyf->Glyphs[glyphIndex];
-
-    if (Is(glyph, EMPTY_GLYPH))
-    {
-        return 0;
-    }
-    else if (Is(glyph, SIMPLE_GLYPH))
-    {
-        SimpleGlyph* glyph_ = (SimpleGlyph*) glyph;
-
-        if (glyph_->MinX < 0)
-        {
-            return advanceWidth - (glyph_->MaxX - (0 - glyph_->MinX));
-        }
-        else
-        {
-            return advanceWidth - glyph_->MaxX;
-        }
-    }
-    else
-    {
-        CompositeGlyph* glyph_ = (CompositeGlyph*) glyph;
-
-        if (glyph_->MinX < 0)
-        {
-            return advanceWidth - (glyph_->MaxX - (0 - glyph_->MinX));
-        }
-        else
-        {
-            return advanceWidth - glyph_->MaxX;
-        }
-    }
+    return GetGlyphRightSideBearing(_font, GetGlyphIndex(_font, _codepoint));
 }
 
 //(PUBLIC)
@@ -1731,54 +3326,399 @@ double GetDescent(const Font* _font, const wchar_t* _string, int _stringLength)
 //the specified character (codepoint) exists in the file ->
 int GetAdvanceWidth(const Font* _font, int _characterCode)
 {
-    HMTX_Table* hmtx = (HMTX_Table*) GetTable(_font, HMTX_TABLE);
-
     if (_characterCode < 0)
     {
-        return hmtx->HorizontalMetrics[0 - _characterCode].AdvanceWidth;
+        return GetGlyphAdvanceWidth(_font, 0 - _characterCode);
     }
     else
     {
-        return hmtx->HorizontalMetrics[GetGlyphIndex(_font, _characterCode)].AdvanceWidth;
+        return GetGlyphAdvanceWidth(_font, GetGlyphIndex(_font, _characterCode));
     }
 }
 
 //(PUBLIC)
 //the return value is in Funit-s
 //the specified kerning-pair does not exist in the file => INT_MIN
-//the specified character (codepoint) does not exist in the file ->
-int GetKerning(const Font* _font, int _codepoint1, int _codepoint2)
+int GetGlyphKerning(const Font* _font, int _glyphIndex1, int _glyphIndex2)
 {
     KERN_Table* kern = (KERN_Table*) GetTable(_font, KERN_TABLE);
 
-    if (kern == NULL)
+    if (kern == NULL || kern->NumberOfIndexedPairs == 0 || _glyphIndex1 < 0 || _glyphIndex1 > 65535 || _glyphIndex2 < 0 || _glyphIndex2 > 65535)
     {
         return INT_MIN;
     }
 
-    KERN_Subtable_Format0* subtable = (KERN_Subtable_Format0*) kern->Subtables[0];
+    int row = kern->FrequentGlyphs[_glyphIndex1];
+    int column = kern->FrequentGlyphs[_glyphIndex2];
+
+    //if both glyphs are in the matrix
+    if (row != 0xFF && column != 0xFF)
+    {
+        int position = row * 128 + column;
+        return (kern->FrequentPairPresence[position >> 3] & (1 << (position & 7))) != 0 ? kern->FrequentPairValues[position] : INT_MIN;
+    }
 
-    int glyphIndex1 = GetGlyphIndex(_font, _codepoint1);
-    int glyphIndex2 = GetGlyphIndex(_font, _codepoint2);
+    //binary search
+    unsigned int key = ((unsigned int) _glyphIndex1 << 16) | _glyphIndex2;
+    int begin = 0;
+    int end = kern->NumberOfIndexedPairs - 1;
 
-    //(POTENTIAL-OPTIMIZATION)
-    for (int i = 0; i < subtable->NumberOfPairs; i++)
+    while (begin <= end)
     {
-        if (subtable->Pairs[i].Left == glyphIndex1 && subtable->Pairs[i].Right == glyphIndex2)
+        int middle = (begin + end) / 2;
+
+        if (kern->PairKeys[middle] == key)
+        {
+            return kern->PairValues[middle];
+        }
+        else if (kern->PairKeys[middle] < key)
         {
-            return subtable->Pairs[i].Value;
+            begin = middle + 1;
+        }
+        else
+        {
+            end = middle - 1;
         }
     }
 
     return INT_MIN;
 }
 
+//(PUBLIC)
+//the return value is in Funit-s
+//the specified kerning-pair does not exist in the file => INT_MIN
+//the specified character (codepoint) does not exist in the file ->
+int GetKerning(const Font* _font, int _codepoint1, int _codepoint2)
+{
+    return GetGlyphKerning(_font, GetGlyphIndex(_font, _codepoint1), GetGlyphIndex(_font, _codepoint2));
+}
+
 //(PUBLIC)
 bool ContainsGlyph(const Font* _font, int _codepoint)
 {
     return GetGlyphIndex(_font, _codepoint) != -1;
 }
 
+//(PUBLIC)
+//discards the decoded data of the specified glyph; the glyph will be extracted again on its next access
+//(NOTE) the memory of the glyph is reclaimed by the next TrimGlyphs (the glyphs are stored in an arena)
+//(!) pointers to the glyph (returned by GetGlyph/GetGlyphByIndex) become invalid after the next TrimGlyphs
+/* (!) it ends the shared mode of LoadAllGlyphs (the accesses of the glyphs are tracked again, so the font can no longer be used by multiple
+       threads); no other thread can use the font during the call, and LoadAllGlyphs has to be called again before the font is shared */
+void ReleaseGlyph(const Font* _font, int _glyphIndex)
+{
+    GLYF_Table* glyf = (GLYF_Table*) GetTable(_font, GLYF_TABLE);
+
+    if (glyf == NULL || _glyphIndex < 0 || _glyphIndex >= glyf->NumberOfGlyphs || glyf->Glyphs[_glyphIndex] == NULL)
+    {
+        return;
+    }
+
+    glyf->Glyphs[_glyphIndex] = NULL;
+    glyf->IsShared = false;
+}
+
+//(PUBLIC)
+//releases the glyphs that were not accessed during the last _maxIdleAccesses glyph accesses (see GetGlyphByIndex)
+//TrimGlyphs(font, 0) releases all the decoded glyphs
+//returns the number of released glyphs
+//(NOTE) the remaining glyphs are moved to a new (compacted) arena, and the memory of the released glyphs is freed
+//(!) pointers to all the glyphs become invalid
+//(!) it ends the shared mode of LoadAllGlyphs, as ReleaseGlyph does
+int TrimGlyphs(const Font* _font, unsigned int _maxIdleAccesses)
+{
+    GLYF_Table* glyf = (GLYF_Table*) GetTable(_font, GLYF_TABLE);
+
+    if (glyf == NULL)
+    {
+        return 0;
+    }
+
+    int releasedGlyphs = 0;
+
+    GlyphArena arena;
+    InitializeArena(&arena);
+
+    for (int i = 0; i < glyf->NumberOfGlyphs; i++)
+    {
+        if (glyf->Glyphs[i] == NULL)
+        {
+            continue;
+        }
+
+        //(NOTE) the subtraction is unsigned, so it's correct even if AccessClock has wrapped around
+        if (glyf->AccessClock - glyf->LastAccess[i] >= _maxIdleAccesses)
+        {
+            glyf->Glyphs[i] = NULL;
+            releasedGlyphs++;
+        }
+        else
+        {
+            glyf->Glyphs[i] = CopyGlyph(&arena, glyf->Glyphs[i]);
+        }
+    }
+
+    ReleaseArena(&glyf->Arena);
+    glyf->Arena = arena;
+    glyf->IsShared = false;
+
+    return releasedGlyphs;
+}
+
+//(PUBLIC)
+/* extracts all the glyphs that are not extracted yet; after this the font can be used by multiple threads (until ReleaseGlyph/TrimGlyphs is called) -
+   the accesses of the glyphs are no longer tracked, so TrimGlyphs treats the glyphs as accessed at the time of this call */
+void LoadAllGlyphs(const Font* _font)
+{
+    GLYF_Table* glyf = (GLYF_Table*) GetTable(_font, GLYF_TABLE);
+
+    if (glyf == NULL)
+    {
+        return;
+    }
+
+    for (int i = 0; i < glyf->NumberOfGlyphs; i++)
+    {
+        if (glyf->Glyphs[i] == NULL)
+        {
+            glyf->Glyphs[i] = ExtractGlyph(glyf, i);
+        }
+    }
+
+    glyf->IsShared = true;
+}
+
+//(LOCAL-TO BakeFont)
+struct BakeBuffer
+{
+    unsigned char* Data;
+    size_t Size;
+    size_t Capacity;
+};
+
+typedef struct BakeBuffer BakeBuffer;
+
+//(LOCAL-TO BakeFont)
+//appends _size bytes (_data == NULL :: zeros) at the next multiple of 8; returns the offset of the bytes
+unsigned long long bakeAppend(BakeBuffer* _buffer, const void* _data, size_t _size)
+{
+    size_t offset = (_buffer->Size + 7) & ~((size_t) 7);
+
+    if (offset + _size > _buffer->Capacity)
+    {
+        while (offset + _size > _buffer->Capacity)
+        {
+            _buffer->Capacity *= 2;
+        }
+
+        _buffer->Data = realloc(_buffer->Data, _buffer->Capacity);
+    }
+
+    for (size_t i = _buffer->Size; i < offset; i++)
+        _buffer->Data[i] = 0;
+    for (size_t i = 0; i < _size; i++)
+        _buffer->Data[offset + i] = _data != NULL ? ((const unsigned char*) _data)[i] : 0;
+
+    _buffer->Size = offset + _size;
+    return offset;
+}
+
+//(LOCAL-TO BakeFont)
+//appends the glyph record and its arrays; the pointers in the record are replaced with the offsets of the arrays (NULL :: 0)
+unsigned long long bakeGlyph(BakeBuffer* _buffer, const void* _glyph)
+{
+    if (Is(_glyph, SIMPLE_GLYPH))
+    {
+        const SimpleGlyph* glyph = (const SimpleGlyph*) _glyph;
+        SimpleGlyph record = *glyph;
+
+        record.EndPointsOfContours = (unsigned short*) (size_t) (glyph->EndPointsOfContours == NULL ? 0 :
+                                     bakeAppend(_buffer, glyph->EndPointsOfContours, sizeof(unsigned short) * glyph->NumberOfContours));
+        record.X_Coordinates = (short*) (size_t) (glyph->X_Coordinates == NULL ? 0 :
+                               bakeAppend(_buffer, glyph->X_Coordinates, sizeof(short) * glyph->NumberOfPoints));
+        record.Y_Coordinates = (short*) (size_t) (glyph->Y_Coordinates == NULL ? 0 :
+                               bakeAppend(_buffer, glyph->Y_Coordinates, sizeof(short) * glyph->NumberOfPoints));
+        record.Flags = (unsigned char*) (size_t) (glyph->Flags == NULL ? 0 : bakeAppend(_buffer, glyph->Flags, glyph->NumberOfPoints));
+        record.Topology = (ContourTopology*) (size_t) (glyph->Topology == NULL ? 0 :
+                          bakeAppend(_buffer, glyph->Topology, sizeof(ContourTopology) * glyph->NumberOfContours));
+
+        if (glyph->Prepared != NULL)
+        {
+            const PreparedGlyph* prepared = glyph->Prepared;
+            PreparedGlyph preparedRecord = *prepared;
+
+            preparedRecord.Contours = (PreparedContour*) (size_t) bakeAppend(_buffer, prepared->Contours,
+                                                                             sizeof(PreparedContour) * prepared->NumberOfContours);
+            preparedRecord.X_Coordinates = (float*) (size_t) bakeAppend(_buffer, prepared->X_Coordinates, sizeof(float) * prepared->NumberOfPoints);
+            preparedRecord.Y_Coordinates = (float*) (size_t) bakeAppend(_buffer, prepared->Y_Coordinates, sizeof(float) * prepared->NumberOfPoints);
+            preparedRecord.Flags = (unsigned char*) (size_t) bakeAppend(_buffer, prepared->Flags, prepared->NumberOfPoints);
+
+            record.Prepared = (PreparedGlyph*) (size_t) bakeAppend(_buffer, &preparedRecord, sizeof(PreparedGlyph));
+        }
+
+        return bakeAppend(_buffer, &record, sizeof(SimpleGlyph));
+    }
+    else if (Is(_glyph, COMPOSITE_GLYPH))
+    {
+        const CompositeGlyph* glyph = (const CompositeGlyph*) _glyph;
+        CompositeGlyph record = *glyph;
+
+        record.Components = (GlyphComponent*) (size_t) (glyph->Components == NULL ? 0 :
+                            bakeAppend(_buffer, glyph->Components, sizeof(GlyphComponent) * glyph->NumberOfComponents));
+
+        return bakeAppend(_buffer, &record, sizeof(CompositeGlyph));
+    }
+    //(STATE) the glyph is empty
+    else
+    {
+        return bakeAppend(_buffer, _glyph, sizeof(EmptyGlyph));
+    }
+}
+
+//(PUBLIC)
+/* writes the font in a file that can be loaded with LoadBakedFont - the font file together with the data computed while parsing (the compiled cmap,
+   the kerning index and the decoded horizontal metrics) and all the glyphs (the glyphs that are not extracted yet are extracted) */
+//(NOTE) the baked file is a cache - LoadBakedFont refuses files created by another version of the library, so they have to be baked again
+//the file cannot be written (or the machine is not little-endian) => false
+bool BakeFont(const Font* _font, const char* _filePath)
+{
+    unsigned int byteOrder = 0x01020304;
+
+    if (*((unsigned char*) &byteOrder) != 0x04)
+    {
+        return false;
+    }
+
+    BakeBuffer buffer;
+    buffer.Capacity = _font->DataSize + 1048576;
+    buffer.Data = malloc(buffer.Capacity);
+    buffer.Size = 0;
+
+    BakedFontHeader header;
+    header.Signature[0] = 'T';
+    header.Signature[1] = 'T';
+    header.Signature[2] = 'B';
+    header.Signature[3] = 'K';
+    header.Version = BAKED_FONT_VERSION;
+    header.ByteOrder = byteOrder;
+    header.PointerSize = sizeof(void*);
+
+    //the header is written after the sections
+    bakeAppend(&buffer, NULL, sizeof(BakedFontHeader));
+
+    header.FontDataOffset = bakeAppend(&buffer, _font->Data, _font->DataSize);
+    header.FontDataSize = _font->DataSize;
+
+    ///cmap
+
+    const CMAP_Table* cmap = (const CMAP_Table*) GetTable(_font, CMAP_TABLE);
+
+    header.BasicPlaneOffset = 0;
+    header.CodepointPagesOffset = 0;
+
+    if (cmap != NULL)
+    {
+        unsigned long long* pageOffsets = malloc(sizeof(unsigned long long) * 4352);
+
+        //the pages of the Basic Multilingual Plane are views into BasicPlane
+        for (int i = 0; i < 256; i++)
+            pageOffsets[i] = 0;
+        for (int i = 256; i < 4352; i++)
+            pageOffsets[i] = cmap->CodepointPages[i] == cmap->EmptyPage ? 0 : bakeAppend(&buffer, cmap->CodepointPages[i], sizeof(unsigned short) * 256);
+
+        header.BasicPlaneOffset = bakeAppend(&buffer, cmap->BasicPlane, sizeof(unsigned short) * 65536);
+        header.CodepointPagesOffset = bakeAppend(&buffer, pageOffsets, sizeof(unsigned long long) * 4352);
+
+        free(pageOffsets);
+    }
+
+    ///kern
+
+    const KERN_Table* kern = (const KERN_Table*) GetTable(_font, KERN_TABLE);
+
+    header.NumberOfIndexedPairs = 0;
+    header.PairKeysOffset = 0;
+    header.PairValuesOffset = 0;
+    header.FrequentGlyphsOffset = 0;
+    header.FrequentPairValuesOffset = 0;
+    header.FrequentPairPresenceOffset = 0;
+
+    if (kern != NULL && kern->NumberOfIndexedPairs > 0)
+    {
+        header.NumberOfIndexedPairs = kern->NumberOfIndexedPairs;
+        header.PairKeysOffset = bakeAppend(&buffer, kern->PairKeys, sizeof(unsigned int) * kern->NumberOfIndexedPairs);
+        header.PairValuesOffset = bakeAppend(&buffer, kern->PairValues, sizeof(short) * kern->NumberOfIndexedPairs);
+        header.FrequentGlyphsOffset = bakeAppend(&buffer, kern->FrequentGlyphs, 65536);
+        header.FrequentPairValuesOffset = bakeAppend(&buffer, kern->FrequentPairValues, sizeof(short) * 128 * 128);
+        header.FrequentPairPresenceOffset = bakeAppend(&buffer, kern->FrequentPairPresence, 128 * 128 / 8);
+    }
+
+    ///hmtx
+
+    const HMTX_Table* hmtx = (const HMTX_Table*) GetTable(_font, HMTX_TABLE);
+
+    header.NumberOfHorizontalMetrics = 0;
+    header.HorizontalMetricsOffset = 0;
+    header.NumberOfLeftSideBearings = 0;
+    header.LeftSideBearingsOffset = 0;
+
+    if (hmtx != NULL)
+    {
+        unsigned short numberOfHorizontalMetrics = ((HHEA_Table*) GetTable(_font, HHEA_TABLE))->NumberOfHorizontalMetrics;
+        unsigned short numberOfGlyphs = ((MAXP_Table*) GetTable(_font, MAXP_TABLE))->NumberOfGlyphs;
+
+        header.NumberOfHorizontalMetrics = numberOfGlyphs;
+        header.HorizontalMetricsOffset = bakeAppend(&buffer, hmtx->HorizontalMetrics, sizeof(LongHorizontalMetric) * numberOfGlyphs);
+        header.NumberOfLeftSideBearings = numberOfGlyphs - numberOfHorizontalMetrics;
+        header.LeftSideBearingsOffset = bakeAppend(&buffer, hmtx->LeftSideBearings, sizeof(short) * (numberOfGlyphs - numberOfHorizontalMetrics));
+    }
+
+    ///glyf
+
+    const GLYF_Table* glyf = (const GLYF_Table*) GetTable(_font, GLYF_TABLE);
+
+    header.NumberOfGlyphs = 0;
+    header.GlyphsOffset = 0;
+
+    if (glyf != NULL)
+    {
+        unsigned long long* recordOffsets = malloc(sizeof(unsigned long long) * glyf->NumberOfGlyphs);
+
+        for (int i = 0; i < glyf->NumberOfGlyphs; i++)
+        {
+            recordOffsets[i] = bakeGlyph(&buffer, GetGlyphByIndex(_font, i));
+        }
+
+        header.NumberOfGlyphs = glyf->NumberOfGlyphs;
+        header.GlyphsOffset = bakeAppend(&buffer, recordOffsets, sizeof(unsigned long long) * glyf->NumberOfGlyphs);
+
+        free(recordOffsets);
+    }
+
+    *((BakedFontHeader*) buffer.Data) = header;
+
+    FILE* file = fopen(_filePath, "wb");
+    bool isWritten = file != NULL && fwrite(buffer.Data, 1, buffer.Size, file) == buffer.Size;
+
+    if (file != NULL && fclose(file) != 0)
+    {
+        isWritten = false;
+    }
+
+    free(buffer.Data);
+    return isWritten;
+}
+
+//(PRIVATE)
+//the arrays in the baked file (see LoadBakedFont) are released with the file
+void FreeUnlessBaked(const Font* _font, void* _array)
+{
+    if (_font->Baked == NULL || (unsigned char*) _array < _font->Baked || (unsigned char*) _array >= _font->Baked + _font->BakedSize)
+    {
+        free(_array);
+    }
+}
+
 //(PUBLIC)
 void ReleaseFont(Font* _font)
 {
@@ -1790,41 +3730,25 @@ void ReleaseFont(Font* _font)
            {
                CMAP_Table* table = (CMAP_Table*) _font->Tables[i];
 
+               //the arrays of the sub-tables are borrowed from the font data
                for (int i = 0; i < table->NumberOfSubtables; i++)
                {
-                   if (Is(table->Subtables[i], CMAP_SUBTABLE_FORMAT0))
-                   {
-                       free(table->Subtables[i]);
-                   }
-                   else if (Is(table->Subtables[i], CMAP_SUBTABLE_FORMAT4))
-                   {
-                       CMAP_Subtable_Format4* subtable = (CMAP_Subtable_Format4*) table->Subtables[i];
-                       free(subtable->EndCode);
-                       free(subtable->StartCode);
-                       free(subtable->IndexDelta);
-                       free(subtable->IndexRangeOffsets);
-                       free(subtable->GlyphIndexArray);
-                       free(table->Subtables[i]);
-                   }
-                   else if (Is(table->Subtables[i], CMAP_SUBTABLE_FORMAT6))
-                   {
-                       free(((CMAP_Subtable_Format6*) table->Subtables[i])->GlyphIndexArray);
-                       free(table->Subtables[i]);
-                   }
-                   else if (Is(table->Subtables[i], CMAP_SUBTABLE_FORMAT12))
-                   {
-                       CMAP_Subtable_Format12* subtable = (CMAP_Subtable_Format12*) table->Subtables[i];
-
-                       for (int i = 0; i < subtable->NumberOfGroups; i++)
-                       {
-                           free(subtable->Groups[i]);
-                       }
+                   free(table->Subtables[i]);
+               }
 
-                       free(subtable->Groups);
-                       free(table->Subtables[i]);
+               //(NOTE) the map is not compiled if the parsing of the font failed (see DiscardFont)
+               for (int i = 256; table->CodepointPages != NULL && i < 4352; i++)
+               {
+                   if (table->CodepointPages[i] != table->EmptyPage)
+                   {
+                       FreeUnlessBaked(_font, table->CodepointPages[i]);
                    }
                }
 
+               free(table->CodepointPages);
+               free(table->EmptyPage);
+               FreeUnlessBaked(_font, table->BasicPlane);
+
                free(table->Subtables);
                free(_font->Tables[i]);
            }
@@ -1832,36 +3756,11 @@ void ReleaseFont(Font* _font)
            {
                GLYF_Table* table = (GLYF_Table*) _font->Tables[i];
 
-               for (int i = 0; i < table->NumberOfGlyphs; i++)
-               {
-                   if (Is(table->Glyphs[i], EMPTY_GLYPH))
-                   {
-                      free(table->Glyphs[i]);
-                   }
-                   else if (Is(table->Glyphs[i], SIMPLE_GLYPH))
-                   {
-                       SimpleGlyph* glyph = (SimpleGlyph*) table->Glyphs[i];
-                       free(glyph->EndPointsOfContours);
-                       free(glyph->X_Coordinates);
-                       free(glyph->Y_Coordinates);
-                       free(glyph->Flags);
-                       free(table->Glyphs[i]);
-                   }
-                   else if (Is(table->Glyphs[i], COMPOSITE_GLYPH))
-                   {
-                       CompositeGlyph* glyph = (CompositeGlyph*) table->Glyphs[i];
-
-                       for (int i = 0; i < glyph->NumberOfComponents; i++)
-                       {
-                           free(glyph->Components[i]);
-                       }
-
-                       free(glyph->Components);
-                       free(table->Glyphs[i]);
-                   }
-               }
+               //the extracted glyphs are stored in the arena
+               ReleaseArena(&table->Arena);
 
                free(table->Glyphs);
+               free(table->LastAccess);
                free(_font->Tables[i]);
            }
            else if (Is(_font->Tables[i], HEAD_TABLE))
@@ -1871,32 +3770,29 @@ void ReleaseFont(Font* _font)
            else if (Is(_font->Tables[i], HMTX_TABLE))
            {
                HMTX_Table* table = (HMTX_Table*) _font->Tables[i];
-               free(table->HorizontalMetrics);
-               free(table->LeftSideBearings);
+               FreeUnlessBaked(_font, table->HorizontalMetrics);
+               FreeUnlessBaked(_font, table->LeftSideBearings);
                free(_font->Tables[i]);
            }
            else if (Is(_font->Tables[i], KERN_TABLE))
            {
                KERN_Table* table = (KERN_Table*) _font->Tables[i];
 
+               //the kerning-pairs are borrowed from the font data
                for (int i = 0; i < table->NumberOfSubtables; i++)
                {
-                   if (Is(table->Subtables[i], KERN_SUBTABLE_FORMAT0))
-                   {
-                       free(((KERN_Subtable_Format0*) table->Subtables[i])->Pairs);
-                       free(table->Subtables[i]);
-
-                   }
+                   free(table->Subtables[i]);
                }
 
+               FreeUnlessBaked(_font, table->PairKeys);
+               FreeUnlessBaked(_font, table->PairValues);
+               FreeUnlessBaked(_font, table->FrequentGlyphs);
+               FreeUnlessBaked(_font, table->FrequentPairValues);
+               FreeUnlessBaked(_font, table->FrequentPairPresence);
+
                free(table->Subtables);
                free(_font->Tables[i]);
            }
-           else if (Is(_font->Tables[i], LOCA_TABLE))
-           {
-               free(((LOCA_Table*) _font->Tables[i])->Offsets);
-               free(_font->Tables[i]);
-           }
            else
            {
                free(_font->Tables[i]);
@@ -1905,5 +3801,19 @@ void ReleaseFont(Font* _font)
    }
 
     free(_font->Tables);
+
+    if (_font->DataOwnership == 1)
+    {
+        free((void*) _font->Data);
+    }
+    else if (_font->DataOwnership == 2)
+    {
+        UnmapFile((void*) _font->Data, _font->DataSize);
+    }
+    else if (_font->DataOwnership == 3)
+    {
+        UnmapFile(_font->Baked, _font->BakedSize);
+    }
+
     free(_font);
 }
@@ -1,51 +1,557 @@
+//the compositing of the glyphs (see CompositeSpan) uses SSE2 or AVX2 if the target supports them
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define TT_SSE2
+    #include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+    #define TT_AVX2
+    #include <immintrin.h>
+#endif
+
 //(PRIVATE)
 
 const int PIXEL_SIZE = 4;
-const double PI = 3.14159265358979323846;
 const double VERTEXOID_SHIFT = 0.01;
-const unsigned int N_CROSSING = 0;
-const unsigned int O_CROSSING = 1;
-const unsigned int T_CROSSING = 2;
-const unsigned int O_BEGIN = 8;
-const unsigned int O_END = 14;
-const unsigned int T_BEGIN = 15;
-const unsigned int T_END = 21;
-const unsigned int O_LEFT = 22;
-const unsigned int T_LEFT = 23;
-const unsigned int O_RIGHT = 24;
-const unsigned int T_RIGHT = 25;
-const unsigned int INITIAL_PIXEL_MARKER = 0b10000000000000000000000000000000;
-const unsigned int EXTEROID = 0;
-const unsigned int CONTUROID = 1;
-const unsigned int INTEROID = 2;
-
-unsigned int* MetaCanvas_S1 = NULL;
-unsigned short* MetaCanvas_S2 = NULL;
-int MetaCanvasWidth;
-int MetaCanvasHeight;
-int PreviousPixelX;
-int PreviousPixelY;
-int StringWidth = 0; //in pixels; used for horizontal (string gradients)
-int StringHeight = 0; //in pixels; used for vertical (string gradients)
-int StringBeginX =  0; //in pixels; used for horizontal (string gradients)
-int StringBeginY = 0; //in pixels; used for vertical (string gradients)
+const int FULL_COVERAGE = 255; //the coverage of a fully covered pixel; the coverage is 8-bit alpha
+const unsigned char EXTEROID = 0; //the value of an exteroid in a coverage mask (a conturoid has its coverage - 1..254)
+const unsigned char INTEROID = 255; //the value of an interoid in a coverage mask (FULL_COVERAGE)
+const double FLATNESS = 0.1; //(in pixels) the largest distance between a quadratic Bezier curve and the lines that replace it
+const int FIXED_FLATNESS = 26; //(RE_FIXED) FLATNESS in 24.8 fixed point
+const size_t EDGE_CACHE_SIZE = 2097152; //(in bytes) the initial budget of the edge cache of a context (see SetEdgeCacheSize)
+const size_t GLYPH_CACHE_SIZE = 4194304; //(in bytes) the initial budget of the glyph cache of a context (see SetGlyphCache)
+const int BAND_SIZE = 262144; //(in pixels) the initial band size of a context (see SetBandSize)
+const int MIN_SPAN_RUN = 32; //(in pixels) the shortest run of interoids or exteroids that ends a span of conturoids (see AddCoverageSpans)
+const int SPAN_GROUP = 16; //(in pixels) the length of a span of conturoids is rounded up to a multiple of it - the pixels blended at once with AVX2
+
 
 /* two-stage drawing is needed (first in a meta-canvas byte array, then in the real canvas); this allows drawing over non-uniform background (
    consisting of many different colors) and also allows proper drawing of certain characters - for example Unicode codepoint Dx295 in
    Mistral (typeface) */
 
-/* format of the elements in MetaCanvas_S1:
-   - bits [0..6]: coverage
-   - bits [8..14]: position of the right-most opening crossing
-   - bits [15..21]: position of the right-most terminating crossing
-   - bit [22]: opening crossing on the left side
-   - bit [23]: terminating crossing on the left side
-   - bit [24]: opening crossing on the right side
-   - bit [25]: terminating crossing on the right side */
+/* (RE_SAMPLEX) the elements of MetaCanvas_S1 are the coverage of the part of the pixel on the right side of the contour (0..FULL_COVERAGE);
+   0 :: the pixel is not crossed by a contour (yet) */
+
+/* MetaCanvas_S2 is a coverage mask - the only result of stage 1, which doesn't depend on the colors (see CompositeCoverage); format of its
+   elements is 8-bit alpha: 0 :: exteroid (see EXTEROID) | 1..254 :: conturoid (its coverage) | 255 :: interoid (see INTEROID); every row
+   is also described by its spans (see CoverageSpan), so stage 2 skips the long runs of exteroids and fills the long runs of interoids */
+
+//(PUBLIC)
+enum RasterizationEngine
+{
+    //the contours are traced with samplexes and filled by the crossings marked in the meta-canvas (default)
+    RE_SAMPLEX,
+
+    /* the contours are flattened into lines, every line adds the exact (signed) area and cover of the pixels that it crosses, and the
+       coverage is determined by accumulating the rows */
+    RE_ANALYTIC,
+
+    /* the same as RE_ANALYTIC, but the position, the size and the contours of the glyph are in 24.8 fixed point (the scale is 16.16),
+       and the area and the cover are integers; the drawn glyphs don't depend on the floating-point arithmetic of the compiler/CPU */
+    RE_FIXED
+};
+
+typedef enum RasterizationEngine RasterizationEngine;
+
+//(PRIVATE)
+//identifies a glyph drawn with a specific size and transformation, by a specific engine
+struct GlyphKey
+{
+    const Font* Font;
+    unsigned int FontSerial; //(NOTE) a font released and another one parsed at the same address have different serials
+    int GlyphIndex;
+    double Scale;
+    double Composite_X_Offset;
+    double Composite_Y_Offset;
+    double Composite_X_Scale;
+    double Composite_Y_Scale;
+    RasterizationEngine Engine;
+    //(glyph cache) the fractional part of the position of the glyph (rounded to a subpixel phase - see SetGlyphCache); 0.0 in the edge cache
+    double PhaseX;
+    double PhaseY;
+};
+
+typedef struct GlyphKey GlyphKey;
+
+//(PRIVATE)
+//the header of a value in a GlyphCache; the value is allocated (with malloc) together with its header, which is its first member
+struct CacheEntry
+{
+    GlyphKey Key;
+    unsigned int Hash;
+    size_t Size; //in bytes, the header included
+    struct CacheEntry* NextInBucket;
+    struct CacheEntry* Newer;
+    struct CacheEntry* Older;
+};
+
+typedef struct CacheEntry CacheEntry;
+
+//(PRIVATE)
+//a hash table of values with a total size limit; when the limit is reached, the least recently used values are removed
+struct GlyphCache
+{
+    CacheEntry** Buckets;
+    int NumberOfBuckets; //a power of 2
+    int NumberOfEntries;
+    CacheEntry* Newest;
+    CacheEntry* Oldest;
+    size_t Usage; //in bytes
+    size_t Budget; //in bytes; 0 :: the cache is disabled
+    unsigned long long Hits;
+    unsigned long long Misses;
+    unsigned long long Evictions; //the entries removed to make space for other entries
+};
+
+typedef struct GlyphCache GlyphCache;
+
+//(PUBLIC)
+//see GetGlyphCacheStatistics and GetEdgeCacheStatistics
+struct tt_CacheStatistics
+{
+    unsigned long long Hits;
+    unsigned long long Misses;
+    unsigned long long Evictions;
+    int NumberOfEntries;
+    size_t Usage; //in bytes
+    size_t Budget; //in bytes
+};
+
+typedef struct tt_CacheStatistics tt_CacheStatistics;
+
+//(PRIVATE)
+//(RE_SAMPLEX) a crossing of a line of a contour with the center of a row of the meta-canvas (see AccumulateWinding)
+struct Crossing
+{
+    int Column; //the first pixel whose center is on the right side of the crossing
+    int Direction; //+1 for an upward line, -1 for a downward line
+    int Next; //the previous crossing of the same row (its index + 1), 0 :: none
+};
+
+typedef struct Crossing Crossing;
+
+//(PRIVATE)
+/* a run of pixels of a row of a coverage mask (see AddCoverageSpans); the long runs of exteroids between the spans are not in any span, so
+   stage 2 never visits them */
+struct CoverageSpan
+{
+    int Begin; //the first column
+    int End; //the column after the last one
+    /* true :: the pixels are interoids | false :: the pixels are conturoids, which can be mixed with short runs of interoids and exteroids
+       (their coverage is in the mask) */
+    bool IsInterior;
+};
+
+typedef struct CoverageSpan CoverageSpan;
+
+//(PUBLIC)
+/* the working state of the rasterizer; every thread that draws needs its own context (see CreateRasterContext), while the functions without
+   a context (DrawCharacter, DrawString, DrawGlyphRun) use a shared default context, so they can be used only from one thread at a time */
+struct tt_RasterContext
+{
+    unsigned char* MetaCanvas_S1;
+    unsigned char* MetaCanvas_S2;
+    int MetaCanvasWidth;
+    int MetaCanvasHeight;
+    int PreviousPixelX;
+    int PreviousPixelY;
+    int StringWidth; //in pixels; used for horizontal (string gradients)
+    int StringHeight; //in pixels; used for vertical (string gradients)
+    int StringBeginX; //in pixels; used for horizontal (string gradients)
+    int StringBeginY; //in pixels; used for vertical (string gradients)
+    //(INTERNAL) the buffers are reused by the glyphs - they only grow, so drawing a glyph doesn't allocate memory (after the first few glyphs)
+    int MetaCanvasCapacity; //the number of elements in MetaCanvas_S1 and MetaCanvas_S2; MetaCanvas_S1 is zero-filled between the glyphs
+    unsigned char* Scratch; //the contours of the currently drawn glyph (see ResetScratch)
+    size_t ScratchSize;
+    size_t ScratchUsage;
+    float* Accumulation; //(RE_ANALYTIC) the area and cover of the pixels; zero-filled between the glyphs (see AnalyticFill)
+    int AccumulationCapacity;
+    /* (RE_FIXED) the cover and the area of the pixels (two values per pixel - see FixedFill) | (RE_SAMPLEX) the last crossing of every
+       row, followed by the winding numbers of three rows (see SamplexFill); zero-filled between the glyphs */
+    int* Cells;
+    int CellsCapacity;
+    Crossing* Crossings; //(RE_SAMPLEX) the crossings of the contours with the rows (see AccumulateWinding); emptied between the glyphs
+    int NumberOfCrossings;
+    int CrossingsCapacity;
+    RasterizationEngine Engine;
+    //(INTERNAL) the edge lists of the recently drawn glyphs (see EdgeList and SetEdgeCacheSize)
+    GlyphCache EdgeCache;
+    unsigned char* EdgeScratch; //the edge list of a glyph that is not cached (see BuildEdgeList)
+    size_t EdgeScratchSize;
+    //(INTERNAL) the coverage of the recently drawn glyphs (see CoverageMask and SetGlyphCache)
+    GlyphCache CoverageCache;
+    int SubpixelPhases; //0 :: the position of a glyph is not rounded
+    unsigned char* ColumnColors; //(INTERNAL) the colors of the columns of a glyph with a horizontal gradient (see CompositeCoverage)
+    int ColumnColorsCapacity;
+    int BandSize; //(in pixels) a glyph with more pixels is drawn in bands of rows (see SetBandSize); 0 :: no limit
+    //(INTERNAL) the spans of MetaCanvas_S2 (see AddCoverageSpans); the spans of the row R are Spans[RowSpans[R]] .. Spans[RowSpans[R + 1] - 1]
+    CoverageSpan* Spans;
+    int NumberOfSpans;
+    int SpansCapacity;
+    int* RowSpans;
+    int RowSpansCapacity;
+};
+
+typedef struct tt_RasterContext tt_RasterContext;
+
+//(PRIVATE)
+tt_RasterContext DefaultRasterContext = { NULL, NULL, 0, 0, 0, 0, 0, 0, 0, 0, 0, NULL, 0, 0, NULL, 0, NULL, 0, NULL, 0, 0, RE_SAMPLEX,
+                                           { NULL, 0, 0, NULL, NULL, 0, 2097152 /* EDGE_CACHE_SIZE */, 0, 0, 0 }, NULL, 0,
+                                           { NULL, 0, 0, NULL, NULL, 0, 4194304 /* GLYPH_CACHE_SIZE */, 0, 0, 0 }, 0, NULL, 0,
+                                           262144 /* BAND_SIZE */, NULL, 0, 0, NULL, 0 };
+
+//(PRIVATE)
+void InitializeCache(GlyphCache* _cache, size_t _budget)
+{
+    _cache->Buckets = NULL;
+    _cache->NumberOfBuckets = 0;
+    _cache->NumberOfEntries = 0;
+    _cache->Newest = NULL;
+    _cache->Oldest = NULL;
+    _cache->Usage = 0;
+    _cache->Budget = _budget;
+    _cache->Hits = 0;
+    _cache->Misses = 0;
+    _cache->Evictions = 0;
+}
+
+//(PRIVATE)
+//(LOCAL-TO HashOf)
+/* the bits of _value, folded to 32 bits; unlike a conversion to an integer, it's defined for every value (negative and out-of-range values
+   included), and equal values have equal bits (0.0 and -0.0 included) */
+unsigned int BitsOf(double _value)
+{
+    union { double Value; unsigned long long Bits; } number;
+    number.Value = _value + 0.0; //-0.0 + 0.0 == 0.0
+
+    return (unsigned int) number.Bits ^ (unsigned int) (number.Bits >> 32);
+}
+
+//(PRIVATE)
+unsigned int HashOf(const GlyphKey* _key)
+{
+    //FNV-1a of the fields that distinguish the glyphs; the keys with the same hash are compared (see KeysAreEqual)
+    unsigned int values[6] = { _key->FontSerial, (unsigned int) _key->GlyphIndex, BitsOf(_key->Scale), _key->Engine, BitsOf(_key->PhaseX),
+                               BitsOf(_key->PhaseY) };
+    unsigned int hash = 2166136261u;
+
+    for (int i = 0; i < 6; i++)
+    {
+        hash = (hash ^ values[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+//(PRIVATE)
+bool KeysAreEqual(const GlyphKey* _key1, const GlyphKey* _key2)
+{
+    return _key1->Font == _key2->Font &&
+           _key1->FontSerial == _key2->FontSerial &&
+           _key1->GlyphIndex == _key2->GlyphIndex &&
+           _key1->Scale == _key2->Scale &&
+           _key1->Composite_X_Offset == _key2->Composite_X_Offset &&
+           _key1->Composite_Y_Offset == _key2->Composite_Y_Offset &&
+           _key1->Composite_X_Scale == _key2->Composite_X_Scale &&
+           _key1->Composite_Y_Scale == _key2->Composite_Y_Scale &&
+           _key1->Engine == _key2->Engine &&
+           _key1->PhaseX == _key2->PhaseX &&
+           _key1->PhaseY == _key2->PhaseY;
+}
+
+//(PRIVATE)
+void UnlinkCacheEntry(GlyphCache* _cache, CacheEntry* _entry)
+{
+    if (_entry->Newer != NULL)
+    {
+        _entry->Newer->Older = _entry->Older;
+    }
+    else
+    {
+        _cache->Newest = _entry->Older;
+    }
+
+    if (_entry->Older != NULL)
+    {
+        _entry->Older->Newer = _entry->Newer;
+    }
+    else
+    {
+        _cache->Oldest = _entry->Newer;
+    }
+}
+
+//(PRIVATE)
+void LinkCacheEntryAsNewest(GlyphCache* _cache, CacheEntry* _entry)
+{
+    _entry->Newer = NULL;
+    _entry->Older = _cache->Newest;
+
+    if (_cache->Newest != NULL)
+    {
+        _cache->Newest->Newer = _entry;
+    }
+    else
+    {
+        _cache->Oldest = _entry;
+    }
+
+    _cache->Newest = _entry;
+}
+
+//(PRIVATE)
+//the found entry becomes the most recently used one; not found => NULL
+CacheEntry* FindInCache(GlyphCache* _cache, const GlyphKey* _key)
+{
+    if (_cache->NumberOfEntries == 0)
+    {
+        _cache->Misses++;
+        return NULL;
+    }
+
+    unsigned int hash = HashOf(_key);
+
+    for (CacheEntry* entry = _cache->Buckets[hash & (_cache->NumberOfBuckets - 1)]; entry != NULL; entry = entry->NextInBucket)
+    {
+        if (entry->Hash == hash && KeysAreEqual(&entry->Key, _key))
+        {
+            UnlinkCacheEntry(_cache, entry);
+            LinkCacheEntryAsNewest(_cache, entry);
+            _cache->Hits++;
+            return entry;
+        }
+    }
+
+    _cache->Misses++;
+    return NULL;
+}
+
+//(PRIVATE)
+//the entry is released
+void RemoveFromCache(GlyphCache* _cache, CacheEntry* _entry)
+{
+    CacheEntry** link = &_cache->Buckets[_entry->Hash & (_cache->NumberOfBuckets - 1)];
+
+    while (*link != _entry)
+    {
+        link = &(*link)->NextInBucket;
+    }
+
+    *link = _entry->NextInBucket;
+    UnlinkCacheEntry(_cache, _entry);
+    _cache->NumberOfEntries--;
+    _cache->Usage -= _entry->Size;
+    free(_entry);
+}
+
+//(PRIVATE)
+//removes the least recently used entries until the entries of the cache fit in its budget
+void TrimCache(GlyphCache* _cache)
+{
+    while (_cache->Usage > _cache->Budget)
+    {
+        RemoveFromCache(_cache, _cache->Oldest);
+        _cache->Evictions++;
+    }
+}
+
+//(PRIVATE)
+/* _entry is allocated with malloc, and its Key and Size are set; it becomes the most recently used entry and the cache takes its ownership;
+   _entry->Size must not be larger than the budget of the cache */
+void InsertInCache(GlyphCache* _cache, CacheEntry* _entry)
+{
+    _cache->Usage += _entry->Size;
+    TrimCache(_cache);
+
+    //(NOTE) the number of the buckets is doubled (and the entries are redistributed) when there are more entries than buckets
+    if (_cache->NumberOfEntries >= _cache->NumberOfBuckets)
+    {
+        free(_cache->Buckets);
+        _cache->NumberOfBuckets = _cache->NumberOfBuckets == 0 ? 64 : _cache->NumberOfBuckets * 2;
+        _cache->Buckets = calloc(_cache->NumberOfBuckets, sizeof(CacheEntry*));
+
+        for (CacheEntry* entry = _cache->Newest; entry != NULL; entry = entry->Older)
+        {
+            CacheEntry** bucket = &_cache->Buckets[entry->Hash & (_cache->NumberOfBuckets - 1)];
+            entry->NextInBucket = *bucket;
+            *bucket = entry;
+        }
+    }
+
+    _entry->Hash = HashOf(&_entry->Key);
+
+    CacheEntry** bucket = &_cache->Buckets[_entry->Hash & (_cache->NumberOfBuckets - 1)];
+    _entry->NextInBucket = *bucket;
+    *bucket = _entry;
+
+    LinkCacheEntryAsNewest(_cache, _entry);
+    _cache->NumberOfEntries++;
+}
+
+//(PRIVATE)
+void ReleaseCache(GlyphCache* _cache)
+{
+    while (_cache->Oldest != NULL)
+    {
+        RemoveFromCache(_cache, _cache->Oldest);
+    }
+
+    free(_cache->Buckets);
+    _cache->Buckets = NULL;
+    _cache->NumberOfBuckets = 0;
+}
+
+//(PUBLIC)
+tt_RasterContext* CreateRasterContext()
+{
+    tt_RasterContext* context = malloc(sizeof(tt_RasterContext));
+    context->MetaCanvas_S1 = NULL;
+    context->MetaCanvas_S2 = NULL;
+    context->MetaCanvasWidth = 0;
+    context->MetaCanvasHeight = 0;
+    context->PreviousPixelX = 0;
+    context->PreviousPixelY = 0;
+    context->StringWidth = 0;
+    context->StringHeight = 0;
+    context->StringBeginX = 0;
+    context->StringBeginY = 0;
+    context->MetaCanvasCapacity = 0;
+    context->Scratch = NULL;
+    context->ScratchSize = 0;
+    context->ScratchUsage = 0;
+    context->Accumulation = NULL;
+    context->AccumulationCapacity = 0;
+    context->Cells = NULL;
+    context->CellsCapacity = 0;
+    context->Crossings = NULL;
+    context->NumberOfCrossings = 0;
+    context->CrossingsCapacity = 0;
+    context->Engine = RE_SAMPLEX;
+    InitializeCache(&context->EdgeCache, EDGE_CACHE_SIZE);
+    context->EdgeScratch = NULL;
+    context->EdgeScratchSize = 0;
+    InitializeCache(&context->CoverageCache, GLYPH_CACHE_SIZE);
+    context->SubpixelPhases = 0;
+    context->ColumnColors = NULL;
+    context->ColumnColorsCapacity = 0;
+    context->BandSize = BAND_SIZE;
+    context->Spans = NULL;
+    context->NumberOfSpans = 0;
+    context->SpansCapacity = 0;
+    context->RowSpans = NULL;
+    context->RowSpansCapacity = 0;
+    return context;
+}
+
+//(PUBLIC)
+void ReleaseRasterContext(tt_RasterContext* _context)
+{
+    free(_context->MetaCanvas_S1);
+    free(_context->MetaCanvas_S2);
+    free(_context->Scratch);
+    free(_context->Accumulation);
+    free(_context->Cells);
+    free(_context->Crossings);
+    ReleaseCache(&_context->EdgeCache);
+    free(_context->EdgeScratch);
+    ReleaseCache(&_context->CoverageCache);
+    free(_context->ColumnColors);
+    free(_context->Spans);
+    free(_context->RowSpans);
+    free(_context);
+}
+
+//(PUBLIC)
+//_context = NULL => the engine of the default context (used by DrawCharacter, DrawString and DrawGlyphRun) is set
+void SetRasterizationEngine(tt_RasterContext* _context, RasterizationEngine _engine)
+{
+    if (_context == NULL)
+    {
+        _context = &DefaultRasterContext;
+    }
+
+    _context->Engine = _engine;
+}
+
+//(PUBLIC)
+/* sets the largest total size (in bytes) of the edge lists that the context keeps for the drawn glyphs (see EdgeList); the least recently
+   used glyphs are removed when it's reached; 0 disables the cache (and releases its memory); _context = NULL => the default context */
+void SetEdgeCacheSize(tt_RasterContext* _context, size_t _size)
+{
+    if (_context == NULL)
+    {
+        _context = &DefaultRasterContext;
+    }
+
+    _context->EdgeCache.Budget = _size;
+    TrimCache(&_context->EdgeCache);
+}
+
+//(PUBLIC)
+/* sets the largest total size (in bytes) of the coverage of the drawn glyphs that the context keeps, so the next drawings of a glyph with
+   the same size and subpixel phase only blend it in the canvas; 0 disables the cache; _subpixelPhases > 0 => the position of every
+   glyph is rounded to 1/_subpixelPhases of a pixel (horizontally and vertically), so a glyph is drawn in at most _subpixelPhases *
+   _subpixelPhases different ways | _subpixelPhases = 0 => the position is not rounded (the cached glyphs are reused only at the same
+   fractional position); _context = NULL => the default context */
+void SetGlyphCache(tt_RasterContext* _context, size_t _size, int _subpixelPhases)
+{
+    if (_context == NULL)
+    {
+        _context = &DefaultRasterContext;
+    }
+
+    //(NOTE) the glyphs drawn with the previous phases are not valid anymore
+    if (_subpixelPhases != _context->SubpixelPhases)
+    {
+        ReleaseCache(&_context->CoverageCache);
+        _context->SubpixelPhases = _subpixelPhases;
+    }
+
+    _context->CoverageCache.Budget = _size;
+    TrimCache(&_context->CoverageCache);
+}
+
+//(PUBLIC)
+/* sets the largest number of pixels of the meta-canvas; a larger glyph is drawn in bands of rows (each with at most _numberOfPixels
+   pixels, but at least one row), so the memory needed for drawing doesn't depend on the size of the glyphs; a glyph drawn in more than
+   one band is not kept in the glyph cache, and with RE_SAMPLEX it's drawn as with RE_ANALYTIC; 0 :: no limit; _context = NULL => the
+   default context */
+void SetBandSize(tt_RasterContext* _context, int _numberOfPixels)
+{
+    if (_context == NULL)
+    {
+        _context = &DefaultRasterContext;
+    }
+
+    _context->BandSize = _numberOfPixels;
+}
+
+//(PRIVATE)
+tt_CacheStatistics GetCacheStatistics(const GlyphCache* _cache)
+{
+    tt_CacheStatistics statistics;
+    statistics.Hits = _cache->Hits;
+    statistics.Misses = _cache->Misses;
+    statistics.Evictions = _cache->Evictions;
+    statistics.NumberOfEntries = _cache->NumberOfEntries;
+    statistics.Usage = _cache->Usage;
+    statistics.Budget = _cache->Budget;
+    return statistics;
+}
+
+//(PUBLIC)
+//_context = NULL => the default context
+tt_CacheStatistics GetGlyphCacheStatistics(const tt_RasterContext* _context)
+{
+    return GetCacheStatistics(_context != NULL ? &_context->CoverageCache : &DefaultRasterContext.CoverageCache);
+}
 
-/* format of the elements in MetaCanvas_S2:
-   - bits [0..7] pixel type (determined in stage 1): 0 :: exteroid | 1 :: conturoid | 2 :: interoid
-   - bits [8..15] coverage */
+//(PUBLIC)
+//_context = NULL => the default context
+tt_CacheStatistics GetEdgeCacheStatistics(const tt_RasterContext* _context)
+{
+    return GetCacheStatistics(_context != NULL ? &_context->EdgeCache : &DefaultRasterContext.EdgeCache);
+}
 
 enum GlyphColorizationMode
 {
@@ -113,18 +619,96 @@ struct Bitex
 
 typedef struct Bitex Bitex;
 
+//a contour of the drawn glyph - a contour of its prepared outline (see PreparedGlyph), or a transformed copy of it
 struct Contour
 {
-    bool IsFilled;
-    short* X_Coordinates;
-    short* Y_Coordinates;
-    unsigned char* Flags;
+    const float* X_Coordinates;
+    const float* Y_Coordinates;
+    const unsigned char* Flags;
     int NumberOfPoints;
-    int OriginalIndex; //index before reordering
 };
 
 typedef struct Contour Contour;
 
+//a line of a flattened outline, in pixels, relative to the lower-left corner of the glyph (without the subpixel shift of the position)
+struct Edge
+{
+    double BeginX;
+    double BeginY;
+    double EndX;
+    double EndY;
+};
+
+typedef struct Edge Edge;
+
+//(RE_FIXED) the same as Edge, in 24.8 fixed point
+struct FixedEdge
+{
+    int BeginX;
+    int BeginY;
+    int EndX;
+    int EndY;
+};
+
+typedef struct FixedEdge FixedEdge;
+
+/* the outline of a glyph scaled to a size and flattened into lines for an engine (see BuildEdgeList) - everything that is needed to draw
+   the glyph except its position, so it's kept in the edge cache of the context and the next drawings of the glyph (with the same size)
+   only add the subpixel shift of their position to the edges:
+   - RE_SAMPLEX: all the lines of the contours, in the order of the contours (ContourEnds separates them)
+   - RE_ANALYTIC: Edges without the horizontal lines (they don't cover anything), in any order
+   - RE_FIXED: FixedEdges without the horizontal lines, in any order */
+struct EdgeList
+{
+    CacheEntry Entry; //(NOTE) the first member, so the edge list is a value in a GlyphCache
+    //the bounding box of the glyph, in font units (after the transformation of the glyph as a component of a composite glyph)
+    int LowestX;
+    int LowestY;
+    int HighestX;
+    int HighestY;
+    int NumberOfContours;
+    int* ContourEnds; //(RE_SAMPLEX) the index of the edge after the last edge of every contour
+    int NumberOfEdges;
+    Edge* Edges; //(RE_SAMPLEX, RE_ANALYTIC)
+    FixedEdge* FixedEdges; //(RE_FIXED)
+};
+
+typedef struct EdgeList EdgeList;
+
+/* a drawn glyph - the pixels of the meta-canvas at the end of stage 1 (see StoreCoverageMask), kept in the glyph cache of the context;
+   the elements of Coverage are in the format of MetaCanvas_S2, and Spans and RowSpans are the spans of its rows (see tt_RasterContext) */
+struct CoverageMask
+{
+    CacheEntry Entry; //(NOTE) the first member, so the mask is a value in a GlyphCache
+    int Width;
+    int Height;
+    //the position of the mask in the canvas, relative to the integer part of the (rounded) position of the glyph (see RasterizeGlyph)
+    int OffsetX;
+    int OffsetY;
+    unsigned char* Coverage;
+    CoverageSpan* Spans;
+    int* RowSpans; //Height + 1 elements
+};
+
+typedef struct CoverageMask CoverageMask;
+
+//the size and the position of a simple glyph that is ready to be drawn (see LayOutGlyph)
+struct GlyphLayout
+{
+    int Width; //the size of the meta-canvas of the whole glyph
+    int Height;
+    //the position of the meta-canvas relative to the integer part of the (rounded) position of the glyph
+    int OffsetX;
+    int OffsetY;
+    //the subpixel shift of the edges in the meta-canvas
+    double ShiftX;
+    double ShiftY;
+    int FixedShiftX; //(RE_FIXED) 24.8
+    int FixedShiftY; //(RE_FIXED) 24.8
+};
+
+typedef struct GlyphLayout GlyphLayout;
+
 struct tt_Rectangle
 {
     int X;
@@ -169,14 +753,6 @@ bool RectangleContainsRectangle(const tt_Rectangle* _rectangle1, const tt_Rectan
            RectangleContainsPoint(_rectangle1, p4.X, p4.Y);
 }
 
-struct ContourPair
-{
-    Contour* Contour;
-    Contour* DirectContainer;
-};
-
-typedef struct ContourPair ContourPair;
-
 struct tt_rgba
 {
     unsigned char R;
@@ -605,307 +1181,35 @@ double FractionOf(double N)
 }
 
 //(PRIVATE)
-//it copies segment (from _source to _destination) (beginning at _sourceBegin) and (with length specified by _length)
-void copy_short(const short* _source, short* _destination, int _destinationLength, int _sourceBegin,
-                int _destinationBegin, int _copyLength)
-{
-    for (int n = 0; ; n++)
-    {
-        if (n == _copyLength)
-        {
-            break;
-        }
-        else if (_destinationBegin + n == _destinationLength)
-        {
-            break;
-        }
-
-        _destination[_destinationBegin + n] = _source[_sourceBegin + n];
-    }
-}
-
-//(PRIVATE)
-//it copies segment (from _source to _destination) (beginning at _sourceBegin) and (with length specified by _length)
-void copy_uchar(const unsigned char* _source, unsigned char* _destination, int _destinationLength, int _sourceBegin,
-                int _destinationBegin, int _copyLength)
+//(LOCAL-TO DistanceOf(Bitex&, Bitex&))
+bool AreEqual(double _a, double _b)
 {
-    for (int n = 0; ; n++)
-    {
-        if (n == _copyLength)
-        {
-            break;
-        }
-        else if (_destinationBegin + n == _destinationLength)
-        {
-            break;
-        }
-
-        _destination[_destinationBegin + n] = _source[_sourceBegin + n];
-    }
+    double smaller = _a < _b ? _a : _b;
+    double larger = _a > _b ? _a : _b;
+    return (larger - smaller) <= 0.0001;
 }
 
 //(PRIVATE)
-//_length specifies the length of _array
-void swap_short(short* _array, int _i1, int _i2)
+//(LOCAL-TO DrawCharacter)
+/* the square of the distance between the integer parts of the coordinates (i.e. between the pixels, measured by their lower-left corners);
+   it's exact - comparing such distances doesn't need a square root */
+int SquaredDistanceOf(double x1, double y1, double x2, double y2)
 {
-    short c = _array[_i1];
-    _array[_i1] = _array[_i2];
-    _array[_i2] = c;
+    int side1 = (int) x1 - (int) x2;
+    int side2 = (int) y1 - (int) y2;
+    return (side1 * side1) + (side2 * side2);
 }
 
 //(PRIVATE)
-//_length specifies the length of _array
-void swap_uchar(unsigned char* _array, int _i1, int _i2)
+//(LOCAL-TO DrawCharacter fm:CoverageOf)
+double DistanceOf_Bitex(const Bitex* b1, const Bitex* b2)
 {
-    unsigned char c = _array[_i1];
-    _array[_i1] = _array[_i2];
-    _array[_i2] = c;
-}
+    if (AreEqual(b1->X, b2->X) && AreEqual(b1->Y, b2->Y)) return 0.0;
 
-//(PRIVATE)
-//_length specifies the length of _array
-void reverse_short(short* _array, int _length)
-{
-    for (int i = 0; i < _length / 2; i ++)
+    //if Xv is aligned with Xr
+    if (AreEqual(b1->Y, b2->Y))
     {
-        swap_short(_array, i, (_length - i) - 1);
-    }
-}
-
-//(PRIVATE)
-//_length specifies the length of _array
-void reverse_uchar(unsigned char* _array, int _length)
-{
-    for (int i = 0; i < _length / 2; i ++)
-    {
-        swap_uchar(_array, i, (_length - i) - 1);
-    }
-}
-
-//(PRIVATE)
-//_length specifies the length of _array
-//_array has atleast one free element at the end ->
-void insert(Contour* _array, int _length, Contour* _value, int _index)
-{
-    //moving of (the elements after _index) one position to the right
-    for (int i = _length - 1; i > _index; i--)
-    {
-        _array[i] = _array[i - 1];
-    }
-
-    _array[_index] = *_value;
-}
-
-//(PRIVATE)
-//(LOCAL-TO DrawCharacter)
-tt_rgba TT_GetPixel(unsigned char* _data, int _canvasWidth, int _x, int _y)
-{
-    int offset = (_y * _canvasWidth + _x) * PIXEL_SIZE;
-    tt_rgba color;
-    color.B = _data[offset];
-    color.G = _data[offset + 1];
-    color.R = _data[offset + 2];
-    color.A = _data[offset + 3];
-    return color;
-}
-
-//(PRIVATE)
-//(LOCAL-TO Move)
-double DegreesToRadians(double _degrees)
-{
-    if (_degrees < 0.0)
-    {
-        return 0.0;
-    }
-    else
-    {
-        return  (PI * _degrees) / 180.0;
-    }
-}
-
-//(PRIVATE)
-//(LOCAL-TO OrientationOf)
-double RadiansToDegrees(double _radians)
-{
-    if (_radians < 0.0)
-    {
-        return 0.0;
-    }
-    else
-    {
-        return (180.0 * _radians) / PI;
-    }
-}
-
-//(PRIVATE)
-//(LOCAL-TO IsFilledContour && DrawCharacter)
-//this function is using Bottom-Left coordinates
-//originX == pointX && originY == pointY => 0
-//originX != pointX || originY != pointY => 0..360
-double OrientationOf(double originX, double originY, double pointX, double pointY)
-{
-    if (originX == pointX && originY == pointY)
-    {
-        return 0.0;
-    }
-        ///special cases - 0, 90, 180 and 270 degrees
-    else if (originX == pointX && originY < pointY)
-    {
-        return 0.0;
-    }
-    else if (originY == pointY && originX < pointX)
-    {
-        return 90.0;
-    }
-    else if (originX == pointX && originY > pointY)
-    {
-        return 180.0;
-    }
-    else if (originY == pointY && originX > pointX)
-    {
-        return 270.0;
-    }
-        //if _point is in first quadrant in the local coordinate system with origin the point _origin
-    else if (originX < pointX && originY < pointY)
-    {
-        double opposite = pointY - originY;
-        double adjacent = pointX - originX;
-        return 90.0 - RadiansToDegrees(atan(opposite / adjacent));
-    }
-        //if _point is in second quadrant
-    else if (originX < pointX && originY > pointY)
-    {
-        double opposite = originY - pointY;
-        double adjacent = pointX - originX;
-        return 90.0 + RadiansToDegrees(atan(opposite / adjacent));
-    }
-        //if _point is in third quadrant
-    else if (originX > pointX && originY > pointY)
-    {
-        double opposite = originY - pointY;
-        double adjacent = originX - pointX;
-        return 270.0 - RadiansToDegrees(atan(opposite / adjacent));
-    }
-        //if _point is in fourth quadrant
-    else if (originX > pointX && originY < pointY)
-    {
-        double opposite = pointY - originY;
-        double adjacent = originX - pointX;
-        return 270.0 + RadiansToDegrees(atan(opposite / adjacent));
-    }
-}
-
-//(PRIVATE)
-//(LOCAL-TO DrawCharacter)
-//this function is using Bottom-Left coordinates
-//_delta == _point => 0
-//_delta != _point => 0..360
-void Move(double* _deltaX, double* _deltaY, double _orientation, double _magnitude)
-{
-    double x = *_deltaX;
-    double y = *_deltaY;
-
-    if (_orientation == 0.0 || _orientation == 360.0)
-    {
-        *_deltaY = y + _magnitude;
-    }
-    else if (_orientation == 90.0)
-    {
-        *_deltaX = x + _magnitude;
-    }
-    else if (_orientation == 180.0)
-    {
-        *_deltaY = y - _magnitude;
-    }
-    else if (_orientation == 270.0)
-    {
-        *_deltaX = x - _magnitude;
-    }
-    else if (_orientation < 90.0)
-    {
-        double hypotenuse = _magnitude;
-        double adjacent = cos(DegreesToRadians(_orientation)) * hypotenuse;
-        double opposite = sin(DegreesToRadians(_orientation)) * hypotenuse;
-        *_deltaX = x + opposite;
-        *_deltaY = y + adjacent;
-    }
-    else if (_orientation > 90.0 && _orientation < 180.0)
-    {
-        double hypotenuse = _magnitude;
-        double adjacent = cos(DegreesToRadians(_orientation - 90.0)) * hypotenuse;
-        double opposite = sin(DegreesToRadians(_orientation - 90.0)) * hypotenuse;
-        *_deltaX = x + adjacent;
-        *_deltaY = y - opposite;
-    }
-    else if (_orientation > 180.0 && _orientation < 270.0)
-    {
-        double hypotenuse = _magnitude;
-        double adjacent = cos(DegreesToRadians(_orientation - 180.0)) * hypotenuse;
-        double opposite = sin(DegreesToRadians(_orientation - 180.0)) * hypotenuse;
-        *_deltaX = x - opposite;
-        *_deltaY = y - adjacent;
-    }
-    else if (_orientation > 270.0 && _orientation < 360.0)
-    {
-        double hypotenuse = _magnitude;
-        double adjacent = cos(DegreesToRadians(_orientation - 270.0)) * hypotenuse;
-        double opposite = sin(DegreesToRadians(_orientation - 270.0)) * hypotenuse;
-        *_deltaX = x - adjacent;
-        *_deltaY = y + opposite;
-    }
-}
-
-//(PRIVATE)
-//(LOCAL-TO DistanceOf(Bitex&, Bitex&))
-bool AreEqual(double _a, double _b)
-{
-    double smaller = _a < _b ? _a : _b;
-    double larger = _a > _b ? _a : _b;
-    return (larger - smaller) <= 0.0001;
-}
-
-//(PRIVATE)
-//(LOCAL-TO DrawCharacter)
-double DistanceOf(double x1, double y1, double x2, double y2)
-{
-    if (x1 == x2 && y1 == y2) return 0.0;
-
-    int smallerX = x1 < x2 ? x1 : x2;
-    int smallerY = y1 < y2 ? y1 : y2;
-    int largerX = x1 > x2 ? x1 : x2;
-    int largerY = y1 > y2 ? y1 : y2;
-
-    //if Xv is aligned with Xr
-    if (y1 == y2)
-    {
-        return largerX - smallerX;
-    }
-        //if Yv is aligned with Yr
-    else if (x1 == x2)
-    {
-        return largerY - smallerY;
-    }
-    else
-    {
-        //the distance is the hypotenuse of a right triangle - side1 and side2 are the adjacent and the opposite side
-        //the Pythagorean theorem is used for finding the hypotenuse
-
-        double side1 = largerX - smallerX;
-        double side2 = largerY - smallerY;
-        return sqrt((side1 * side1) + (side2 * side2));
-    }
-}
-
-//(PRIVATE)
-//(LOCAL-TO DrawCharacter fm:CoverageOf)
-double DistanceOf_Bitex(const Bitex* b1, const Bitex* b2)
-{
-    if (AreEqual(b1->X, b2->X) && AreEqual(b1->Y, b2->Y)) return 0.0;
-
-    //if Xv is aligned with Xr
-    if (AreEqual(b1->Y, b2->Y))
-    {
-        return LargerOf(b1->X, b2->X) - SmallerOf(b1->X, b2->X);
+        return LargerOf(b1->X, b2->X) - SmallerOf(b1->X, b2->X);
     }
         //if Yv is aligned with Yr
     else if (AreEqual(b1->X, b2->X))
@@ -923,26 +1227,10 @@ double DistanceOf_Bitex(const Bitex* b1, const Bitex* b2)
     }
 }
 
-//(PRIVATE)
-//(LOCAL-TO DrawCharacter)
-Bitex CentexOf(double x1, double y1, double x2, double y2)
-{
-    double smallerX = SmallerOf(x1, x2);
-    double smallerY = SmallerOf(y1, y2);
-    double largerX = LargerOf(x1, x2);
-    double largerY = LargerOf(y1, y2);
-    double width = largerX - smallerX;
-    double height = largerY - smallerY;
-    Bitex bitex;
-    bitex.X = smallerX + (width / 2.0);
-    bitex.Y = smallerY + (height / 2.0);
-    return bitex;
-}
-
 //(PRIVATE)
 //(LOCAL-TO DrawCharacter)
 //determines the coverage of a segmentonom (singular crossing)
-unsigned int SegmentonomCoverage(const Bitex* _enteringSamplex, const Bitex* _exitingSamplex, const Bitex* _nextEnteringSamplex, bool _isFilledContour)
+unsigned int SegmentonomCoverage(tt_RasterContext* _context, const Bitex* _enteringSamplex, const Bitex* _exitingSamplex, const Bitex* _nextEnteringSamplex)
 {
     //(DEBUG-BLOCK)
     //(SHOULD-NOT-HAPPEN)
@@ -950,8 +1238,8 @@ unsigned int SegmentonomCoverage(const Bitex* _enteringSamplex, const Bitex* _ex
     {
         int breakpoint = 0;
     }
-    if ((_enteringSamplex->X > MetaCanvasWidth) || (_enteringSamplex->Y > MetaCanvasHeight) ||
-        (_exitingSamplex->X > MetaCanvasWidth) || (_exitingSamplex->Y > MetaCanvasHeight))
+    if ((_enteringSamplex->X > _context->MetaCanvasWidth) || (_enteringSamplex->Y > _context->MetaCanvasHeight) ||
+        (_exitingSamplex->X > _context->MetaCanvasWidth) || (_exitingSamplex->Y > _context->MetaCanvasHeight))
     {
         int breakpoint = 0;
     }
@@ -973,10 +1261,8 @@ unsigned int SegmentonomCoverage(const Bitex* _enteringSamplex, const Bitex* _ex
     //B :: lower edge of the pixel
 
     unsigned int coverage;
-    int position = currentPixelY * MetaCanvasWidth + currentPixelX;
-    unsigned int marker = MetaCanvas_S1[position];
-    int crossingType = N_CROSSING;
-    int middleX = (((AverageOf(localEnteringX, localExitingX)) * 100) / 1.35) + 1/*to not be 0*/;
+    int position = currentPixelY * _context->MetaCanvasWidth + currentPixelX;
+    unsigned int marker = _context->MetaCanvas_S1[position];
 
     //if there is corner crossing
     if (_enteringSamplex == _exitingSamplex)
@@ -985,185 +1271,151 @@ unsigned int SegmentonomCoverage(const Bitex* _enteringSamplex, const Bitex* _ex
         const Bitex* samplexB = _nextEnteringSamplex;
 
         //(L->T) crossing
-        if (PreviousPixelX < currentPixelX && PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
+        if (_context->PreviousPixelX < currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
         {
-            coverage = 99.0;
-            crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
-            SetBit(&coverage, _isFilledContour ? O_LEFT : T_LEFT, true);
+            coverage = FULL_COVERAGE - 1;
         }
             //(Т->L) crossing
-        else if (PreviousPixelY > currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
+        else if (_context->PreviousPixelY > currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
         {
             coverage = 1.0;
-            crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
-            SetBit(&coverage, _isFilledContour ? T_LEFT : O_LEFT, true);
         }
             //(L->B) crossing
-        else if (PreviousPixelX < currentPixelX && PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
+        else if (_context->PreviousPixelX < currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
         {
             coverage = 1.0;
-            crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
-            SetBit(&coverage, _isFilledContour ? T_LEFT : O_LEFT, true);
         }
             //(B->L) crossing
-        else if (PreviousPixelY < currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
+        else if (_context->PreviousPixelY < currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
         {
-            coverage = 99.0;
-            crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
-            SetBit(&coverage, _isFilledContour ? O_LEFT : T_LEFT, true);
+            coverage = FULL_COVERAGE - 1;
         }
             //(T->R) crossing
-        else if (PreviousPixelY > currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
+        else if (_context->PreviousPixelY > currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
         {
-            coverage = 99.0;
-            crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
-            SetBit(&coverage, _isFilledContour ? T_RIGHT : O_RIGHT, true);
+            coverage = FULL_COVERAGE - 1;
         }
             //(R->T) crossing
-        else if (PreviousPixelX > currentPixelX && PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
+        else if (_context->PreviousPixelX > currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
         {
             coverage = 1.0;
-            crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
-            SetBit(&coverage, _isFilledContour ? O_RIGHT : T_RIGHT, true);
         }
             //(B->R) crossing
-        else if (PreviousPixelY < currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
+        else if (_context->PreviousPixelY < currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
         {
             coverage = 1.0;
-            crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
-            SetBit(&coverage, _isFilledContour ? O_RIGHT : T_RIGHT, true);
         }
             //(R->B) crossing
-        else if (PreviousPixelX > currentPixelX && PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
+        else if (_context->PreviousPixelX > currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
         {
-            coverage = 99.0;
-            crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
-            SetBit(&coverage, _isFilledContour ? T_RIGHT : O_RIGHT, true);
+            coverage = FULL_COVERAGE - 1;
         }
     }
         //(B->T crossing)
-    else if (PreviousPixelY < currentPixelY && nextPixelY > currentPixelY)
+    else if (_context->PreviousPixelY < currentPixelY && nextPixelY > currentPixelY)
     {
         double middleX = AverageOf(localEnteringX, localExitingX);
         double width = 1.0 - middleX;
         double height = 1.0;
-        coverage = width * height * 100.0;
-        crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
+        coverage = width * height * FULL_COVERAGE;
     }
         //(T->B crossing)
-    else if (PreviousPixelY > currentPixelY && nextPixelY < currentPixelY)
+    else if (_context->PreviousPixelY > currentPixelY && nextPixelY < currentPixelY)
     {
         double middleX = AverageOf(localEnteringX, localExitingX);
         double width = middleX;
         double height = 1.0;
-        coverage = width * height * 100.0;
-        crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
+        coverage = width * height * FULL_COVERAGE;
     }
         //(L->R crossing)
-    else if (PreviousPixelX < currentPixelX && nextPixelX > currentPixelX && PreviousPixelY == currentPixelY && nextPixelY == currentPixelY)
+    else if (_context->PreviousPixelX < currentPixelX && nextPixelX > currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY == currentPixelY)
     {
         double middleY = AverageOf(localEnteringY, localExitingY);
         double width = 1.0;
         double height = middleY;
-        coverage = width * height * 100.0;
+        coverage = width * height * FULL_COVERAGE;
     }
         //(R->L crossing)
-    else if (PreviousPixelX > currentPixelX && nextPixelX < currentPixelX && PreviousPixelY == currentPixelY && nextPixelY == currentPixelY)
+    else if (_context->PreviousPixelX > currentPixelX && nextPixelX < currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY == currentPixelY)
     {
         double middleY = AverageOf(localEnteringY, localExitingY);
         double width = 1.0;
         double height = 1.0 - middleY;
-        coverage = width * height * 100.0;
+        coverage = width * height * FULL_COVERAGE;
     }
         //(L->B crossing)
-    else if (PreviousPixelX < currentPixelX && PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
+    else if (_context->PreviousPixelX < currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
     {
         double width = _exitingSamplex->X - _enteringSamplex->X;
         double height = _enteringSamplex->Y - _exitingSamplex->Y;
-        coverage = (width * height * 100.0) / 2.0;
-        crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
-        SetBit(&coverage, _isFilledContour ? T_LEFT : O_LEFT, true);
+        coverage = (width * height * FULL_COVERAGE) / 2.0;
     }
         //(L->T crossing)
-    else if (PreviousPixelX < currentPixelX && PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
+    else if (_context->PreviousPixelX < currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
     {
         double width = _exitingSamplex->X - _enteringSamplex->X;
         double height = _exitingSamplex->Y - _enteringSamplex->Y;
-        coverage = 100.0 - ((width * height * 100.0) / 2.0);
-        crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
-        SetBit(&coverage, _isFilledContour ? O_LEFT : T_LEFT, true);
+        coverage = FULL_COVERAGE - ((width * height * FULL_COVERAGE) / 2.0);
     }
         //(R->B crossing)
-    else if (PreviousPixelX > currentPixelX && PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
+    else if (_context->PreviousPixelX > currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
     {
         double width = _enteringSamplex->X - _exitingSamplex->X;
         double height = _enteringSamplex->Y - _exitingSamplex->Y;
-        coverage = 100.0 - ((width * height * 100.0) / 2.0);
-        crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
-        SetBit(&coverage, _isFilledContour ? T_RIGHT : O_LEFT, true);
+        coverage = FULL_COVERAGE - ((width * height * FULL_COVERAGE) / 2.0);
     }
         //(R->T crossing)
-    else if (PreviousPixelX > currentPixelX && PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
+    else if (_context->PreviousPixelX > currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
     {
         double width = _enteringSamplex->X - _exitingSamplex->X;
         double height = _exitingSamplex->Y - _enteringSamplex->Y;
-        coverage = (width * height * 100.0) / 2.0;
-        crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
-        SetBit(&coverage, _isFilledContour ? O_RIGHT : T_RIGHT, true);
+        coverage = (width * height * FULL_COVERAGE) / 2.0;
     }
         //(B->L crossing)
-    else if (PreviousPixelY < currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
+    else if (_context->PreviousPixelY < currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
     {
         double width = _enteringSamplex->X - _exitingSamplex->X;
         double height = _exitingSamplex->Y - _enteringSamplex->Y;
-        coverage = 100.0 - ((width * height * 100.0) / 2.0);
-        crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
-        SetBit(&coverage, _isFilledContour ? O_LEFT : T_LEFT, true);
+        coverage = FULL_COVERAGE - ((width * height * FULL_COVERAGE) / 2.0);
     }
         //(B->R crossing)
-    else if (PreviousPixelY < currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
+    else if (_context->PreviousPixelY < currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
     {
         double width = _exitingSamplex->X - _enteringSamplex->X;
         double height = _exitingSamplex->Y - _enteringSamplex->Y;
-        coverage = (width * height * 100.0) / 2.0;
-        crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
-        SetBit(&coverage, _isFilledContour ? O_RIGHT : T_RIGHT, true);
+        coverage = (width * height * FULL_COVERAGE) / 2.0;
     }
         //(T->L crossing)
-    else if (PreviousPixelY > currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
+    else if (_context->PreviousPixelY > currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
     {
         double width = _enteringSamplex->X - _exitingSamplex->X;
         double height = _enteringSamplex->Y - _exitingSamplex->Y;
-        coverage = (width * height * 100.0) / 2.0;
-        crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
-        SetBit(&coverage, _isFilledContour ? T_LEFT : O_LEFT, true);
+        coverage = (width * height * FULL_COVERAGE) / 2.0;
     }
         //(T->R crossing)
-    else if (PreviousPixelY > currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
+    else if (_context->PreviousPixelY > currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
     {
         double width = _exitingSamplex->X - _enteringSamplex->X;
         double height = _enteringSamplex->Y - _exitingSamplex->Y;
-        coverage = 100.0 - ((width * height * 100.0) / 2.0);
-        crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
-        SetBit(&coverage, _isFilledContour ? T_RIGHT : O_RIGHT, true);
+        coverage = FULL_COVERAGE - ((width * height * FULL_COVERAGE) / 2.0);
     }
         //L->L (up|down)
-    else if (PreviousPixelX < currentPixelX && PreviousPixelX == nextPixelX)
+    else if (_context->PreviousPixelX < currentPixelX && _context->PreviousPixelX == nextPixelX)
     {
         return marker;
     }
         //R->R (up|down)
-    else if (PreviousPixelX > currentPixelX && PreviousPixelX == nextPixelX)
+    else if (_context->PreviousPixelX > currentPixelX && _context->PreviousPixelX == nextPixelX)
     {
         return marker;
     }
         //T->T (to left | to right)
-    else if (PreviousPixelY > currentPixelY && PreviousPixelY == nextPixelY)
+    else if (_context->PreviousPixelY > currentPixelY && _context->PreviousPixelY == nextPixelY)
     {
         return marker;
     }
         //B->B (to left | to right)
-    else if (PreviousPixelY < currentPixelY && PreviousPixelY == nextPixelY)
+    else if (_context->PreviousPixelY < currentPixelY && _context->PreviousPixelY == nextPixelY)
     {
         return marker;
     }
@@ -1173,26 +1425,11 @@ unsigned int SegmentonomCoverage(const Bitex* _enteringSamplex, const Bitex* _ex
         int breakpoint = 0;
     }
 
-    if (GetBits(coverage, 0, 6) < 1)
-    {
-        SetBit(&coverage, 0, true);
-    }
+    coverage = GetBits(coverage, 0, 7);
 
-    if (crossingType == O_CROSSING && middleX > GetBits(marker, O_BEGIN, O_END))
-    {
-        SetBits_UINT(&coverage, O_BEGIN, O_END, middleX);
-        SetBits_UINT(&coverage, T_BEGIN, T_END,  GetBits(marker, T_BEGIN, T_END));
-    }
-    else if (crossingType == T_CROSSING && middleX > GetBits(marker, T_BEGIN, T_END))
+    if (coverage < 1)
     {
-        SetBits_UINT(&coverage, O_BEGIN, O_END, GetBits(marker, O_BEGIN, O_END));
-        SetBits_UINT(&coverage, T_BEGIN, T_END, middleX);
-    }
-    else
-    {
-        SetBits_UINT(&coverage, O_BEGIN, O_END, GetBits(marker, O_BEGIN, O_END));
-        SetBits_UINT(&coverage, T_BEGIN, T_END,  GetBits(marker, T_BEGIN, T_END));
-        SetBits_UINT(&coverage, 22, 25,  GetBits(marker, 22, 25));
+        coverage = 1;
     }
 
     return coverage;
@@ -1201,8 +1438,8 @@ unsigned int SegmentonomCoverage(const Bitex* _enteringSamplex, const Bitex* _ex
 //(PRIVATE)
 //(LOCAL-TO DrawCharacter)
 //determines the coverage of a segmentoid (singular crossing)
-unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _enteringSamplex, const Bitex* _exitingSamplex,
-                                const Bitex* _nextEnteringSamplex, bool _isFilledContour)
+unsigned int SegmentoidCoverage(tt_RasterContext* _context, const Bitex* _segmentoidVertex, const Bitex* _enteringSamplex,
+                                const Bitex* _exitingSamplex, const Bitex* _nextEnteringSamplex)
 {
     //(DEBUG)
     //(SHOULD-NOT-HAPPEN)
@@ -1222,8 +1459,8 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
     {
         int breakpoint = 0;
     }
-    if ((_enteringSamplex->X > MetaCanvasWidth) || (_enteringSamplex->Y > MetaCanvasHeight) ||
-        (_exitingSamplex->X > MetaCanvasWidth) || (_exitingSamplex->Y > MetaCanvasHeight))
+    if ((_enteringSamplex->X > _context->MetaCanvasWidth) || (_enteringSamplex->Y > _context->MetaCanvasHeight) ||
+        (_exitingSamplex->X > _context->MetaCanvasWidth) || (_exitingSamplex->Y > _context->MetaCanvasHeight))
     {
         int breakpoint = 0;
     }
@@ -1242,22 +1479,15 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
     bottomRightPixeloid.X = RoundUp(_segmentoidVertex->X);
     bottomRightPixeloid.Y = RoundDown(_segmentoidVertex->Y);
 
-    double localEnteringX = _enteringSamplex->X - RoundDown(_enteringSamplex->X);
-    double localExitingX = _exitingSamplex->X - RoundDown(_enteringSamplex->X);
-
     int currentPixelX = RoundDown(_enteringSamplex->X);
     int currentPixelY = RoundDown(_enteringSamplex->Y);
     int nextPixelX = RoundDown(_nextEnteringSamplex->X);
     int nextPixelY = RoundDown(_nextEnteringSamplex->Y);
 
     unsigned int coverage;
-    int position = currentPixelY * MetaCanvasWidth + currentPixelX;
-    unsigned int marker = MetaCanvas_S1[position];
-    int crossingType = N_CROSSING;
-    int middleX = (((AverageOf(localEnteringX, localExitingX)) * 100) / 1.35) + 1/*to not be 0*/;
 
     //(L->R crossing)
-    if (PreviousPixelX < currentPixelX && nextPixelX > currentPixelX && PreviousPixelY == currentPixelY && nextPixelY == currentPixelY)
+    if (_context->PreviousPixelX < currentPixelX && nextPixelX > currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY == currentPixelY)
     {
         double T1_A = _enteringSamplex->Y - bottomLeftPixeloid.Y;
         double T1_B = DistanceOf_Bitex(_enteringSamplex, _segmentoidVertex);
@@ -1283,10 +1513,10 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T3_area)) T3_area = 0.0;
 
-        coverage = (T1_area + T2_area + T3_area) * 100.0;
+        coverage = (T1_area + T2_area + T3_area) * FULL_COVERAGE;
     }
         //(R->L crossing)
-    else if (PreviousPixelX > currentPixelX && nextPixelX < currentPixelX && PreviousPixelY == currentPixelY && nextPixelY == currentPixelY)
+    else if (_context->PreviousPixelX > currentPixelX && nextPixelX < currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY == currentPixelY)
     {
         double T1_A = _enteringSamplex->Y - bottomRightPixeloid.Y;
         double T1_B = DistanceOf_Bitex(_enteringSamplex, _segmentoidVertex);
@@ -1312,10 +1542,10 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T3_area)) T3_area = 0.0;
 
-        coverage = (1.0 - (T1_area + T2_area + T3_area)) * 100.0;
+        coverage = (1.0 - (T1_area + T2_area + T3_area)) * FULL_COVERAGE;
     }
         //(B->T crossing)
-    else if (PreviousPixelY < currentPixelY && nextPixelY > currentPixelY)
+    else if (_context->PreviousPixelY < currentPixelY && nextPixelY > currentPixelY)
     {
         double T1_A = DistanceOf_Bitex(_enteringSamplex, _segmentoidVertex);
         double T1_B = bottomRightPixeloid.X - _enteringSamplex->X;
@@ -1341,12 +1571,11 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T3_area)) T3_area = 0.0;
 
-        coverage = (T1_area + T2_area + T3_area) * 100.0;
+        coverage = (T1_area + T2_area + T3_area) * FULL_COVERAGE;
 
-        crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
     }
         //(T->B crossing)
-    else if (PreviousPixelY > currentPixelY && nextPixelY < currentPixelY)
+    else if (_context->PreviousPixelY > currentPixelY && nextPixelY < currentPixelY)
     {
         double T1_A = DistanceOf_Bitex(_segmentoidVertex, _enteringSamplex);
         double T1_B = _enteringSamplex->X - upperLeftPixeloid.X;
@@ -1372,12 +1601,11 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T3_area)) T3_area = 0.0;
 
-        coverage = (T1_area + T2_area + T3_area) * 100.0;
+        coverage = (T1_area + T2_area + T3_area) * FULL_COVERAGE;
 
-        crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
     }
         //(L->T crossing)
-    else if (PreviousPixelX < currentPixelX && PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
+    else if (_context->PreviousPixelX < currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
     {
         double T1_A = upperLeftPixeloid.Y - _enteringSamplex->Y;
         double T1_B = DistanceOf_Bitex(_enteringSamplex, _segmentoidVertex);
@@ -1395,14 +1623,12 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T2_area)) T2_area = 0.0;
 
-        coverage = 100 - ((T1_area + T2_area) * 100.0);
+        coverage = FULL_COVERAGE - ((T1_area + T2_area) * FULL_COVERAGE);
 
-        crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
 
-        SetBit(&coverage, _isFilledContour ? O_LEFT : T_LEFT, true);
     }
         //(T->L crossing)
-    else if (PreviousPixelY > currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
+    else if (_context->PreviousPixelY > currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
     {
         double T1_A = upperLeftPixeloid.Y - _exitingSamplex->Y;
         double T1_B = DistanceOf_Bitex(_exitingSamplex, _segmentoidVertex);
@@ -1420,14 +1646,12 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T2_area)) T2_area = 0.0;
 
-        coverage = (T1_area + T2_area) * 100.0;
+        coverage = (T1_area + T2_area) * FULL_COVERAGE;
 
-        crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
 
-        SetBit(&coverage, _isFilledContour ? T_LEFT : O_LEFT, true);
     }
         //(L->B crossing)
-    else if (PreviousPixelX < currentPixelX && PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
+    else if (_context->PreviousPixelX < currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
     {
         double T1_A = _enteringSamplex->Y - bottomLeftPixeloid.Y;
         double T1_B = DistanceOf_Bitex(_enteringSamplex, _segmentoidVertex);
@@ -1445,14 +1669,12 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T2_area)) T2_area = 0.0;
 
-        coverage = (T1_area + T2_area) * 100.0;
+        coverage = (T1_area + T2_area) * FULL_COVERAGE;
 
-        crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
 
-        SetBit(&coverage, _isFilledContour ? T_LEFT : O_LEFT, true);
     }
         //(B->L crossing)
-    else if (PreviousPixelY < currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
+    else if (_context->PreviousPixelY < currentPixelY && nextPixelX < currentPixelX && nextPixelY == currentPixelY)
     {
         double T1_A = DistanceOf_Bitex(_enteringSamplex, _segmentoidVertex);
         double T1_B = DistanceOf_Bitex(_segmentoidVertex, &bottomLeftPixeloid);
@@ -1470,14 +1692,12 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T2_area)) T2_area = 0.0;
 
-        coverage = 100.0 - ((T1_area + T2_area) * 100.0);
+        coverage = FULL_COVERAGE - ((T1_area + T2_area) * FULL_COVERAGE);
 
-        crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
 
-        SetBit(&coverage, _isFilledContour ? O_LEFT : T_LEFT, true);
     }
         //(R->T crossing)
-    else if (PreviousPixelX > currentPixelX && PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
+    else if (_context->PreviousPixelX > currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY > currentPixelY)
     {
         double T1_A = DistanceOf_Bitex(_enteringSamplex, _segmentoidVertex);
         double T1_B = DistanceOf_Bitex(_segmentoidVertex, _exitingSamplex);
@@ -1495,14 +1715,12 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T2_area)) T2_area = 0.0;
 
-        coverage = (T1_area + T2_area) * 100.0;
+        coverage = (T1_area + T2_area) * FULL_COVERAGE;
 
-        crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
 
-        SetBit(&coverage, _isFilledContour ? O_RIGHT : O_RIGHT, true);
     }
         //(T->R crossing)
-    else if (PreviousPixelY > currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
+    else if (_context->PreviousPixelY > currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
     {
         double T1_A = upperRightPixeloid.X - _enteringSamplex->X;
         double T1_B = DistanceOf_Bitex(_enteringSamplex, _segmentoidVertex);
@@ -1520,14 +1738,12 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T2_area)) T2_area = 0.0;
 
-        coverage = 100.0 - ((T1_area + T2_area) * 100.0);
+        coverage = FULL_COVERAGE - ((T1_area + T2_area) * FULL_COVERAGE);
 
-        crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
 
-        SetBit(&coverage, _isFilledContour ? T_RIGHT : T_LEFT, true);
     }
         //(R->B crossing)
-    else if (PreviousPixelX > currentPixelX && PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
+    else if (_context->PreviousPixelX > currentPixelX && _context->PreviousPixelY == currentPixelY && nextPixelY < currentPixelY)
     {
         double T1_A = _enteringSamplex->Y - bottomRightPixeloid.Y;
         double T1_B = DistanceOf_Bitex(_enteringSamplex, _segmentoidVertex);
@@ -1545,14 +1761,12 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T2_area)) T2_area = 0.0;
 
-        coverage = 100.0 - ((T1_area + T2_area) * 100.0);
+        coverage = FULL_COVERAGE - ((T1_area + T2_area) * FULL_COVERAGE);
 
-        crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
 
-        SetBit(&coverage, _isFilledContour ? T_RIGHT : O_RIGHT, true);
     }
         //(B->R crossing)
-    else if (PreviousPixelY < currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
+    else if (_context->PreviousPixelY < currentPixelY && nextPixelX > currentPixelX && nextPixelY == currentPixelY)
     {
         double T1_A = DistanceOf_Bitex(_enteringSamplex, _segmentoidVertex);
         double T1_B = DistanceOf_Bitex(_segmentoidVertex, _exitingSamplex);
@@ -1570,14 +1784,12 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
         if (isnan(T2_area)) T2_area = 0.0;
 
-        coverage = (T1_area + T2_area) * 100.0;
+        coverage = (T1_area + T2_area) * FULL_COVERAGE;
 
-        crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
 
-        SetBit(&coverage, _isFilledContour ? O_RIGHT : T_RIGHT, true);
     }
         //L->L (up|down)
-    else if (PreviousPixelX < currentPixelX && PreviousPixelX == nextPixelX)
+    else if (_context->PreviousPixelX < currentPixelX && _context->PreviousPixelX == nextPixelX)
     {
         //(L->L (down)
         if (_enteringSamplex->Y > _exitingSamplex->Y)
@@ -1590,10 +1802,8 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
             if (isnan(T_area)) T_area = 0.0;
 
-            coverage = T_area * 100.0;
+            coverage = T_area * FULL_COVERAGE;
 
-            crossingType = _isFilledContour ? T_CROSSING : O_CROSSING;
-            SetBit(&coverage, _isFilledContour ? T_LEFT : O_LEFT, true);
         }
             //(L->L (up)
         else
@@ -1606,14 +1816,12 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
             if (isnan(T_area)) T_area = 0.0;
 
-            coverage = 100.0 - (T_area * 100.0);
+            coverage = FULL_COVERAGE - (T_area * FULL_COVERAGE);
 
-            crossingType = _isFilledContour ? O_CROSSING : T_CROSSING;
-            SetBit(&coverage, _isFilledContour ? O_LEFT : T_LEFT, true);
         }
     }
         //R->R (up|down)
-    else if (PreviousPixelX > currentPixelX && PreviousPixelX == nextPixelX)
+    else if (_context->PreviousPixelX > currentPixelX && _context->PreviousPixelX == nextPixelX)
     {
         //R->R (down)
         if (_enteringSamplex->Y > _exitingSamplex->Y)
@@ -1626,9 +1834,8 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
             if (isnan(T_area)) T_area = 0.0;
 
-            coverage = 100.0 - (T_area * 100.0);
+            coverage = FULL_COVERAGE - (T_area * FULL_COVERAGE);
 
-            SetBit(&coverage, _isFilledContour ? T_RIGHT : O_RIGHT, true);
         }
             //R->R (up)
         else
@@ -1641,11 +1848,11 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
             if (isnan(T_area)) T_area = 0.0;
 
-            coverage = T_area * 100.0;
+            coverage = T_area * FULL_COVERAGE;
         }
     }
         //T->T (to left | to right)
-    else if (PreviousPixelY > currentPixelY && PreviousPixelY == nextPixelY)
+    else if (_context->PreviousPixelY > currentPixelY && _context->PreviousPixelY == nextPixelY)
     {
         //T->T (to left)
         if (_enteringSamplex->X > _exitingSamplex->X)
@@ -1658,7 +1865,7 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
             if (isnan(T_area)) T_area = 0.0;
 
-            coverage = T_area * 100.0;
+            coverage = T_area * FULL_COVERAGE;
         }
             //Т->Т (to right)
         else
@@ -1671,11 +1878,11 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
             if (isnan(T_area)) T_area = 0.0;
 
-            coverage = 100.0 - (T_area * 100.0);
+            coverage = FULL_COVERAGE - (T_area * FULL_COVERAGE);
         }
     }
         //B->B (to left | to right)
-    else if (PreviousPixelY < currentPixelY && PreviousPixelY == nextPixelY)
+    else if (_context->PreviousPixelY < currentPixelY && _context->PreviousPixelY == nextPixelY)
     {
         //B->B (to left)
         if (_enteringSamplex->X > _exitingSamplex->X)
@@ -1688,7 +1895,7 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
             if (isnan(T_area)) T_area = 0.0;
 
-            coverage = 100.0 - (T_area * 100.0);
+            coverage = FULL_COVERAGE - (T_area * FULL_COVERAGE);
         }
             //B->B (to right)
         else
@@ -1701,7 +1908,7 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 
             if (isnan(T_area)) T_area = 0.0;
 
-            coverage = T_area * 100.0;
+            coverage = T_area * FULL_COVERAGE;
         }
     }
         //(SHOULD-NOT-HAPPEN)
@@ -1710,26 +1917,11 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
         int breakpoint = 0;
     }
 
-    if (GetBits(coverage, 0, 6) < 1)
-    {
-        SetBit(&coverage, 0, true);
-    }
+    coverage = GetBits(coverage, 0, 7);
 
-    if (crossingType == O_CROSSING && middleX > GetBits(marker, O_BEGIN, O_END))
-    {
-        SetBits_UINT(&coverage, O_BEGIN, O_END, middleX);
-        SetBits_UINT(&coverage, T_BEGIN, T_END,  GetBits(marker, T_BEGIN, T_END));
-    }
-    else if (crossingType == T_CROSSING && middleX > GetBits(marker, T_BEGIN, T_END))
-    {
-        SetBits_UINT(&coverage, O_BEGIN, O_END, GetBits(marker, O_BEGIN, O_END));
-        SetBits_UINT(&coverage, T_BEGIN, T_END, middleX);
-    }
-    else
+    if (coverage < 1)
     {
-        SetBits_UINT(&coverage, O_BEGIN, O_END, GetBits(marker, O_BEGIN, O_END));
-        SetBits_UINT(&coverage, T_BEGIN, T_END,  GetBits(marker, T_BEGIN, T_END));
-        SetBits_UINT(&coverage, 22, 25,  GetBits(marker, 22, 25));
+        coverage = 1;
     }
 
     return coverage;
@@ -1740,18 +1932,18 @@ unsigned int SegmentoidCoverage(const Bitex* _segmentoidVertex, const Bitex* _en
 //determines the coverage of multi-crossed segmentonom or segmentoid (this is the +1 crossing)
 unsigned int MulticrossCoverage(unsigned int _oldMarker, unsigned int _newMarker)
 {
-    int oldCoverage = GetBits(_oldMarker, 0, 6);
-    int newCoverage = GetBits(_newMarker, 0, 6);
+    int oldCoverage = GetBits(_oldMarker, 0, 7);
+    int newCoverage = GetBits(_newMarker, 0, 7);
 
     unsigned int realCoverage;
 
-    if (oldCoverage + newCoverage < 100)
+    if (oldCoverage + newCoverage < FULL_COVERAGE)
     {
         realCoverage = oldCoverage + newCoverage;
     }
     else
     {
-        realCoverage = 100 - ((100 - oldCoverage) + (100 - newCoverage));
+        realCoverage = FULL_COVERAGE - ((FULL_COVERAGE - oldCoverage) + (FULL_COVERAGE - newCoverage));
     }
 
     if (realCoverage == 0)
@@ -1759,102 +1951,328 @@ unsigned int MulticrossCoverage(unsigned int _oldMarker, unsigned int _newMarker
         realCoverage = 1;
     }
 
-    SetBits_UINT(&_oldMarker, 0, 6, realCoverage);
-    SetBits_UINT(&_oldMarker, O_BEGIN, O_END, GetBits(_newMarker, O_BEGIN, O_END));
-    SetBits_UINT(&_oldMarker, T_BEGIN, T_END, GetBits(_newMarker, T_BEGIN, T_END));
+    return realCoverage;
+}
+
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+//prepares the cells of the context for _size values; they are zero-filled and they remain zero-filled after every glyph
+void ReserveCells(tt_RasterContext* _context, int _size)
+{
+    if (_size > _context->CellsCapacity)
+    {
+        free(_context->Cells);
+        _context->CellsCapacity = _size > _context->CellsCapacity * 2 ? _size : _context->CellsCapacity * 2;
+        _context->Cells = calloc(_context->CellsCapacity, sizeof(int));
+    }
+}
+
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+/* (RE_SAMPLEX) adds the crossings of a line with the centers of the rows of the meta-canvas to the crossings of the context; the
+   crossings of a row are linked from its cell (see SamplexFill), so the glyph needs memory only for its crossings, not for its pixels */
+void AccumulateWinding(tt_RasterContext* _context, double _beginX, double _beginY, double _endX, double _endY)
+{
+    int direction = 1;
+
+    if (_beginY == _endY)
+    {
+        return;
+    }
+    else if (_beginY > _endY)
+    {
+        double x = _beginX;
+        _beginX = _endX;
+        _endX = x;
+
+        double y = _beginY;
+        _beginY = _endY;
+        _endY = y;
+
+        direction = -1;
+    }
+
+    //(NOTE) the rows whose center is in [_beginY, _endY), so a row crossed at a vertex is counted only once for the two lines of the vertex
+    int firstRow = ceil(_beginY - 0.5);
+    int lastRow = ceil(_endY - 0.5) - 1;
+
+    if (firstRow < 0)
+    {
+        firstRow = 0;
+    }
+
+    if (lastRow > _context->MetaCanvasHeight - 1)
+    {
+        lastRow = _context->MetaCanvasHeight - 1;
+    }
+
+    double slope = (_endX - _beginX) / (_endY - _beginY);
 
-    if (GetBit(_newMarker, O_LEFT))
+    if (_context->NumberOfCrossings + (lastRow - firstRow) + 1 > _context->CrossingsCapacity)
     {
-        SetBit(&_oldMarker, O_LEFT, true);
+        int capacity = _context->NumberOfCrossings + (lastRow - firstRow) + 1;
+        _context->CrossingsCapacity = capacity > _context->CrossingsCapacity * 2 ? capacity : _context->CrossingsCapacity * 2;
+        _context->Crossings = realloc(_context->Crossings, sizeof(Crossing) * _context->CrossingsCapacity);
     }
 
-    if (GetBit(_newMarker, T_LEFT))
+    for (int row = firstRow; row <= lastRow; row++)
     {
-        SetBit(&_oldMarker, T_LEFT, true);
+        double x = _beginX + (((row + 0.5) - _beginY) * slope);
+        int column = ceil(x - 0.5);
+
+        if (column < 0)
+        {
+            column = 0;
+        }
+        else if (column > _context->MetaCanvasWidth)
+        {
+            column = _context->MetaCanvasWidth;
+        }
+
+        Crossing* crossing = &_context->Crossings[_context->NumberOfCrossings++];
+        crossing->Column = column;
+        crossing->Direction = direction;
+        crossing->Next = _context->Cells[row];
+        _context->Cells[row] = _context->NumberOfCrossings;
     }
+}
 
-    if (GetBit(_newMarker, O_RIGHT))
+//(PRIVATE)
+//(LOCAL-TO SamplexFill)
+/* puts the winding number of the center of every pixel of the row _row in _windings (MetaCanvasWidth + 1 elements), from the crossings
+   of the row; a crossing is added to the first pixel whose center is on the right side of it, so the sum of the row (from its left end to
+   a pixel) is the winding number of the center of the pixel; the crossings of the row are unlinked */
+void RowWindings(tt_RasterContext* _context, int _row, int* _windings)
+{
+    for (int column = 0; column <= _context->MetaCanvasWidth; column++)
     {
-        SetBit(&_oldMarker, O_RIGHT, true);
+        _windings[column] = 0;
     }
 
-    if (GetBit(_newMarker, T_RIGHT))
+    for (int index = _context->Cells[_row]; index != 0; index = _context->Crossings[index - 1].Next)
     {
-        SetBit(&_oldMarker, T_RIGHT, true);
+        _windings[_context->Crossings[index - 1].Column] += _context->Crossings[index - 1].Direction;
     }
 
-    return _oldMarker;
+    _context->Cells[_row] = 0;
+
+    for (int column = 1; column <= _context->MetaCanvasWidth; column++)
+    {
+        _windings[column] += _windings[column - 1];
+    }
 }
 
 //(PRIVATE)
 //(LOCAL-TO DrawCharacter)
-//(SOURCE) https://stackoverflow.com/questions/1165647/how-to-determine-if-a-list-of-polygon-points-are-in-clockwise-order?noredirect=1&lq=1
-bool IsFilledContour(const short* _x_coordinates, const short* _y_coordinates, int _pointCount)
+/* adds the spans of the row _row of MetaCanvas_S2 (just written by the fill) to the spans of the context, in the order of their columns -
+   the runs of at least MIN_SPAN_RUN interoids, and the pixels between them and the runs of at least MIN_SPAN_RUN exteroids; a short run
+   is a part of the span around it, and a span of conturoids is extended to whole groups of SPAN_GROUP pixels, so the spans of conturoids
+   are blended with SIMD (see CompositeSpan); the fills write the rows in order, so the first row begins the spans of a band */
+void AddCoverageSpans(tt_RasterContext* _context, int _row)
 {
-    int signedArea = 0;
+    int width = _context->MetaCanvasWidth;
+    const unsigned char* pixels = &_context->MetaCanvas_S2[_row * width];
+
+    if (_row == 0)
+    {
+        if (_context->MetaCanvasHeight + 1 > _context->RowSpansCapacity)
+        {
+            int capacity = _context->MetaCanvasHeight + 1;
+            _context->RowSpansCapacity = capacity > _context->RowSpansCapacity * 2 ? capacity : _context->RowSpansCapacity * 2;
+            _context->RowSpans = realloc(_context->RowSpans, sizeof(int) * _context->RowSpansCapacity);
+        }
+
+        _context->NumberOfSpans = 0;
+        _context->RowSpans[0] = 0;
+    }
+
+    //every span has at least one pixel, so a row has at most width spans
+    if (_context->NumberOfSpans + width > _context->SpansCapacity)
+    {
+        int capacity = _context->NumberOfSpans + width;
+        _context->SpansCapacity = capacity > _context->SpansCapacity * 2 ? capacity : _context->SpansCapacity * 2;
+        _context->Spans = realloc(_context->Spans, sizeof(CoverageSpan) * _context->SpansCapacity);
+    }
+
+    int mixedBegin = -1; //the first column of the current span of conturoids | -1 :: none
+    int mixedEnd = 0; //the column after the last pixel of the current span of conturoids that is not an exteroid
+    int column = 0;
 
-    for (int i = 0; i < _pointCount; i++)
+    while (column <= width)
     {
-        int x1 = _x_coordinates[i];
-        int y1 = _y_coordinates[i];
-        int x2;
-        int y2;
+        //the run of pixels of the same kind (interoids, exteroids or conturoids) that begins with the column
+        int runEnd = column + 1;
+        bool isUniform = column < width && (pixels[column] == INTEROID || pixels[column] == EXTEROID);
+
+        while (runEnd < width && (isUniform ? pixels[runEnd] == pixels[column] : pixels[runEnd] != INTEROID && pixels[runEnd] != EXTEROID))
+        {
+            runEnd++;
+        }
 
-        if (i == _pointCount - 1)
+        //a short run of interoids or exteroids is a part of the span of conturoids around it
+        if (column < width && (!isUniform || runEnd - column < MIN_SPAN_RUN))
         {
-            x2 = _x_coordinates[0];
-            y2 = _y_coordinates[0];
+            if (pixels[column] != EXTEROID)
+            {
+                if (mixedBegin == -1)
+                {
+                    mixedBegin = column;
+                }
+
+                mixedEnd = runEnd;
+            }
         }
+        //(STATE) a long run of interoids or exteroids, or the end of the row
         else
         {
-            x2 = _x_coordinates[i + 1];
-            y2 = _y_coordinates[i + 1];
+            int interiorBegin = column;
+
+            if (mixedBegin != -1)
+            {
+                /* (NOTE) the span is extended to whole groups of pixels over the long run (which becomes shorter) - CompositeSpan doesn't
+                   change its exteroids, and gives its interoids their color */
+                int end = mixedBegin + (((mixedEnd - mixedBegin) + SPAN_GROUP - 1) / SPAN_GROUP) * SPAN_GROUP;
+                end = end < runEnd ? end : runEnd;
+                end = end < width ? end : width;
+
+                CoverageSpan* span = &_context->Spans[_context->NumberOfSpans++];
+                span->Begin = mixedBegin;
+                span->End = end;
+                span->IsInterior = false;
+                mixedBegin = -1;
+                interiorBegin = end > column ? end : column;
+            }
+
+            if (column < width && pixels[column] == INTEROID && interiorBegin < runEnd)
+            {
+                CoverageSpan* span = &_context->Spans[_context->NumberOfSpans++];
+                span->Begin = interiorBegin;
+                span->End = runEnd;
+                span->IsInterior = true;
+            }
         }
 
-        signedArea += x1 * y2 - x2 * y1;
+        column = runEnd;
     }
 
-    return signedArea < 0;
+    _context->RowSpans[_row + 1] = _context->NumberOfSpans;
 }
 
 //(PRIVATE)
 //(LOCAL-TO DrawCharacter)
-/* returns the length of quadratic Bezier curve; the computed length can be relatively precise, even extremely precise (0.0001%) if the curve
-   isn't too curved, but in case that is too curved, the calculation will be less precise - but even in that case the error is no more than 1%;
-   in reality glyphs with such curves are either probably very rare in reality or does not exist at all */
-double LengthOfBezierCurve(double _beginPointX, double _beginPointY, double _controlPointX, double _controlPointY, double _endPointX, double _endPointY)
+/* (RE_SAMPLEX) determines the coverage of every pixel of the meta-canvas from (its coverage in MetaCanvas_S1) and (the winding numbers of
+   the rows - see RowWindings), and writes it in MetaCanvas_S2 (and its spans - see AddCoverageSpans); the interior is determined with the
+   nonzero winding rule, so the contours can intersect themselves or overlap each other, and their order and orientation don't matter; the
+   cells of the context are the last crossing of every row (see AccumulateWinding), followed by the winding numbers of three rows (the
+   previous, the current and the next) */
+void SamplexFill(tt_RasterContext* _context)
 {
-    double length = 0.0;
-    double previousPointX = _beginPointX;
-    double previousPointY = _beginPointY;
+    int stride = _context->MetaCanvasWidth + 1;
 
-    double a = _controlPointX - _beginPointX;
-    double b = _controlPointY - _beginPointY;
-    double d = _endPointX - _controlPointX;
-    double e = _endPointY - _controlPointY;
+    //the winding numbers of the previous, the current and the next row
+    int* windings[3] = { &_context->Cells[_context->MetaCanvasHeight], &_context->Cells[_context->MetaCanvasHeight + stride],
+                         &_context->Cells[_context->MetaCanvasHeight + (stride * 2)] };
 
-    for (double percentage = 0.0; percentage <= 100.0; percentage += 0.5/*200 steps*/)
+    RowWindings(_context, 0, windings[1]);
+
+    for (int row = 0; row < _context->MetaCanvasHeight; row++)
     {
-        double p1_C_Interpolation_X = _beginPointX + ((a / 100.0) * percentage);
-        double p1_C_Interpolation_Y = _beginPointY + ((b / 100.0) * percentage);
-        double C_p2_Interpolation_X = _controlPointX + ((d / 100.0) * percentage);
-        double C_p2_Interpolation_Y = _controlPointY + ((e / 100.0) * percentage);
-        double x = p1_C_Interpolation_X + (((C_p2_Interpolation_X - p1_C_Interpolation_X) / 100.0) * percentage);
-        double y = p1_C_Interpolation_Y + (((C_p2_Interpolation_Y - p1_C_Interpolation_Y) / 100.0) * percentage);
+        if (row < _context->MetaCanvasHeight - 1)
+        {
+            RowWindings(_context, row + 1, windings[2]);
+        }
+
+        int* cells = windings[1];
+        int* lowerCells = row > 0 ? windings[0] : NULL;
+        int* upperCells = row < _context->MetaCanvasHeight - 1 ? windings[2] : NULL;
+
+        for (int column = 0; column < _context->MetaCanvasWidth; column++)
+        {
+            int position = row * _context->MetaCanvasWidth + column;
+            unsigned int coverage = _context->MetaCanvas_S1[position];
+            _context->MetaCanvas_S1[position] = 0;
+
+            int winding = cells[column];
+
+            if (coverage == 0)
+            {
+                _context->MetaCanvas_S2[position] = winding != 0 ? INTEROID : EXTEROID;
+                continue;
+            }
+
+            //the winding numbers of the centers of the side neighbours of the pixel, followed by the winding numbers of its corner neighbours
+            int neighbours[8] =
+            {
+                column > 0 ? cells[column - 1] : 0,
+                cells[column + 1],
+                lowerCells != NULL ? lowerCells[column] : 0,
+                upperCells != NULL ? upperCells[column] : 0,
+                lowerCells != NULL && column > 0 ? lowerCells[column - 1] : 0,
+                lowerCells != NULL ? lowerCells[column + 1] : 0,
+                upperCells != NULL && column > 0 ? upperCells[column - 1] : 0,
+                upperCells != NULL ? upperCells[column + 1] : 0
+            };
+
+            /* the coverage is the area of the pixel on the right side of the contour, where the winding number is greater by 1 than on its
+               left side, so the winding numbers of both sides are known from the side of the center of the pixel - the center is on the
+               right side if a neighbour has a winding number smaller by 1, and on the left side if a neighbour has a winding number greater
+               by 1 (the side neighbours are closer, so they are checked before the corner neighbours); if neither or both are true (a
+               corner, a thin part or a crossing of the contours in the pixel), the center is on the side that covers the larger part of the
+               pixel, as with a single line */
+            bool isCenterOnRightSide = coverage > FULL_COVERAGE / 2;
+
+            for (int first = 0; first < 8; first += 4)
+            {
+                bool hasSmallerNeighbour = false;
+                bool hasGreaterNeighbour = false;
+
+                for (int i = first; i < first + 4; i++)
+                {
+                    hasSmallerNeighbour = hasSmallerNeighbour || neighbours[i] == winding - 1;
+                    hasGreaterNeighbour = hasGreaterNeighbour || neighbours[i] == winding + 1;
+                }
+
+                if (hasSmallerNeighbour != hasGreaterNeighbour)
+                {
+                    isCenterOnRightSide = hasSmallerNeighbour;
+                    break;
+                }
+            }
+
+            int rightSideWinding = isCenterOnRightSide ? winding : winding + 1;
+            int leftSideWinding = rightSideWinding - 1;
+
+            //every side is in the interior if its winding number is not 0
+            coverage = (rightSideWinding != 0 ? coverage : 0) + (leftSideWinding != 0 ? FULL_COVERAGE - coverage : 0);
 
-        double smallerX = previousPointX < x ? previousPointX : x;
-        double largerX = previousPointX > x ? previousPointX : x;
-        double smallerY = previousPointY < y ? previousPointY : y;
-        double largerY = previousPointY > y ? previousPointY : y;
-        double side1 = largerX - smallerX;
-        double side2 = largerY - smallerY;
-        length += sqrt((side1 * side1) + (side2 * side2));
+            _context->MetaCanvas_S2[position] = coverage;
+        }
+
+        AddCoverageSpans(_context, row);
+
+        //the next row becomes the current row
+        int* previousRow = windings[0];
+        windings[0] = windings[1];
+        windings[1] = windings[2];
+        windings[2] = previousRow;
+    }
 
-        previousPointX = x;
-        previousPointY = y;
+    //(NOTE) the cells of the rows are cleared by RowWindings
+    for (int i = 0; i < stride * 3; i++)
+    {
+        _context->Cells[_context->MetaCanvasHeight + i] = 0;
     }
 
-    return length;
+    _context->NumberOfCrossings = 0;
+}
+
+//(PRIVATE)
+//(LOCAL-TO FlattenContours)
+//returns a coordinate of the point of a quadratic Bezier curve at _t (0.0 :: the begin point | 1.0 :: the end point)
+double PointOfBezierCurve(double _begin, double _control, double _end, double _t)
+{
+    double t_ = 1.0 - _t;
+    return (t_ * t_ * _begin) + (2.0 * t_ * _t * _control) + (_t * _t * _end);
 }
 
 //_fontSize is specified in pixels
@@ -1914,1055 +2332,1135 @@ tt_Rectangle GetEnclosingRectangle(const Contour* _contour)
 }
 
 //(PRIVATE)
-//(LOCAL-TO DrawCharacter)
-unsigned char GetColorComponent(unsigned char _backgroundColorComponent, unsigned char _foregroundColorComponent, int _transparency)
+//(LOCAL-TO FlattenContours)
+/* the number of lines that replace a quadratic Bezier curve, so that no line is farther than FLATNESS from the curve; the distance between
+   the curve and its chord is at most |P0 - 2 * P1 + P2| / 4, and dividing the curve in N (equal by parameter) parts divides it by N * N */
+int NumberOfBezierLines(double _beginPointX, double _beginPointY, double _controlPointX, double _controlPointY, double _endPointX, double _endPointY)
 {
-    if (_backgroundColorComponent == _foregroundColorComponent)
+    double dx = _beginPointX - (2.0 * _controlPointX) + _endPointX;
+    double dy = _beginPointY - (2.0 * _controlPointY) + _endPointY;
+    double distance = sqrt((dx * dx) + (dy * dy)) / 4.0;
+
+    if (distance <= FLATNESS)
     {
-        return _backgroundColorComponent;
+        return 1;
     }
 
-    int larger = _backgroundColorComponent > _foregroundColorComponent ? _backgroundColorComponent : _foregroundColorComponent;
-    int smaller = _backgroundColorComponent < _foregroundColorComponent ? _backgroundColorComponent : _foregroundColorComponent;
+    return ceil(sqrt(distance / FLATNESS));
+}
+
+//(PRIVATE)
+//(LOCAL-TO AnalyticFill)
+/* adds the line to the accumulation buffer of the context - in every row crossed by the line, the pixels touched by the line get the part of the
+   (vertical extent of the line in the row) that is on their right side, and the pixel after them gets the rest of it (the cover); the sum
+   of a row from its beginning to a pixel is the signed area of the pixel covered by the contours; the coordinates are in pixels within
+   the meta-canvas; _stride is the number of elements per row */
+void AccumulateLine(tt_RasterContext* _context, int _stride, int _firstRow, double _beginX, double _beginY, double _endX, double _endY)
+{
+    //horizontal lines don't cover anything
+    if (_beginY == _endY)
+    {
+        return;
+    }
 
-    unsigned char difference = larger - smaller;
+    double direction = 1.0;
 
-    if (_foregroundColorComponent > _backgroundColorComponent)
+    if (_beginY > _endY)
     {
-        return _foregroundColorComponent - ((difference / 100.0) * _transparency);
+        double x = _beginX;
+        double y = _beginY;
+        _beginX = _endX;
+        _beginY = _endY;
+        _endX = x;
+        _endY = y;
+        direction = -1.0;
     }
-    else
+
+    double slope = (_endX - _beginX) / (_endY - _beginY);
+    double x = _beginX;
+    int endRow = ceil(_endY);
+
+    if (endRow > _firstRow + _context->MetaCanvasHeight)
     {
-        return _foregroundColorComponent + ((difference / 100.0) * _transparency);
+        endRow = _firstRow + _context->MetaCanvasHeight;
     }
-}
 
-//(PUBLIC)
-/* _characterIndex is a Unicode codepoint if it's a positive value, and glyph index (within the given font file) if it's a negative value;
-  the function is non-validating - if _characterIndex is a Unicode codepoint, then it must be a valid Unicode codepoint and if
-  _characterIndex is a glyph index, then it must be an index within the valid for the specific font range */
-//_glyph is a Parser::SimpleGlyph or Parser::CompositeGlyph object; if this parameter is used, then _characterIndex is ignored
-//_canvas is (a RGBA or BGRA pixel array) in which the character is drawn
-//Y_Direction specifies the direction in which the Y-coordinates grow (top-to-bottom or bottom-up)
-//_colorComponentOrder specifies if the pixels in _canvas are RGBA or BGRA
-//_canvasWidth and _canvasHeight are the width and height of the canvas(i.e. _canvas) specified in pixels
-//_horizontalPosition specifies the position (in pixels) of the left border of the EM-square; it can be negative or positive value
-//_verticalPosition specifies the position (in pixels) of the baseline in the canvas; it can be negative or positive value
-//_fontSize is the height of the line (not the actual character) in pixels
-//_numberOfColors should be equal (or larger) to the number of elements in _colors
-//_transparency = 0 means fully opaque string, and 100 means fully transparent string
-/*_maxGraphemicX specifies a limiting X coordinate in the canvas (not an X coordinate in the string itself) - i.e. the part of the
-   character after this coordinate will not be visualized; a value of -1 specifies that there is no horizontal limit;
-   this coordinate is inclusive, i.e. the column matching the coordinate will also be visualized */
-/* (!!!) this is a non-validating function; the font must contain the glyph that is represented by the specified _characterIndex
-         value (if set) and the parameters must have correct values */
-void DrawCharacter(
-        int _characterIndex,
-        void* _glyph,
-        const Font* _font,
-        unsigned char* _canvas,
-        ColorComponentOrder _colorComponentOrder,
-        int _canvasWidth,
-        int _canvasHeight,
-        double _horizontalPosition,
-        double _verticalPosition,
-        double _fontSize,
-        GlyphColorizationMode _colorizationMode,
-        const tt_rgba* _colors,
-        int _numberOfColors,
-        int _transparency,
-        int _maxGraphemicX,
-        double _composite_X_Offset, //(INTERNAL)
-        double _composite_Y_Offset, //(INTERNAL)
-        double _composite_X_Scale, //(INTERNAL)
-        double _composite_Y_Scale) //(INTERNAL)
-{
-    double SCALE = GetScale(_font, _fontSize);
-
-    void* glyph;
-
-    //if the function receives a glyph, and not (an Unicode codepoint) or (glyph index)
-    if (_glyph != NULL)
-    {
-        glyph = _glyph;
-    }
-        //ако &_characterIndex is an Unicode codepoint
-    else if (_characterIndex > 0)
-    {
-        glyph = GetGlyph(_font, _characterIndex);
-    }
-        //(STATE) _characterIndex is a glyph index (in the table 'glyf')
-    else
+    for (int row = (int) _beginY; row < endRow; row++)
     {
-        GLYF_Table* glyf = (GLYF_Table*) GetTable(_font, GLYF_TABLE);
-        glyph = glyf->Glyphs[0 - _characterIndex];
-    }
+        double rowHeight = SmallerOf(row + 1, _endY) - LargerOf(row, _beginY);
+        double nextX = x + (slope * rowHeight);
+        double cover = rowHeight * direction;
 
-    ///IF THE GLYPH IS EMPTY (NON-CONTOUR GLYPH)
-    if (Is(glyph, EMPTY_GLYPH))
-    {
-        return;
-    }
-        ///IF THE GLYPH IS SIMPLE
-    else if (Is(glyph, SIMPLE_GLYPH))
-    {
-        SimpleGlyph* glyph_ = (SimpleGlyph*) glyph;
+        //(NOTE) the rows before the band are only passed, so the line crosses the rows of the band at the same places in every band
+        if (row < _firstRow)
+        {
+            x = nextX;
+            continue;
+        }
+
+        float* line = &_context->Accumulation[(row - _firstRow) * _stride];
 
-        int lsb;
+        double x1 = SmallerOf(x, nextX);
+        double x2 = LargerOf(x, nextX);
+        int column1 = (int) x1;
+        int column2 = ceil(x2);
 
-        if (_glyph != NULL)
+        //the line is within one pixel of the row
+        if (column2 <= column1 + 1)
         {
-            lsb = glyph_->MinX; //(C)
+            double middle = ((x + nextX) / 2.0) - column1;
+            line[column1] += cover * (1.0 - middle);
+            line[column1 + 1] += cover * middle;
         }
         else
         {
-            lsb = GetLeftSideBearing(_font, _characterIndex);
-        }
-
-        ///CONTOUR REORDERING
+            double inverseWidth = 1.0 / (x2 - x1);
+            double fraction1 = x1 - column1;
+            double area1 = 0.5 * inverseWidth * (1.0 - fraction1) * (1.0 - fraction1);
+            double fraction2 = x2 - column2 + 1.0;
+            double area2 = 0.5 * inverseWidth * fraction2 * fraction2;
 
-        int numberOfContours = glyph_->NumberOfContours;
-        int numberOfRealContours = 0; //(E) it's needed because there are contours with one point
-        Contour* unorderedContours = malloc(sizeof(Contour) * numberOfContours);
-        Contour* orderedContours = malloc(sizeof(Contour) * numberOfContours);
-
-        //for every contour
-        for (int contourIndex = 0, nonEmptyContourCount = 0; contourIndex < numberOfContours; contourIndex++)
-        {
-            int numberOfPoints = contourIndex > 0 ? glyph_->EndPointsOfContours[contourIndex] - glyph_->EndPointsOfContours[contourIndex - 1] : glyph_->EndPointsOfContours[0] + 1;
+            line[column1] += cover * area1;
 
-            /* (E) it's possible that a contour contains only one point;
-               (SOURCE) https://github.com/MicrosoftDocs/typography-issues/issues/720?) */
-            if (numberOfPoints == 1)
+            if (column2 == column1 + 2)
             {
-                continue;
+                line[column1 + 1] += cover * (1.0 - area1 - area2);
             }
-
-            int indexOfFirstPoint = contourIndex > 0 ? glyph_->EndPointsOfContours[contourIndex - 1] + 1 : 0;
-
-            Contour* contour = &unorderedContours[nonEmptyContourCount++];
-            contour->X_Coordinates = malloc(sizeof(short) * numberOfPoints);
-            contour->Y_Coordinates = malloc(sizeof(short) * numberOfPoints);
-            contour->Flags = malloc(sizeof(unsigned char) * numberOfPoints);
-            copy_short(glyph_->X_Coordinates, contour->X_Coordinates, numberOfPoints, indexOfFirstPoint, 0, numberOfPoints);
-            copy_short(glyph_->Y_Coordinates, contour->Y_Coordinates, numberOfPoints, indexOfFirstPoint, 0, numberOfPoints);
-            copy_uchar(glyph_->Flags, contour->Flags, numberOfPoints, indexOfFirstPoint, 0, numberOfPoints);
-            contour->NumberOfPoints = numberOfPoints;
-            contour->OriginalIndex = contourIndex;
-            contour->IsFilled = IsFilledContour(contour->X_Coordinates, contour->Y_Coordinates, numberOfPoints);
-
-            //(POSSIBLE-CASE)
-            if (numberOfContours == 1 && !contour->IsFilled)
+            else
             {
-                contour->IsFilled = true;
-                reverse_short(contour->X_Coordinates, numberOfPoints);
-                reverse_short(contour->Y_Coordinates, numberOfPoints);
-                reverse_uchar(contour->Flags, numberOfPoints);
-            }
+                double area = inverseWidth * (1.5 - fraction1);
+                line[column1 + 1] += cover * (area - area1);
 
-            //value -1.0 for _composite_X_Scale is used with horizontally-mirrored characters
-            //value -1.0 for _composite_Y_Scale is used with vertically-mirrored characters
-            if (_composite_X_Scale != 0.0 || _composite_Y_Scale != 0.0)
-            {
-                for (int i = 0; i < numberOfPoints; i++)
+                for (int column = column1 + 2; column < column2 - 1; column++)
                 {
-                    contour->X_Coordinates[i] = (_composite_X_Scale < 0 ? _composite_X_Offset : 0) + (contour->X_Coordinates[i] * _composite_X_Scale);
-                    contour->Y_Coordinates[i] = (_composite_Y_Scale < 0 ? _composite_Y_Offset : 0) + (contour->Y_Coordinates[i] * _composite_Y_Scale);
+                    line[column] += cover * inverseWidth;
                 }
 
-                if ((_composite_X_Scale < 0.0 && _composite_Y_Scale >= 0.0) || (_composite_X_Scale >= 0.0 && _composite_Y_Scale < 0.0))
-                {
-                    reverse_short(contour->X_Coordinates, numberOfPoints);
-                    reverse_short(contour->Y_Coordinates, numberOfPoints);
-                    reverse_uchar(contour->Flags, numberOfPoints);
-                }
+                area += (column2 - column1 - 3) * inverseWidth;
+                line[column2 - 1] += cover * (1.0 - area - area2);
             }
 
-            numberOfRealContours++;
+            line[column2] += cover * area2;
         }
 
-        numberOfContours = numberOfRealContours;
+        x = nextX;
+    }
+}
+
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+/* (RE_ANALYTIC) determines the coverage of every pixel in MetaCanvas_S2 (and its spans) - the same result as the samplex engine produces at
+   the end of stage 1; the coverage is the absolute value of the accumulated area (limited to 1.0), so holes (contours with the opposite
+   direction) are subtracted and overlapping contours are merged; the order of the edges does not matter; _fx_shift and _fy_shift are the
+   subpixel shift of the position of the glyph; the meta-canvas is the band of rows that begins with the row _firstRow of the glyph */
+void AnalyticFill(tt_RasterContext* _context, const EdgeList* _edgeList, double _fx_shift, double _fy_shift, int _firstRow)
+{
+    //the line that ends in the last column can add cover to the pixel after it
+    int stride = _context->MetaCanvasWidth + 1;
+    int size = stride * _context->MetaCanvasHeight;
+
+    if (size > _context->AccumulationCapacity)
+    {
+        free(_context->Accumulation);
+        _context->AccumulationCapacity = size > _context->AccumulationCapacity * 2 ? size : _context->AccumulationCapacity * 2;
+        _context->Accumulation = calloc(_context->AccumulationCapacity, sizeof(float));
+    }
 
-        int F_Contours_Count = 0;
+    for (int i = 0; i < _edgeList->NumberOfEdges; i++)
+    {
+        const Edge* edge = &_edgeList->Edges[i];
 
-        for (int i = 0; i < numberOfContours; i++)
+        //the edge is not in the band
+        if (LargerOf(edge->BeginY, edge->EndY) + _fy_shift <= _firstRow ||
+            SmallerOf(edge->BeginY, edge->EndY) + _fy_shift >= _firstRow + _context->MetaCanvasHeight)
         {
-            if (unorderedContours[i].IsFilled)
-            {
-                F_Contours_Count++;
-            }
+            continue;
         }
 
-        int N_Contours_Count = numberOfContours - F_Contours_Count;
-        int orderedContoursCount = 0;
+        AccumulateLine(_context, stride, _firstRow, edge->BeginX + _fx_shift, edge->BeginY + _fy_shift, edge->EndX + _fx_shift,
+                       edge->EndY + _fy_shift);
+    }
 
-        if (F_Contours_Count == 1 && N_Contours_Count >= 0)
-        {
-            for (int i = 0; i < numberOfContours; i++)
-            {
-                if (unorderedContours[i].IsFilled)
-                {
-                    orderedContours[0] = unorderedContours[i];
-                    break;
-                }
-            }
+    //accumulating the rows; the accumulation buffer is cleared for the next glyph
+    for (int row = 0; row < _context->MetaCanvasHeight; row++)
+    {
+        float* line = &_context->Accumulation[row * stride];
+        unsigned char* pixels = &_context->MetaCanvas_S2[row * _context->MetaCanvasWidth];
+        double area = 0.0;
 
-            for (int i = 0, n = 1; i < numberOfContours; i++)
-            {
-                if (!unorderedContours[i].IsFilled)
-                {
-                    orderedContours[n++] = unorderedContours[i];
-                }
-            }
-        }
-        else if (F_Contours_Count > 1 && N_Contours_Count == 0)
-        {
-            orderedContours = unorderedContours;
-        }
-            //(STATE) F_Contours_Count >= 2 && N_Contours_Count >= 2; a reordering of the contours must be performed
-        else
+        for (int column = 0; column < _context->MetaCanvasWidth; column++)
         {
-            //the first element of the pair is a contour, and the second element is his 'direct' container contour
-            ContourPair* contourPairs = malloc(sizeof(ContourPair) * numberOfContours);
+            area += line[column];
+            line[column] = 0.0f;
 
-            for (int i = 0; i < numberOfContours; i++)
-            {
-                contourPairs[i].Contour = NULL;
-                contourPairs[i].DirectContainer = NULL;
-            }
+            //(NOTE) 0 is an exteroid and FULL_COVERAGE is an interoid
+            pixels[column] = (SmallerOf(Absolute(area), 1.0) * FULL_COVERAGE) + 0.5;
+        }
 
-            //determine the closest enclosing rectangles for every contour
-            for (int i = 0; i < numberOfContours; i++)
-            {
-                //determine the direct container contour for &__contour
+        line[_context->MetaCanvasWidth] = 0.0f;
+        AddCoverageSpans(_context, row);
+    }
+}
 
-                Contour* contour = &unorderedContours[i];
-                tt_Rectangle rectangle = GetEnclosingRectangle(contour);
-                int directArea = -1;
-                Contour* directContainer = NULL;
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+//converts a position (in pixels) to 24.8 fixed point; the value is rounded to the nearest 1/256 of a pixel
+int FixedOf(double _value)
+{
+    double value = _value * 256.0;
+    return value >= 0.0 ? (int) (value + 0.5) : -((int) (-value + 0.5));
+}
 
-                for (int n = 0; n < numberOfContours; n++)
-                {
-                    Contour* contour_ = &unorderedContours[n];
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+//the integer part (rounded down) of a 24.8 fixed point value
+int FixedFloor(int _value)
+{
+    return _value >= 0 ? _value / 256 : -((-_value + 255) / 256);
+}
 
-                    if (contour != contour_)
-                    {
-                        tt_Rectangle rectangle_ = GetEnclosingRectangle(contour_);
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+//scales a value in font units with a 16.16 scale; the result is in 24.8 fixed point, rounded to the nearest value
+int ScaleToFixed(int _value, int _scale)
+{
+    long long value = (long long) _value * _scale;
+    return value >= 0 ? (value + 128) / 256 : -((-value + 128) / 256);
+}
 
-                        if (RectangleContainsRectangle(&rectangle_, &rectangle))
-                        {
-                            if (directContainer == NULL)
-                            {
-                                directContainer = contour_;
-                                directArea = rectangle_.Width * rectangle_.Height;
-                            }
-                            else
-                            {
-                                int area_ = rectangle_.Width * rectangle_.Height;
+//(PRIVATE)
+//(LOCAL-TO FlattenContours)
+//the same as ScaleToFixed, for a value in half units of the font (see PreparedGlyph)
+int ScaleHalfUnitsToFixed(int _value, int _scale)
+{
+    long long value = (long long) _value * _scale;
+    return value >= 0 ? (value + 256) / 512 : -((-value + 256) / 512);
+}
 
-                                if (area_ < directArea)
-                                {
-                                    directArea = area_;
-                                    directContainer = contour_;
-                                }
-                            }
-                        }
-                    }
-                }
+//(PRIVATE)
+//(LOCAL-TO FixedFill)
+/* adds a part of a line within one row; the X coordinates are 24.8 fixed point values in the meta-canvas, and the Y coordinates are
+   (24.8) values within the row (0..256); every pixel gets the vertical extent of the part within it (the cover) and the cover multiplied by
+   the doubled average horizontal position of the part within the pixel (the area) */
+void AccumulateFixedRow(tt_RasterContext* _context, int _stride, int _row, int _beginX, int _beginY, int _endX, int _endY)
+{
+    if (_beginY == _endY)
+    {
+        return;
+    }
 
-                contourPairs[i].Contour = contour;
-                contourPairs[i].DirectContainer = directContainer;
-            }
+    int* cells = &_context->Cells[_row * _stride * 2];
+    int beginColumn = _beginX / 256;
+    int endColumn = _endX / 256;
 
-            //adding the (contours with no containers) to &orderedContours
+    //the part is within one pixel
+    if (beginColumn == endColumn)
+    {
+        cells[beginColumn * 2] += _endY - _beginY;
+        cells[(beginColumn * 2) + 1] += (_endY - _beginY) * ((_beginX - (beginColumn * 256)) + (_endX - (beginColumn * 256)));
+        return;
+    }
 
-            for (int i = 0; i < numberOfContours; i++)
-            {
-                ContourPair* contourPair = &contourPairs[i];
+    long long width = _endX - _beginX;
+    long long height = _endY - _beginY;
+    int direction = width > 0 ? 1 : -1;
+    int x = _beginX;
+    int y = _beginY;
 
-                if (contourPair->DirectContainer == NULL)
-                {
-                    orderedContours[orderedContoursCount++] = *((Contour*) contourPair->Contour);
-                }
-            }
+    //(NOTE) if the part begins on the left edge of a pixel and goes to the left, the first (empty) piece is in that pixel
+    for (int column = beginColumn; ; column += direction)
+    {
+        int left = column * 256;
+        int nextX = column == endColumn ? _endX : direction > 0 ? left + 256 : left;
+        int nextY = column == endColumn ? _endY : _beginY + (int) ((height * (nextX - _beginX)) / width);
 
-            //inserting the (contours which have containers) after the corresponding container contour
+        cells[column * 2] += nextY - y;
+        cells[(column * 2) + 1] += (nextY - y) * ((x - left) + (nextX - left));
 
-            for (int i = 0; i < numberOfContours; i++)
-            {
-                ContourPair* pair = &contourPairs[i];
+        if (column == endColumn)
+        {
+            break;
+        }
 
-                if (pair->DirectContainer != NULL)
-                {
-                    int containerIndex = -1;
+        x = nextX;
+        y = nextY;
+    }
+}
 
-                    for (int n = 0; n < orderedContoursCount; n++)
-                    {
-                        if (orderedContours[n].OriginalIndex == ((Contour*) pair->DirectContainer)->OriginalIndex)
-                        {
-                            containerIndex = n;
-                        }
-                    }
+//(PRIVATE)
+//(LOCAL-TO FixedFill)
+//(RE_FIXED) the coordinates are 24.8 fixed point values in the meta-canvas
+void AccumulateFixedLine(tt_RasterContext* _context, int _stride, int _firstRow, int _beginX, int _beginY, int _endX, int _endY)
+{
+    //horizontal lines don't cover anything
+    if (_beginY == _endY)
+    {
+        return;
+    }
 
-                    for (int i = 0; i < orderedContoursCount; i++)
-                    {
-                        if (orderedContours->OriginalIndex == ((Contour*) pair->DirectContainer)->OriginalIndex)
-                        {
-                            containerIndex = i;
-                            break;
-                        }
-                    }
+    int beginRow = _beginY / 256;
+    int endRow = _endY / 256;
+    long long width = _endX - _beginX;
+    long long height = _endY - _beginY;
+    int direction = height > 0 ? 1 : -1;
+    int x = _beginX;
+    int y = _beginY;
 
-                    if (containerIndex != -1 && containerIndex < orderedContoursCount - 1)
-                    {
-                        insert(orderedContours, numberOfContours, pair->Contour, containerIndex + 1);
-                    }
-                    else
-                    {
-                        orderedContours[orderedContoursCount] = *((Contour*) pair->Contour);
-                    }
+    for (int row = beginRow; ; row += direction)
+    {
+        int bottom = row * 256;
+        int nextY = row == endRow ? _endY : direction > 0 ? bottom + 256 : bottom;
+        int nextX = row == endRow ? _endX : _beginX + (int) ((width * (nextY - _beginY)) / height);
 
-                    orderedContoursCount++;
-                }
-            }
+        if (row >= _firstRow && row < _firstRow + _context->MetaCanvasHeight)
+        {
+            AccumulateFixedRow(_context, _stride, row - _firstRow, x, y - bottom, nextX, nextY - bottom);
+        }
 
-            free(contourPairs);
+        if (row == endRow)
+        {
+            break;
         }
 
-        Bitex enteringSamplex;
-        enteringSamplex.X = 0.0;
-        enteringSamplex.Y = 0.0; //the entering samplex for a pixel
+        x = nextX;
+        y = nextY;
+    }
+}
 
-        Bitex implicitPoint;
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+/* (RE_FIXED) the same as AnalyticFill, but with integer arithmetic only; _fixedShiftX and _fixedShiftY are the (24.8) fractional parts of the
+   position of the glyph */
+void FixedFill(tt_RasterContext* _context, const EdgeList* _edgeList, int _fixedShiftX, int _fixedShiftY, int _firstRow)
+{
+    //a line that ends on the right edge of the last column adds an empty piece to the pixel after it
+    int stride = _context->MetaCanvasWidth + 1;
+    ReserveCells(_context, stride * _context->MetaCanvasHeight * 2);
 
-        ///
+    for (int i = 0; i < _edgeList->NumberOfEdges; i++)
+    {
+        const FixedEdge* edge = &_edgeList->FixedEdges[i];
 
-        //(D) modifying the coordinates, so that the coordinate arrays won't have any negative values
+        //the edge is not in the band
+        if ((edge->BeginY > edge->EndY ? edge->BeginY : edge->EndY) + _fixedShiftY <= _firstRow * 256 ||
+            (edge->BeginY < edge->EndY ? edge->BeginY : edge->EndY) + _fixedShiftY >= (_firstRow + _context->MetaCanvasHeight) * 256)
+        {
+            continue;
+        }
 
-        /* the lowest values are determined by taking in consideration the contours in &orderedContours, and not
-           glyph_->Contours, as glyph_->Contours contains the original coordinates, which are potentially modified at this point
-           because of _composite_X_Scale/_composite_Y_Scale */
+        AccumulateFixedLine(_context, stride, _firstRow, edge->BeginX + _fixedShiftX, edge->BeginY + _fixedShiftY,
+                            edge->EndX + _fixedShiftX, edge->EndY + _fixedShiftY);
+    }
 
-        int lowestX = INT_MAX;
-        int lowestY = INT_MAX;
-        int highestX = INT_MIN;
-        int highestY = INT_MIN;
+    /* accumulating the rows; the (doubled) area of a pixel covered by the contours is the sum of the covers up to the pixel (including
+       it) multiplied by 2 * 256, minus the area of the pixel; a fully covered pixel has 2 * 256 * 256; the cells are cleared for the next
+       glyph */
+    for (int row = 0; row < _context->MetaCanvasHeight; row++)
+    {
+        int* cells = &_context->Cells[row * stride * 2];
+        unsigned char* pixels = &_context->MetaCanvas_S2[row * _context->MetaCanvasWidth];
+        int cover = 0;
 
-        for (int contourIndex = 0; contourIndex < numberOfContours; contourIndex++)
+        for (int column = 0; column < _context->MetaCanvasWidth; column++)
         {
-            Contour* contour = &orderedContours[contourIndex];
+            cover += cells[column * 2];
+            int area = (cover * 512) - cells[(column * 2) + 1];
+            cells[column * 2] = 0;
+            cells[(column * 2) + 1] = 0;
 
-            for (int pointIndex = 0; pointIndex < contour->NumberOfPoints; pointIndex++)
+            if (area < 0)
             {
-                int x_point = contour->X_Coordinates[pointIndex];
-                int y_point = contour->Y_Coordinates[pointIndex];
-
-                if (x_point < lowestX)
-                {
-                    lowestX = x_point;
-                }
+                area = -area;
+            }
 
-                if (y_point < lowestY)
-                {
-                    lowestY = y_point;
-                }
+            //(NOTE) 0 is an exteroid and FULL_COVERAGE is an interoid
+            pixels[column] = area >= 131072 ? FULL_COVERAGE : ((area * FULL_COVERAGE) + 65536) / 131072;
+        }
 
-                if (x_point > highestX)
-                {
-                    highestX = x_point;
-                }
+        cells[_context->MetaCanvasWidth * 2] = 0;
+        cells[(_context->MetaCanvasWidth * 2) + 1] = 0;
+        AddCoverageSpans(_context, row);
+    }
+}
 
-                if (y_point > highestY)
-                {
-                    highestY = y_point;
-                }
-            }
-        }
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+//prepares the scratch memory of the context for (up to) _size bytes; the memory allocated before (with ScratchAllocate) becomes invalid
+void ResetScratch(tt_RasterContext* _context, size_t _size)
+{
+    if (_size > _context->ScratchSize)
+    {
+        _context->ScratchSize = _size > _context->ScratchSize * 2 ? _size : _context->ScratchSize * 2;
+        free(_context->Scratch);
+        _context->Scratch = malloc(_context->ScratchSize);
+    }
 
-        if (lsb < 0)
-        {
-            _horizontalPosition += lsb * SCALE;
-        }
-        else
-        {
-            _horizontalPosition += lowestX * SCALE;
-        }
+    _context->ScratchUsage = 0;
+}
 
-        _verticalPosition += lowestY * SCALE;
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+//the returned memory is 8-byte aligned; the total size of the allocations (each rounded up to 8 bytes) must fit in the size given to ResetScratch
+void* ScratchAllocate(tt_RasterContext* _context, size_t _size)
+{
+    void* memory = _context->Scratch + _context->ScratchUsage;
+    _context->ScratchUsage += (_size + 7) & ~((size_t) 7);
+    return memory;
+}
 
-        double fx_shift = _horizontalPosition - RoundDown(_horizontalPosition);
-        double fy_shift = _verticalPosition - RoundDown(_verticalPosition);
-        /* (C) (t:SimpleGlyph : MinX, MinY, MaxX, MaxY) cannot be used here as there are errors (it seems) in some fonts - for example
-           yMin in (DejaVuSans index 3013) does not correspond to the real lowest Y value */
-        MetaCanvasWidth = RoundUp(((highestX - lowestX) * SCALE)) + 1;
-        MetaCanvasHeight = RoundUp((highestY - lowestY) * SCALE) + 1;
-        int size = MetaCanvasWidth * MetaCanvasHeight;
-        MetaCanvas_S1 = malloc(sizeof(unsigned int) * size);
-        MetaCanvas_S2 = malloc(sizeof(unsigned short) * size);
-        memset((void*) MetaCanvas_S1, 0, size * sizeof(unsigned int));
-        memset((void*) MetaCanvas_S2, 0, size * sizeof(unsigned short));
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+/* prepares the meta-canvases for _size pixels; MetaCanvas_S1 is zero-filled and it remains zero-filled after every glyph, while every pixel
+   of MetaCanvas_S2 is written by stage 1 */
+void ReserveMetaCanvas(tt_RasterContext* _context, int _size)
+{
+    if (_size > _context->MetaCanvasCapacity)
+    {
+        free(_context->MetaCanvas_S1);
+        free(_context->MetaCanvas_S2);
+        _context->MetaCanvasCapacity = _size > _context->MetaCanvasCapacity * 2 ? _size : _context->MetaCanvasCapacity * 2;
+        _context->MetaCanvas_S1 = calloc(_context->MetaCanvasCapacity, sizeof(unsigned char));
+        _context->MetaCanvas_S2 = malloc(_context->MetaCanvasCapacity);
+    }
+}
 
-        //for every contour
-        for (int contourIndex = 0; contourIndex < numberOfContours; contourIndex++)
-        {
-            PreviousPixelX = -1;
-            PreviousPixelY = -1;
+//(PRIVATE)
+//(LOCAL-TO FlattenContours)
+//the edges of the list are not allocated yet => the line is only counted (see BuildEdgeList)
+void AddEdge(EdgeList* _edgeList, double _beginX, double _beginY, double _endX, double _endY)
+{
+    //horizontal lines don't cover anything (but the samplex engine traces them)
+    if (_beginY == _endY && _edgeList->Entry.Key.Engine != RE_SAMPLEX)
+    {
+        return;
+    }
 
-            Contour* contour = &orderedContours[contourIndex];
-            int numberOfPoints = contour->NumberOfPoints;
+    if (_edgeList->Edges != NULL)
+    {
+        Edge* edge = &_edgeList->Edges[_edgeList->NumberOfEdges];
+        edge->BeginX = _beginX;
+        edge->BeginY = _beginY;
+        edge->EndX = _endX;
+        edge->EndY = _endY;
+    }
 
-            short* x_coordinates = contour->X_Coordinates;
-            short* y_coordinates = contour->Y_Coordinates;
-            unsigned char* flags = contour->Flags;
+    _edgeList->NumberOfEdges++;
+}
 
-            //(D)
-            for (int i = 0; i < numberOfPoints; i++)
-            {
-                x_coordinates[i] -= lowestX;
-                y_coordinates[i] -= lowestY;
-            }
+//(PRIVATE)
+//(LOCAL-TO FlattenContours)
+void AddBezierCurve(EdgeList* _edgeList, double _beginPointX, double _beginPointY, double _controlPointX, double _controlPointY,
+                    double _endPointX, double _endPointY)
+{
+    /* (NOTE) the curve is replaced by lines that are no farther than FLATNESS from it, so the number of lines depends on the curvature of
+       the curve and not on its length */
+    int numberOfLines = NumberOfBezierLines(_beginPointX, _beginPointY, _controlPointX, _controlPointY, _endPointX, _endPointY);
+    double previousX = _beginPointX;
+    double previousY = _beginPointY;
 
-            //(->)
+    for (int i = 1; i <= numberOfLines; i++)
+    {
+        double t = (double) i / numberOfLines;
+        double x = PointOfBezierCurve(_beginPointX, _controlPointX, _endPointX, t);
+        double y = PointOfBezierCurve(_beginPointY, _controlPointY, _endPointY, t);
 
-            /* (A) the coverage of the begin/end pixel P is determined at the end of the contour iteration, as the entering samplex
-                   is not known at the moment of exiting P; this variable stores the exiting samplex for the pixel, that will be
-                   used later in combination with the already determined entering samplex */
+        AddEdge(_edgeList, previousX, previousY, x, y);
 
-            Bitex beginPixelEnteringSamplex;
-            beginPixelEnteringSamplex.X = -1.0;
-            beginPixelEnteringSamplex.Y = -1.0;
-            Bitex beginPixelExitingSamplex;
-            beginPixelExitingSamplex.X = -1.0;
-            beginPixelExitingSamplex.Y = -1.0;
-            Bitex beginPixelNextSamplex;
-            beginPixelNextSamplex.X = -1.0;
-            beginPixelNextSamplex.Y = -1.0;
-
-            Bitex endSegmentoid;
-
-            int currentPixelMinX;
-            int currentPixelMaxX;
-            int currentPixelMinY;
-            int currentPixelMaxY;
-
-            double deltaX;
-            double deltaY;
-            double oldDeltaX;
-            double oldDeltaY;
-
-            //(L)
-
-            int beginIndex = INT_MAX;
-            int endIndex = INT_MAX;
+        previousX = x;
+        previousY = y;
+    }
+}
 
-            //if the first point of the contour is OFF (such cases are very rare, but they exist)
-            if (GetBit(flags[0], 0) == false)
-            {
-                /* as it is not certain whether the last point of the contour is ON, the position of the first ON point
-                   in the contour must be determined (i.e. the first point of the next segment); the (point before the first ON point) is
-                   the end point of the contour */
-                for (int i = 0; i < numberOfPoints - 2; i++)
-                {
-                    if (GetBit(flags[i], 0) == true)
-                    {
-                        beginIndex = i;
-                        endIndex = i - 1;
-                        break;
-                    }
-                }
+//(PRIVATE)
+//(LOCAL-TO FlattenContours)
+//(RE_FIXED) see AddEdge
+void AddFixedEdge(EdgeList* _edgeList, int _beginX, int _beginY, int _endX, int _endY)
+{
+    //horizontal lines don't cover anything
+    if (_beginY == _endY)
+    {
+        return;
+    }
 
-                /* there are cases in which the contour consists of only OFF points - this is a valid TrueType contour;
-                   in such cases a median OFF point is inserted between every OFF-point pair; after the modification
-                   the first point in the array is OFF, the second is ON, the third is OFF, fourth is ON and so on */
-                if (beginIndex == INT_MAX)
-                {
-                    short* extended_x_coordinates = malloc(sizeof(short) * numberOfPoints * 2);
-                    short* extended_y_coordinates = malloc(sizeof(short) * numberOfPoints * 2);
-                    unsigned char* extendedFlags = malloc(sizeof(unsigned char) * numberOfPoints * 2);
+    if (_edgeList->FixedEdges != NULL)
+    {
+        FixedEdge* edge = &_edgeList->FixedEdges[_edgeList->NumberOfEdges];
+        edge->BeginX = _beginX;
+        edge->BeginY = _beginY;
+        edge->EndX = _endX;
+        edge->EndY = _endY;
+    }
 
-                    //copying the coordinates and OFF points into the extended arrays
-                    for (int s = 0, t = 0; s < numberOfPoints; s++, t += 2)
-                    {
-                        extended_x_coordinates[t] = x_coordinates[s];
-                        extended_y_coordinates[t] = y_coordinates[s];
-                        extendedFlags[t] = flags[s];
-                    }
+    _edgeList->NumberOfEdges++;
+}
 
-                    //generating implicit ON points (plus flags for them) into the extended arrays
-                    for (int i = 1; i < numberOfPoints * 2; i += 2)
-                    {
-                        short previousX = extended_x_coordinates[i - 1];
-                        short previousY = extended_y_coordinates[i - 1];
+//(PRIVATE)
+//(LOCAL-TO FlattenContours)
+//(RE_FIXED) see AddBezierCurve and NumberOfBezierLines
+void AddFixedBezierCurve(EdgeList* _edgeList, int _beginPointX, int _beginPointY, int _controlPointX, int _controlPointY, int _endPointX,
+                         int _endPointY)
+{
+    long long dx = _beginPointX - (2 * _controlPointX) + _endPointX;
+    long long dy = _beginPointY - (2 * _controlPointY) + _endPointY;
+    long long distance = (dx * dx) + (dy * dy); //the square of (4 * the distance between the curve and its chord)
 
-                        short nextX = extended_x_coordinates[i < (numberOfPoints * 2) - 1 ? i + 1 : 0];
-                        short nextY = extended_y_coordinates[i < (numberOfPoints * 2) - 1 ? i + 1 : 0];
+    //the smallest number of lines N so that (the distance / (N * N)) <= FIXED_FLATNESS
+    long long numberOfLines = 1;
 
-                        Bitex implicitPoint = CentexOf(previousX, previousY, nextX, nextY);
+    while (distance > 16 * numberOfLines * numberOfLines * numberOfLines * numberOfLines * FIXED_FLATNESS * FIXED_FLATNESS)
+    {
+        numberOfLines++;
+    }
 
-                        extended_x_coordinates[i] = implicitPoint.X;
-                        extended_y_coordinates[i] = implicitPoint.Y;
-                        extendedFlags[i] = 1 /* only the first bit is important - to set the point as ON */;
-                    }
+    long long n2 = numberOfLines * numberOfLines;
+    int previousX = _beginPointX;
+    int previousY = _beginPointY;
 
-                    numberOfPoints *= 2;
+    for (long long i = 1; i <= numberOfLines; i++)
+    {
+        long long i_ = numberOfLines - i;
+        /* (NOTE) the coordinates are not negative, so the rounding is (+ N * N / 2); adding a (24.8) shift to the three points adds it
+           exactly to the computed point, so the subpixel shift can be added to the edges at drawing */
+        int x = (((i_ * i_ * _beginPointX) + (2 * i * i_ * _controlPointX) + (i * i * _endPointX)) + (n2 / 2)) / n2;
+        int y = (((i_ * i_ * _beginPointY) + (2 * i * i_ * _controlPointY) + (i * i * _endPointY)) + (n2 / 2)) / n2;
 
-                    free(x_coordinates);
-                    free(y_coordinates);
-                    free(flags);
-                    x_coordinates = extended_x_coordinates;
-                    y_coordinates = extended_y_coordinates;
-                    flags = extendedFlags;
+        AddFixedEdge(_edgeList, previousX, previousY, x, y);
 
-                    beginIndex = 1;
-                    endIndex = 0;
-                }
-            }
-            else
-            {
-                beginIndex = 0;
-                endIndex = numberOfPoints - 1;
-            }
+        previousX = x;
+        previousY = y;
+    }
+}
 
-            int beginContourPixelX = (x_coordinates[beginIndex] * SCALE) + fx_shift;
-            int beginContourPixelY = (y_coordinates[beginIndex] * SCALE) + fy_shift;
+//(PRIVATE)
+//(LOCAL-TO FlattenContours)
+//adds the line (_controlPoint = -1) or the quadratic Bezier curve between two ON points of the contour
+void AddSegment(EdgeList* _edgeList, const Contour* _contour, int _beginPoint, int _controlPoint, int _endPoint, int _fixedScale)
+{
+    const float* x_coordinates = _contour->X_Coordinates;
+    const float* y_coordinates = _contour->Y_Coordinates;
+    int lowestX = _edgeList->LowestX;
+    int lowestY = _edgeList->LowestY;
 
-            ///for every contour point
-            for (int contourPointIndex = beginIndex; ; contourPointIndex++)
-            {
-                ///(L)
+    if (_edgeList->Entry.Key.Engine == RE_FIXED)
+    {
+        //(NOTE) the coordinates are multiples of 0.5 (see PreparedGlyph), so they are exact in half units
+        int beginX = ScaleHalfUnitsToFixed((x_coordinates[_beginPoint] - lowestX) * 2, _fixedScale);
+        int beginY = ScaleHalfUnitsToFixed((y_coordinates[_beginPoint] - lowestY) * 2, _fixedScale);
+        int endX = ScaleHalfUnitsToFixed((x_coordinates[_endPoint] - lowestX) * 2, _fixedScale);
+        int endY = ScaleHalfUnitsToFixed((y_coordinates[_endPoint] - lowestY) * 2, _fixedScale);
 
-                if (endIndex < numberOfPoints - 1 && contourPointIndex == numberOfPoints)
-                {
-                    contourPointIndex = 0;
-                }
+        if (_controlPoint == -1)
+        {
+            AddFixedEdge(_edgeList, beginX, beginY, endX, endY);
+        }
+        else
+        {
+            int controlX = ScaleHalfUnitsToFixed((x_coordinates[_controlPoint] - lowestX) * 2, _fixedScale);
+            int controlY = ScaleHalfUnitsToFixed((y_coordinates[_controlPoint] - lowestY) * 2, _fixedScale);
+            AddFixedBezierCurve(_edgeList, beginX, beginY, controlX, controlY, endX, endY);
+        }
+    }
+    else
+    {
+        double scale = _edgeList->Entry.Key.Scale;
+        double beginX = (x_coordinates[_beginPoint] - lowestX) * scale;
+        double beginY = (y_coordinates[_beginPoint] - lowestY) * scale;
+        double endX = (x_coordinates[_endPoint] - lowestX) * scale;
+        double endY = (y_coordinates[_endPoint] - lowestY) * scale;
 
-                int nextContourPointIndex;
+        if (_controlPoint == -1)
+        {
+            AddEdge(_edgeList, beginX, beginY, endX, endY);
+        }
+        else
+        {
+            double controlX = (x_coordinates[_controlPoint] - lowestX) * scale;
+            double controlY = (y_coordinates[_controlPoint] - lowestY) * scale;
+            AddBezierCurve(_edgeList, beginX, beginY, controlX, controlY, endX, endY);
+        }
+    }
+}
 
-                if (contourPointIndex == numberOfPoints - 1)
-                {
-                    nextContourPointIndex = 0;
-                }
-                else
-                {
-                    nextContourPointIndex = contourPointIndex + 1;
-                }
+//(PRIVATE)
+//(LOCAL-TO BuildEdgeList)
+/* flattens the contours into the edges of the edge list, for the scale and the engine of its key; the coordinates of the edges are relative
+   to the lower-left corner of the bounding box of the edge list */
+void FlattenContours(EdgeList* _edgeList, const Contour* _contours, int _numberOfContours)
+{
+    int fixedScale = (_edgeList->Entry.Key.Scale * 65536.0) + 0.5; //(RE_FIXED) 16.16, the same as in DrawCharacter
 
-                ///
+    _edgeList->NumberOfContours = _numberOfContours;
+    _edgeList->NumberOfEdges = 0;
 
-                short pointX = x_coordinates[contourPointIndex];
-                short pointY = y_coordinates[contourPointIndex];
+    for (int contourIndex = 0; contourIndex < _numberOfContours; contourIndex++)
+    {
+        const Contour* contour = &_contours[contourIndex];
 
-                short nextPointX = x_coordinates[nextContourPointIndex];
-                short nextPointY = y_coordinates[nextContourPointIndex];
+        //(NOTE) the contour begins with an ON point, and there are no consecutive OFF points (see PreparedGlyph)
+        int currentPoint = 0;
+        int controlPoint = -1;
 
-                unsigned char flags_ = flags[contourPointIndex];
-                unsigned char nextFlags = flags[nextContourPointIndex];
+        //(NOTE) the last segment closes the contour - it ends in the first point
+        for (int i = 1; i <= contour->NumberOfPoints; i++)
+        {
+            int point = i < contour->NumberOfPoints ? i : 0;
 
-                //(->)
+            if (!GetBit(contour->Flags[point], 0))
+            {
+                controlPoint = point;
+                continue;
+            }
 
-                double scaledPointX = (pointX * SCALE) + fx_shift;
-                double scaledPointY = (pointY * SCALE) + fy_shift;
-                double scaledNextPointX = (nextPointX * SCALE) + fx_shift;
-                double scaledNextPointY = (nextPointY * SCALE) + fy_shift;
+            AddSegment(_edgeList, contour, currentPoint, controlPoint, point, fixedScale);
 
-                bool currentPointIsON = GetBit(flags_, 0);
-                bool nextPointIsON = GetBit(nextFlags, 0);
+            currentPoint = point;
+            controlPoint = -1;
+        }
 
-                ///ON, ON :: LINE
-                if (currentPointIsON && nextPointIsON)
-                {
-                    //writing the begin and end points of the current segment
+        if (_edgeList->ContourEnds != NULL)
+        {
+            _edgeList->ContourEnds[contourIndex] = _edgeList->NumberOfEdges;
+        }
+    }
+}
 
-                    double baseStep = 0.005; /* smaller distance between two semplices means more precise calculation of the
-                coverage, but the smaller distance ofcourse also means that more semplices will be calculated
-                for each pixel and therefore that will reflect in lower performance */
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+/* the edge list of the simple glyph for the size, the transformation and the engine in _key; _isCacheable => the edge list is added to
+   the edge cache of the context (if it fits in its budget), otherwise it's in the edge scratch memory of the context, and it's valid
+   until the next call; NULL :: the glyph has no contours that can be drawn */
+EdgeList* BuildEdgeList(tt_RasterContext* _context, const SimpleGlyph* _glyph, const GlyphKey* _key, bool _isCacheable)
+{
+    if (_glyph->NumberOfContours == 0)
+    {
+        return NULL;
+    }
 
-                    /* (B) check whether a (horizontal or vertical shift) of (the begin and end vertices) is needed;
-                       this shift is needed in some cases because of the fundamental errors in the calculations with the type 'double'
-                       that could generate wave-like/zig-zag movement of the delta point; if the begin and end vertices form
-                       a horizontal or vertical line and they are very close to the pixel edge, it's possible that this wave-like
-                       movement of the delta-point could cause multiple crossings between the current pixel and the closest (relative to
-                       the delta point) pixel, and this will result in incorrect calculation of the coverage */
+    ///THE PREPARED OUTLINE
 
-                    double scaledXFraction = FractionOf(scaledPointX);
-                    double scaledYFraction = FractionOf(scaledPointY);
+    /* (POSSIBLE-CASE) the glyph is not extracted from a font (see P_SimpleGlyph), so its topology and its prepared outline are not determined;
+       they are determined here, in a temporary arena */
+    GlyphArena preparationArena;
+    InitializeArena(&preparationArena);
 
-                    //if shifting the begin vertexoid to the right is needed
-                    if (scaledXFraction <= VERTEXOID_SHIFT)
-                    {
-                        scaledPointX += VERTEXOID_SHIFT;
-                    }
-                        //if shifting the begin vertexoid to the left is needed
-                    else if (scaledXFraction >= 0.99)
-                    {
-                        scaledPointX -= VERTEXOID_SHIFT;
-                    }
+    const ContourTopology* topology = _glyph->Topology != NULL ? _glyph->Topology : DetermineContourTopology(_glyph, &preparationArena);
+    const PreparedGlyph* prepared = _glyph->Prepared != NULL ? _glyph->Prepared : PrepareGlyph(_glyph, &preparationArena);
 
-                    //if shifting the begin vertexoid upwards is needed
-                    if (scaledYFraction <= VERTEXOID_SHIFT)
-                    {
-                        scaledPointY += VERTEXOID_SHIFT;
-                    }
-                        //if shifting the begin vertexoid downwards is needed
-                    else if (scaledYFraction >= 0.99)
-                    {
-                        scaledPointY -= VERTEXOID_SHIFT;
-                    }
+    //(E) all the contours contain only one point
+    if (prepared->NumberOfContours == 0)
+    {
+        ReleaseArena(&preparationArena);
+        return NULL;
+    }
 
-                    ///
+    int numberOfContours = prepared->NumberOfContours;
 
-                    double scaledNextXFraction = FractionOf(scaledNextPointX);
-                    double scaledNextYFraction = FractionOf(scaledNextPointY);
+    double composite_X_Offset = _key->Composite_X_Offset;
+    double composite_Y_Offset = _key->Composite_Y_Offset;
+    //value -1.0 for composite_X_Scale is used with horizontally-mirrored characters
+    //value -1.0 for composite_Y_Scale is used with vertically-mirrored characters
+    double composite_X_Scale = _key->Composite_X_Scale;
+    double composite_Y_Scale = _key->Composite_Y_Scale;
+    bool isTransformed = composite_X_Scale != 0.0 || composite_Y_Scale != 0.0;
+    bool isMirrored = (composite_X_Scale < 0.0 && composite_Y_Scale >= 0.0) || (composite_X_Scale >= 0.0 && composite_Y_Scale < 0.0);
 
-                    //if shifting the end vertexoid to the right is needed
-                    if (scaledNextXFraction <= VERTEXOID_SHIFT)
-                    {
-                        scaledNextPointX += VERTEXOID_SHIFT;
-                    }
-                        //if shifting the end vertexoid to the left is needed
-                    else if (scaledNextXFraction >= 0.99)
-                    {
-                        scaledNextPointX -= VERTEXOID_SHIFT;
-                    }
+    /* (NOTE) the contours of the glyph refer to the prepared outline; only a transformed glyph (a component of a composite glyph) needs
+       a copy of its points - it's allocated in the scratch memory of the context */
+    ResetScratch(_context, sizeof(Contour) * numberOfContours + (isTransformed ? (sizeof(float) * 2 + 1) * prepared->NumberOfPoints : 0) + 8 * 4);
 
-                    //if shifting the begin vertexoid upwards is needed
-                    if (scaledNextYFraction <= VERTEXOID_SHIFT)
-                    {
-                        scaledNextPointY += VERTEXOID_SHIFT;
-                    }
-                        //if shifting the begin vertexoid downwards is needed
-                    else if (scaledNextYFraction >= 0.99)
-                    {
-                        scaledNextPointY -= VERTEXOID_SHIFT;
-                    }
+    Contour* contours = ScratchAllocate(_context, sizeof(Contour) * numberOfContours);
+    float* transformed_x_coordinates = isTransformed ? ScratchAllocate(_context, sizeof(float) * prepared->NumberOfPoints) : NULL;
+    float* transformed_y_coordinates = isTransformed ? ScratchAllocate(_context, sizeof(float) * prepared->NumberOfPoints) : NULL;
+    unsigned char* transformedFlags = isTransformed ? ScratchAllocate(_context, sizeof(unsigned char) * prepared->NumberOfPoints) : NULL;
 
-                    //
+    /* the lowest and highest values are determined by taking in consideration the contours in &contours, and not the coordinates in
+       _glyph, as the coordinates of the contours are potentially modified because of composite_X_Scale/composite_Y_Scale */
 
-                    double beginSegmentPixelX = RoundDown(scaledPointX);
-                    double beginSegmentPixelY = RoundDown(scaledPointY);
-                    double endSegmentPixelX = RoundDown(scaledNextPointX);
-                    double endSegmentPixelY = RoundDown(scaledNextPointY);
+    int lowestX = INT_MAX;
+    int lowestY = INT_MAX;
+    int highestX = INT_MIN;
+    int highestY = INT_MIN;
 
-                    endSegmentoid.X = scaledNextPointX;
-                    endSegmentoid.Y = scaledNextPointY;
+    //for every contour
+    for (int contourIndex = 0; contourIndex < numberOfContours; contourIndex++)
+    {
+        const PreparedContour* preparedContour = &prepared->Contours[contourIndex];
+        int firstPoint = preparedContour->FirstPoint;
+        int numberOfPoints = preparedContour->NumberOfPoints;
 
-                    double lineLength = DistanceOf(scaledPointX, scaledPointY, scaledNextPointX, scaledNextPointY);
+        Contour* contour = &contours[contourIndex];
+        contour->NumberOfPoints = numberOfPoints;
 
-                    double LINE_ORIENTATION = OrientationOf(scaledPointX, scaledPointY, scaledNextPointX, scaledNextPointY);
-                    currentPixelMinX = RoundDown(scaledPointX);
-                    currentPixelMaxX = RoundUp(scaledPointX);
-                    currentPixelMinY = RoundDown(scaledPointY);
-                    currentPixelMaxY = RoundUp(scaledPointY);
+        if (isTransformed)
+        {
+            float* x_coordinates = &transformed_x_coordinates[firstPoint];
+            float* y_coordinates = &transformed_y_coordinates[firstPoint];
+            unsigned char* flags = &transformedFlags[firstPoint];
 
-                    deltaX = scaledPointX;
-                    deltaY = scaledPointY;
+            /* (NOTE) the coordinates are truncated to whole units, like the corners of the bounding box below; a mirrored contour is
+               reversed after its first point, so it still begins with an ON point */
+            for (int i = 0; i < numberOfPoints; i++)
+            {
+                int source = firstPoint + (isMirrored && i > 0 ? numberOfPoints - i : i);
+                x_coordinates[i] = (short) ((composite_X_Scale < 0 ? composite_X_Offset : 0) + (prepared->X_Coordinates[source] * composite_X_Scale));
+                y_coordinates[i] = (short) ((composite_Y_Scale < 0 ? composite_Y_Offset : 0) + (prepared->Y_Coordinates[source] * composite_Y_Scale));
+                flags[i] = prepared->Flags[source];
+            }
 
-                    while (true)
-                    {
-                        double distance = DistanceOf(scaledPointX, scaledPointY, deltaX, deltaY);
+            contour->X_Coordinates = x_coordinates;
+            contour->Y_Coordinates = y_coordinates;
+            contour->Flags = flags;
+        }
+        else
+        {
+            contour->X_Coordinates = &prepared->X_Coordinates[firstPoint];
+            contour->Y_Coordinates = &prepared->Y_Coordinates[firstPoint];
+            contour->Flags = &prepared->Flags[firstPoint];
+        }
 
-                        if (distance >= lineLength)
-                        {
-                            break;
-                        }
+        //the bounding box of the contour is already determined (see DetermineContourTopology), so only its corners are modified the same way as the points
+        const ContourTopology* contourTopology = &topology[preparedContour->TopologyIndex];
+        short minX = contourTopology->MinX;
+        short minY = contourTopology->MinY;
+        short maxX = contourTopology->MaxX;
+        short maxY = contourTopology->MaxY;
 
-                        oldDeltaX = deltaX;
-                        oldDeltaY = deltaY;
+        if (isTransformed)
+        {
+            minX = (composite_X_Scale < 0 ? composite_X_Offset : 0) + (minX * composite_X_Scale);
+            minY = (composite_Y_Scale < 0 ? composite_Y_Offset : 0) + (minY * composite_Y_Scale);
+            maxX = (composite_X_Scale < 0 ? composite_X_Offset : 0) + (maxX * composite_X_Scale);
+            maxY = (composite_Y_Scale < 0 ? composite_Y_Offset : 0) + (maxY * composite_Y_Scale);
+        }
 
-                        double delta_x = deltaX;
-                        double delta_y = deltaY;
+        //(NOTE) a negative scale swaps the lowest and the highest value
+        lowestX = SmallerOf(lowestX, SmallerOf(minX, maxX));
+        lowestY = SmallerOf(lowestY, SmallerOf(minY, maxY));
+        highestX = LargerOf(highestX, LargerOf(minX, maxX));
+        highestY = LargerOf(highestY, LargerOf(minY, maxY));
+    }
 
-                        Move(&delta_x, &delta_y, LINE_ORIENTATION, baseStep * 10);
 
-                        //if there are 10 or less steps until crossing another pixel
-                        if (delta_x < currentPixelMinX || delta_x >= currentPixelMaxX || delta_y < currentPixelMinY || delta_y >= currentPixelMaxY)
-                        {
-                            Move(&deltaX, &deltaY, LINE_ORIENTATION, baseStep);
-                        }
-                            /* (STATE) there are more than 10 steps until crossing another pixel, and there are more than 10 steps
-                                    until the end of the line */
-                        else
-                        {
-                            deltaX = delta_x;
-                            deltaY = delta_y;
-                        }
+    ///THE EDGES
 
-                        //if delta reaches the next pixel
-                        if (deltaX < currentPixelMinX || deltaX >= currentPixelMaxX || deltaY < currentPixelMinY || deltaY >= currentPixelMaxY)
-                        {
-                            //(A) if the 'delta' pixel is the begin pixel of the contour
-                            if (RoundDown(deltaX) == beginContourPixelX && RoundDown(deltaY) == beginContourPixelY)
-                            {
-                                beginPixelEnteringSamplex.X = deltaX;
-                                beginPixelEnteringSamplex.Y = deltaY;
-                            }
+    //the edges are counted first, so the edge list is allocated at once
+    EdgeList header;
+    header.Entry.Key = *_key;
+    header.LowestX = lowestX;
+    header.LowestY = lowestY;
+    header.HighestX = highestX;
+    header.HighestY = highestY;
+    header.ContourEnds = NULL;
+    header.Edges = NULL;
+    header.FixedEdges = NULL;
+    FlattenContours(&header, contours, numberOfContours);
 
-                            //if the current pixel is the begin pixel of the segment
-                            if (currentPixelMinX == beginSegmentPixelX && currentPixelMinY == beginSegmentPixelY)
-                            {
-                                //(A) if the current pixel is the begin pixel of the contour
-                                if (beginPixelExitingSamplex.X == -1)
-                                {
-                                    beginPixelExitingSamplex.X = oldDeltaX;
-                                    beginPixelExitingSamplex.Y = oldDeltaY;
-                                    beginPixelNextSamplex.X = deltaX;
-                                    beginPixelNextSamplex.Y = deltaY;
+    //(NOTE) the parts are rounded up to 8 bytes, so the edges are aligned
+    size_t headerSize = (sizeof(EdgeList) + 7) & ~((size_t) 7);
+    size_t contourEndsSize = _key->Engine == RE_SAMPLEX ? (sizeof(int) * numberOfContours + 7) & ~((size_t) 7) : 0;
+    size_t size = headerSize + contourEndsSize + (_key->Engine == RE_FIXED ? sizeof(FixedEdge) : sizeof(Edge)) * header.NumberOfEdges;
 
-                                    //this pixel must be marked as conturoid
+    bool isCached = _isCacheable && size <= _context->EdgeCache.Budget;
+    unsigned char* memory;
 
-                                    int position = currentPixelMinY * MetaCanvasWidth + currentPixelMinX;
+    if (isCached)
+    {
+        memory = malloc(size);
+    }
+    else
+    {
+        if (size > _context->EdgeScratchSize)
+        {
+            _context->EdgeScratchSize = size > _context->EdgeScratchSize * 2 ? size : _context->EdgeScratchSize * 2;
+            free(_context->EdgeScratch);
+            _context->EdgeScratch = malloc(_context->EdgeScratchSize);
+        }
 
-                                    if (MetaCanvas_S1[position] == 0)
-                                    {
-                                        int value = INITIAL_PIXEL_MARKER; /* a value that is not 0; when the end of the contour is reached it will be replaced
-                               with the real value */
-                                        MetaCanvas_S1[position] = value;
-                                    }
-                                }
-                                    //(STATE) the current pixel is the first for the segment, but not the first for the contour
-                                else
-                                {
-                                    Bitex segmentoidVertex;
-                                    segmentoidVertex.X = scaledPointX;
-                                    segmentoidVertex.Y = scaledPointY;
-
-                                    Bitex exitingSamplex;
-                                    exitingSamplex.X = oldDeltaX;
-                                    exitingSamplex.Y = oldDeltaY;
-
-                                    Bitex nextSamplex;
-                                    nextSamplex.X = deltaX;
-                                    nextSamplex.Y = deltaY;
-
-                                    unsigned int coverage = SegmentoidCoverage(&segmentoidVertex, &enteringSamplex,
-                                                                               &exitingSamplex, &nextSamplex, contour->IsFilled);
-
-                                    int position = currentPixelMinY * MetaCanvasWidth + currentPixelMinX;
-
-                                    unsigned int marker = MetaCanvas_S1[position];
-
-                                    //if the segmentoid is already crossed once (i.e. this is a +1 crossing)
-                                    if (marker != 0 && marker != INITIAL_PIXEL_MARKER)
-                                    {
-                                        MetaCanvas_S1[position] = MulticrossCoverage(marker, coverage);
-                                    }
-                                        //(STATE) this is the first crossing of the segmentoid
-                                    else
-                                    {
-                                        MetaCanvas_S1[position] = coverage;
-                                    }
-                                }
+        memory = _context->EdgeScratch;
+    }
 
-                                enteringSamplex.X = deltaX;
-                                enteringSamplex.Y = deltaY;
-                                PreviousPixelX = currentPixelMinX;
-                                PreviousPixelY = currentPixelMinY; //(->)
-                                currentPixelMinX = RoundDown(deltaX);
-                                currentPixelMaxX = RoundUp(deltaX);
-                                currentPixelMinY = RoundDown(deltaY);
-                                currentPixelMaxY = RoundUp(deltaY);
-                            }
-                                //(STATE) the pixel is a segmentonom
-                            else if (currentPixelMinX != endSegmentPixelX || currentPixelMinY != endSegmentPixelY)
-                            {
-                                int position = currentPixelMinY * MetaCanvasWidth + currentPixelMinX;
+    EdgeList* edgeList = (EdgeList*) memory;
+    *edgeList = header;
+    edgeList->Entry.Size = size;
 
-                                unsigned int marker_ = MetaCanvas_S1[position];
+    if (contourEndsSize > 0)
+    {
+        edgeList->ContourEnds = (int*) (memory + headerSize);
+    }
 
-                                /* it's possible that the entering and the exiting semplices are equal - this can happen if a pixel is 'missed',
-                                   i.e. if there is corner crossing */
+    if (_key->Engine == RE_FIXED)
+    {
+        edgeList->FixedEdges = (FixedEdge*) (memory + headerSize + contourEndsSize);
+    }
+    else
+    {
+        edgeList->Edges = (Edge*) (memory + headerSize + contourEndsSize);
+    }
 
-                                Bitex exitingSamplex;
-                                exitingSamplex.X = oldDeltaX;
-                                exitingSamplex.Y = oldDeltaY;
+    FlattenContours(edgeList, contours, numberOfContours);
 
-                                Bitex nextSamplex;
-                                nextSamplex.X = deltaX;
-                                nextSamplex.Y = deltaY;
+    ReleaseArena(&preparationArena);
 
-                                unsigned int coverage = SegmentonomCoverage(&enteringSamplex, &exitingSamplex, &nextSamplex, contour->IsFilled);
+    if (isCached)
+    {
+        InsertInCache(&_context->EdgeCache, &edgeList->Entry);
+    }
 
-                                //if the segmentonom is already crossed once (i.e. this is a +1 crossing)
-                                if (marker_ != 0 && marker_ != INITIAL_PIXEL_MARKER)
-                                {
-                                    MetaCanvas_S1[position] = MulticrossCoverage(marker_, coverage);
-                                }
-                                    //(STATE) this is the first crossing of the segmentonom
-                                else
-                                {
-                                    MetaCanvas_S1[position] = coverage;
-                                }
+    return edgeList;
+}
 
-                                enteringSamplex.X = deltaX;
-                                enteringSamplex.Y = deltaY;
-                                PreviousPixelX = currentPixelMinX;
-                                PreviousPixelY = currentPixelMinY; //(->)
-                                currentPixelMinX = RoundDown(deltaX);
-                                currentPixelMaxX = RoundUp(deltaX);
-                                currentPixelMinY = RoundDown(deltaY);
-                                currentPixelMaxY = RoundUp(deltaY);
-                            }
-                        }
-                    }
-                }
-                    ///IF THE POINT IS A CONTROL POINT OF A BEZIER CURVE/SPLINE
-                else if (!currentPointIsON)
-                {
-                    //(STATE) the begin point of the curve is (the previous point in the list) or (implicit point generated before that)
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+//adds the meta-canvas and its spans (at the end of stage 1) to the glyph cache of the context, if it fits in its budget
+void StoreCoverageMask(tt_RasterContext* _context, const GlyphKey* _key, int _offsetX, int _offsetY)
+{
+    int numberOfPixels = _context->MetaCanvasWidth * _context->MetaCanvasHeight;
+    size_t headerSize = (sizeof(CoverageMask) + 7) & ~((size_t) 7);
+    size_t rowSpansSize = sizeof(int) * (_context->MetaCanvasHeight + 1);
+    size_t spansSize = sizeof(CoverageSpan) * _context->NumberOfSpans;
+    size_t size = headerSize + rowSpansSize + spansSize + numberOfPixels;
 
-                    double beginPointX = 0.0;
-                    double beginPointY = 0.0;
+    if (size > _context->CoverageCache.Budget)
+    {
+        return;
+    }
 
-                    double controlPointX = scaledPointX;
-                    double controlPointY = scaledPointY;
+    CoverageMask* mask = malloc(size);
+    mask->Entry.Key = *_key;
+    mask->Entry.Size = size;
+    mask->Width = _context->MetaCanvasWidth;
+    mask->Height = _context->MetaCanvasHeight;
+    mask->OffsetX = _offsetX;
+    mask->OffsetY = _offsetY;
+    mask->RowSpans = (int*) ((unsigned char*) mask + headerSize);
+    mask->Spans = (CoverageSpan*) ((unsigned char*) mask->RowSpans + rowSpansSize);
+    mask->Coverage = (unsigned char*) mask->Spans + spansSize;
+
+    for (int i = 0; i < numberOfPixels; i++)
+    {
+        mask->Coverage[i] = _context->MetaCanvas_S2[i];
+    }
 
-                    double endPointX = scaledNextPointX;
-                    double endPointY = scaledNextPointY;
+    for (int i = 0; i <= _context->MetaCanvasHeight; i++)
+    {
+        mask->RowSpans[i] = _context->RowSpans[i];
+    }
 
-                    //(L)
+    for (int i = 0; i < _context->NumberOfSpans; i++)
+    {
+        mask->Spans[i] = _context->Spans[i];
+    }
 
-                    int previousContourPointIndex;
+    InsertInCache(&_context->CoverageCache, &mask->Entry);
+}
 
-                    if (contourPointIndex == 0)
-                    {
-                        previousContourPointIndex = numberOfPoints - 1;
-                    }
-                    else
-                    {
-                        previousContourPointIndex = contourPointIndex -1;
-                    }
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+/* the edge list of the simple glyph (with the size, the transformation and the engine in _key); _isCacheable => it's taken from (or added
+   to) the edge cache of the context; NULL :: there is nothing to draw */
+const EdgeList* FindEdgeList(tt_RasterContext* _context, const SimpleGlyph* _glyph, const GlyphKey* _key, bool _isCacheable)
+{
+    const EdgeList* edgeList = _isCacheable ? (EdgeList*) FindInCache(&_context->EdgeCache, _key) : NULL;
 
-                    unsigned char previousFlags = flags[previousContourPointIndex ];
+    if (edgeList == NULL)
+    {
+        edgeList = BuildEdgeList(_context, _glyph, _key, _isCacheable);
+    }
 
-                    //if the previous point is ON
-                    if (GetBit(previousFlags, 0) == true)
-                    {
-                        beginPointX = (x_coordinates[previousContourPointIndex] * SCALE) + fx_shift;
-                        beginPointY = (y_coordinates[previousContourPointIndex] * SCALE) + fy_shift;
-                    }
-                        //(STATE) there is an implicit point generated before that and that point is the begin point of the curve
-                    else
-                    {
-                        beginPointX = implicitPoint.X;
-                        beginPointY = implicitPoint.Y;
-                    }
+    return edgeList;
+}
 
-                    //if the next point is the end point of the curve
-                    if (nextPointIsON)
-                    {
-                        endPointX = scaledNextPointX;
-                        endPointY = scaledNextPointY;
-                    }
-                        //(STATE) the next point is also a control point
-                    else
-                    {
-                        //generating an implicit ON point
-                        implicitPoint = CentexOf(scaledPointX, scaledPointY, scaledNextPointX, scaledNextPointY);
-                        endPointX = implicitPoint.X;
-                        endPointY = implicitPoint.Y;
-                    }
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+/* determines the size of the meta-canvas of the glyph and its position; _phaseX and _phaseY are the fractional part of the position of
+   the glyph (see DrawCharacter), and the position of the meta-canvas is relative to the integer part of the position - so the drawn glyph
+   depends only on the fractional part, and it can be reused at any position with the same fractional part (see CoverageMask) */
+void LayOutGlyph(tt_RasterContext* _context, const EdgeList* _edgeList, int _lsb, double _phaseX, double _phaseY, GlyphLayout* _layout)
+{
+    double SCALE = _edgeList->Entry.Key.Scale;
+    int lowestX = _edgeList->LowestX;
+    int lowestY = _edgeList->LowestY;
+    int highestX = _edgeList->HighestX;
+    int highestY = _edgeList->HighestY;
+
+    /* (C) (t:SimpleGlyph : MinX, MinY, MaxX, MaxY) cannot be used here as there are errors (it seems) in some fonts - for example
+       yMin in (DejaVuSans index 3013) does not correspond to the real lowest Y value */
+    if (_context->Engine == RE_FIXED)
+    {
+        int fixedScale = (SCALE * 65536.0) + 0.5; //16.16
 
-                    double scaledXFraction = FractionOf(beginPointX);
-                    double scaledYFraction = FractionOf(beginPointY);
+        int originX = FixedOf(_phaseX) + ScaleToFixed(_lsb < 0 ? _lsb : lowestX, fixedScale);
+        int originY = FixedOf(_phaseY) + ScaleToFixed(lowestY, fixedScale);
 
-                    //if shifting the begin vertexoid to the right is needed
-                    if (scaledXFraction <= VERTEXOID_SHIFT)
-                    {
-                        beginPointX +=  VERTEXOID_SHIFT;
-                    }
-                        //if shifting the begin vertexoid to the left is needed
-                    else if (scaledXFraction >= 0.99)
-                    {
-                        beginPointX -= VERTEXOID_SHIFT;
-                    }
+        _layout->FixedShiftX = originX - (FixedFloor(originX) * 256);
+        _layout->FixedShiftY = originY - (FixedFloor(originY) * 256);
+        _layout->OffsetX = FixedFloor(originX);
+        _layout->OffsetY = FixedFloor(originY);
+        _layout->ShiftX = _layout->FixedShiftX / 256.0;
+        _layout->ShiftY = _layout->FixedShiftY / 256.0;
 
-                    //if shifting the begin vertexoid upwards is needed
-                    if (scaledYFraction <= VERTEXOID_SHIFT)
-                    {
-                        beginPointY += VERTEXOID_SHIFT;
-                    }
-                        //if shifting the begin vertexoid downwards is needed
-                    else if (scaledYFraction >= 0.99)
-                    {
-                        beginPointY -= VERTEXOID_SHIFT;
-                    }
+        //(NOTE) the same size as with the other engines (one spare column and row)
+        _layout->Width = FixedFloor(ScaleToFixed(highestX - lowestX, fixedScale) + _layout->FixedShiftX) + 2;
+        _layout->Height = FixedFloor(ScaleToFixed(highestY - lowestY, fixedScale) + _layout->FixedShiftY) + 2;
+    }
+    else
+    {
+        double x = _phaseX + ((_lsb < 0 ? _lsb : lowestX) * SCALE);
+        double y = _phaseY + (lowestY * SCALE);
+
+        _layout->OffsetX = RoundDown(x);
+        _layout->OffsetY = RoundDown(y);
+        _layout->ShiftX = x - _layout->OffsetX;
+        _layout->ShiftY = y - _layout->OffsetY;
+        _layout->FixedShiftX = 0;
+        _layout->FixedShiftY = 0;
+
+        _layout->Width = RoundUp(((highestX - lowestX) * SCALE)) + 1;
+        _layout->Height = RoundUp((highestY - lowestY) * SCALE) + 1;
+    }
+}
 
-                    ///
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+/* stage 1 - draws _numberOfRows rows of the glyph (beginning with the row _firstRow) in MetaCanvas_S2, which becomes the band of the
+   glyph (see SetBandSize); the edges of the glyph are clipped to the band by the fills;
+   (NOTE) the samplex engine traces the whole glyph, so a glyph that is drawn in more than one band is filled as with RE_ANALYTIC */
+void RasterizeGlyph(tt_RasterContext* _context, const EdgeList* _edgeList, const GlyphLayout* _layout, int _firstRow, int _numberOfRows)
+{
+    const EdgeList* edgeList = _edgeList;
+    Bitex enteringSamplex;
+    enteringSamplex.X = 0.0;
+    enteringSamplex.Y = 0.0; //the entering samplex for a pixel
+    double fx_shift = _layout->ShiftX;
+    double fy_shift = _layout->ShiftY;
 
-                    double scaledXFraction_ = FractionOf(endPointX);
-                    double scaledYFraction_ = FractionOf(endPointY);
+    _context->MetaCanvasWidth = _layout->Width;
+    _context->MetaCanvasHeight = _numberOfRows;
 
-                    //if shifting the begin vertexoid to the right is needed
-                    if (scaledXFraction_ <= VERTEXOID_SHIFT)
-                    {
-                        endPointX += VERTEXOID_SHIFT;
-                    }
-                        //if shifting the begin vertexoid to the left is needed
-                    else if (scaledXFraction_ >= 0.99)
-                    {
-                        endPointX -= VERTEXOID_SHIFT;
-                    }
+    ReserveMetaCanvas(_context, _context->MetaCanvasWidth * _context->MetaCanvasHeight);
 
-                    //if shifting the begin vertexoid upwards is needed
-                    if (scaledYFraction_ <= VERTEXOID_SHIFT)
-                    {
-                        endPointY += VERTEXOID_SHIFT;
-                    }
-                        //if shifting the begin vertexoid downwards is needed
-                    else if (scaledYFraction_ >= 0.99)
-                    {
-                        endPointY -= VERTEXOID_SHIFT;
-                    }
+    if (_context->Engine == RE_ANALYTIC || (_context->Engine == RE_SAMPLEX && _numberOfRows < _layout->Height))
+    {
+        AnalyticFill(_context, edgeList, fx_shift, fy_shift, _firstRow);
+    }
+    else if (_context->Engine == RE_FIXED)
+    {
+        FixedFill(_context, edgeList, _layout->FixedShiftX, _layout->FixedShiftY, _firstRow);
+    }
+    else
+    {
+        ReserveCells(_context, _context->MetaCanvasHeight + ((_context->MetaCanvasWidth + 1) * 3));
 
-                    //
+        //for every contour
+        for (int contourIndex = 0; contourIndex < edgeList->NumberOfContours; contourIndex++)
+        {
+            _context->PreviousPixelX = -1;
+            _context->PreviousPixelY = -1;
 
-                    endSegmentoid.X = endPointX;
-                    endSegmentoid.Y = endPointY;
+            int firstEdge = contourIndex > 0 ? edgeList->ContourEnds[contourIndex - 1] : 0;
+            int endEdge = edgeList->ContourEnds[contourIndex];
 
-                    //writing the begin and end points of the current segment
+            //(->)
 
-                    double beginSegmentPixelX = RoundDown(beginPointX);
-                    double beginSegmentPixelY = RoundDown(beginPointY);
+            /* (A) the coverage of the begin/end pixel P is determined at the end of the contour iteration, as the entering samplex
+                   is not known at the moment of exiting P; this variable stores the exiting samplex for the pixel, that will be
+                   used later in combination with the already determined entering samplex */
 
-                    deltaX = scaledPointX;
-                    deltaY = scaledPointY;
+            Bitex beginPixelEnteringSamplex;
+            beginPixelEnteringSamplex.X = -1.0;
+            beginPixelEnteringSamplex.Y = -1.0;
+            Bitex beginPixelExitingSamplex;
+            beginPixelExitingSamplex.X = -1.0;
+            beginPixelExitingSamplex.Y = -1.0;
+            Bitex beginPixelNextSamplex;
+            beginPixelNextSamplex.X = -1.0;
+            beginPixelNextSamplex.Y = -1.0;
 
-                    currentPixelMinX = RoundDown(beginPointX);
-                    currentPixelMaxX = RoundUp(beginPointX);
-                    currentPixelMinY = RoundDown(beginPointY);
-                    currentPixelMaxY = RoundUp(beginPointY);
+            Bitex endSegmentoid;
 
-                    double curveLength = LengthOfBezierCurve(beginPointX, beginPointY, controlPointX, controlPointY, endPointX, endPointY);
+            int currentPixelMinX;
+            int currentPixelMaxX;
+            int currentPixelMinY;
+            int currentPixelMaxY;
 
-                    curveLength += curveLength / 100.0;
+            double deltaX;
+            double deltaY;
+            double oldDeltaX;
+            double oldDeltaY;
 
-                    double percentage = 0.0;
-                    double onePixelPercentage = 100.0 / curveLength;
-                    double baseStep = (onePixelPercentage / 100.0) / 2.0; /* ~0.01px; the base step must be smaller than
-            VERTEXOID_SHIFT, so that a pixel will not be missed if there is corner crossing, i.e. to ensure
-            that delta will really cross the pixel (not just logically) and that the pixel will be marked as conturoid;
-            on the other hand the step has to be large enough to achieve better performance - in this case the difference
-            between the step and VERTEXOID_SHIFT is ~0.005px; the value is approximate, as the distance between two semplices
-            depends on the curvature of the curve (which is not constant) */;
+            //(NOTE) the first edge of the contour begins in its first point (see PreparedGlyph)
+            int beginContourPixelX = edgeList->Edges[firstEdge].BeginX + fx_shift;
+            int beginContourPixelY = edgeList->Edges[firstEdge].BeginY + fy_shift;
 
-                    double a = controlPointX - beginPointX;
-                    double b = controlPointY - beginPointY;
-                    double c = endPointX - controlPointX;
-                    double d = endPointY - controlPointY;
+            ///for every line of the contour
+            for (int edgeIndex = firstEdge; edgeIndex < endEdge; edgeIndex++)
+            {
+                //(NOTE) only the subpixel shift of the position is added, the edges are already scaled (see EdgeList)
+                const Edge* edge = &edgeList->Edges[edgeIndex];
+                double lineBeginX = edge->BeginX + fx_shift;
+                double lineBeginY = edge->BeginY + fy_shift;
+                double lineEndX = edge->EndX + fx_shift;
+                double lineEndY = edge->EndY + fy_shift;
+
+                //(NOTE) before the shifts (B), so the lines of the contour remain connected
+                AccumulateWinding(_context, lineBeginX, lineBeginY, lineEndX, lineEndY);
+
+                double baseStep = 0.005; /* smaller distance between two semplices means more precise calculation of the
+            coverage, but the smaller distance ofcourse also means that more semplices will be calculated
+            for each pixel and therefore that will reflect in lower performance */
+
+                /* (B) check whether a (horizontal or vertical shift) of (the begin and end vertices) is needed;
+                   this shift is needed in some cases because of the fundamental errors in the calculations with the type 'double'
+                   that could generate wave-like/zig-zag movement of the delta point; if the begin and end vertices form
+                   a horizontal or vertical line and they are very close to the pixel edge, it's possible that this wave-like
+                   movement of the delta-point could cause multiple crossings between the current pixel and the closest (relative to
+                   the delta point) pixel, and this will result in incorrect calculation of the coverage */
+
+                double lineBeginXFraction = FractionOf(lineBeginX);
+                double lineBeginYFraction = FractionOf(lineBeginY);
+
+                //if shifting the begin vertexoid to the right is needed
+                if (lineBeginXFraction <= VERTEXOID_SHIFT)
+                {
+                    lineBeginX += VERTEXOID_SHIFT;
+                }
+                    //if shifting the begin vertexoid to the left is needed
+                else if (lineBeginXFraction >= 0.99)
+                {
+                    lineBeginX -= VERTEXOID_SHIFT;
+                }
 
-                    while (true)
+                //if shifting the begin vertexoid upwards is needed
+                if (lineBeginYFraction <= VERTEXOID_SHIFT)
+                {
+                    lineBeginY += VERTEXOID_SHIFT;
+                }
+                    //if shifting the begin vertexoid downwards is needed
+                else if (lineBeginYFraction >= 0.99)
+                {
+                    lineBeginY -= VERTEXOID_SHIFT;
+                }
+
+                ///
+
+                double lineEndXFraction = FractionOf(lineEndX);
+                double lineEndYFraction = FractionOf(lineEndY);
+
+                //if shifting the end vertexoid to the right is needed
+                if (lineEndXFraction <= VERTEXOID_SHIFT)
+                {
+                    lineEndX += VERTEXOID_SHIFT;
+                }
+                    //if shifting the end vertexoid to the left is needed
+                else if (lineEndXFraction >= 0.99)
+                {
+                    lineEndX -= VERTEXOID_SHIFT;
+                }
+
+                //if shifting the begin vertexoid upwards is needed
+                if (lineEndYFraction <= VERTEXOID_SHIFT)
+                {
+                    lineEndY += VERTEXOID_SHIFT;
+                }
+                    //if shifting the begin vertexoid downwards is needed
+                else if (lineEndYFraction >= 0.99)
+                {
+                    lineEndY -= VERTEXOID_SHIFT;
+                }
+
+                //
+
+                double beginSegmentPixelX = RoundDown(lineBeginX);
+                double beginSegmentPixelY = RoundDown(lineBeginY);
+                double endSegmentPixelX = RoundDown(lineEndX);
+                double endSegmentPixelY = RoundDown(lineEndY);
+
+                endSegmentoid.X = lineEndX;
+                endSegmentoid.Y = lineEndY;
+
+                int squaredLineLength = SquaredDistanceOf(lineBeginX, lineBeginY, lineEndX, lineEndY);
+
+                /* the delta point moves along the unit direction vector of the line; the steps are computed once for the line, so
+                   moving the delta point is only an addition */
+                double directionX = lineEndX - lineBeginX;
+                double directionY = lineEndY - lineBeginY;
+                double length = sqrt((directionX * directionX) + (directionY * directionY));
+
+                if (length > 0.0)
+                {
+                    directionX /= length;
+                    directionY /= length;
+                }
+
+                double stepX = directionX * baseStep;
+                double stepY = directionY * baseStep;
+                double longStepX = directionX * (baseStep * 10);
+                double longStepY = directionY * (baseStep * 10);
+
+                currentPixelMinX = RoundDown(lineBeginX);
+                currentPixelMaxX = RoundUp(lineBeginX);
+                currentPixelMinY = RoundDown(lineBeginY);
+                currentPixelMaxY = RoundUp(lineBeginY);
+
+                deltaX = lineBeginX;
+                deltaY = lineBeginY;
+
+                while (true)
+                {
+                    if (SquaredDistanceOf(lineBeginX, lineBeginY, deltaX, deltaY) >= squaredLineLength)
                     {
-                        oldDeltaX = deltaX;
-                        oldDeltaY = deltaY;
-
-                        double percentage_ = percentage + (baseStep * 10);
-                        double p1_C_Interpolation_X = beginPointX + ((a / 100.0) * percentage_);
-                        double p1_C_Interpolation_Y = beginPointY + ((b / 100.0) * percentage_);
-                        double C_p2_Interpolation_X = controlPointX + ((c / 100.0) * percentage_);
-                        double C_p2_Interpolation_Y = controlPointY + ((d / 100.0) * percentage_);
-                        double delta_x = p1_C_Interpolation_X + (((C_p2_Interpolation_X - p1_C_Interpolation_X) / 100.0) * percentage_);
-                        double delta_y = p1_C_Interpolation_Y + (((C_p2_Interpolation_Y - p1_C_Interpolation_Y) / 100.0) * percentage_);
-
-                        //if there are 10 or less steps until crossing another pixel
-                        if (delta_x < currentPixelMinX || delta_x >= currentPixelMaxX || delta_y < currentPixelMinY || delta_y >= currentPixelMaxY)
-                        {
-                            double p1_C_Interpolation_X_ = beginPointX + ((a / 100.0) * percentage);
-                            double p1_C_Interpolation_Y_ = beginPointY + ((b / 100.0) * percentage);
-                            double C_p2_Interpolation_X_ = controlPointX + ((c / 100.0) * percentage);
-                            double C_p2_Interpolation_Y_ = controlPointY + ((d / 100.0) * percentage);
-                            deltaX = p1_C_Interpolation_X_ + (((C_p2_Interpolation_X_ - p1_C_Interpolation_X_) / 100.0) * percentage);
-                            deltaY = p1_C_Interpolation_Y_ + (((C_p2_Interpolation_Y_ - p1_C_Interpolation_Y_) / 100.0) * percentage);
-                            percentage += baseStep;
-                        }
-                            /* (STATE) there are more than 10 steps until crossing another pixel, and there are more than 10 steps
-                                 until the end of the curve */
-                        else
-                        {
-                            deltaX = delta_x;
-                            deltaY = delta_y;
-                            percentage += baseStep * 10;
-                        }
+                        break;
+                    }
 
-                        //if delta reaches the next pixel
-                        if (deltaX < currentPixelMinX || deltaX >= currentPixelMaxX || deltaY < currentPixelMinY || deltaY >= currentPixelMaxY)
-                        {
-                            //(A) if the 'delta' pixel is the begin pixel of the contour
-                            if (RoundDown(deltaX) == beginContourPixelX && RoundDown(deltaY) == beginContourPixelY)
-                            {
-                                beginPixelEnteringSamplex.X = deltaX;
-                                beginPixelEnteringSamplex.Y = deltaY;
-                            }
+                    oldDeltaX = deltaX;
+                    oldDeltaY = deltaY;
 
-                            //if the current pixel is the begin pixel of the segment
-                            if (currentPixelMinX == beginSegmentPixelX && currentPixelMinY == beginSegmentPixelY)
-                            {
-                                //(A) if the current pixel is the begin pixel of the contour
-                                if (beginPixelExitingSamplex.X == -1)
-                                {
-                                    beginPixelExitingSamplex.X = oldDeltaX;
-                                    beginPixelExitingSamplex.Y = oldDeltaY;
-                                    beginPixelNextSamplex.X = deltaX;
-                                    beginPixelNextSamplex.Y = deltaY;
+                    double delta_x = deltaX + longStepX;
+                    double delta_y = deltaY + longStepY;
 
-                                    //this pixel must be marked as conturoid
+                    //if there are 10 or less steps until crossing another pixel
+                    if (delta_x < currentPixelMinX || delta_x >= currentPixelMaxX || delta_y < currentPixelMinY || delta_y >= currentPixelMaxY)
+                    {
+                        deltaX += stepX;
+                        deltaY += stepY;
+                    }
+                        /* (STATE) there are more than 10 steps until crossing another pixel, and there are more than 10 steps
+                                until the end of the line */
+                    else
+                    {
+                        deltaX = delta_x;
+                        deltaY = delta_y;
+                    }
 
-                                    int position = currentPixelMinY * MetaCanvasWidth + currentPixelMinX;
+                    //if delta reaches the next pixel
+                    if (deltaX < currentPixelMinX || deltaX >= currentPixelMaxX || deltaY < currentPixelMinY || deltaY >= currentPixelMaxY)
+                    {
+                        //(A) if the 'delta' pixel is the begin pixel of the contour
+                        if (RoundDown(deltaX) == beginContourPixelX && RoundDown(deltaY) == beginContourPixelY)
+                        {
+                            beginPixelEnteringSamplex.X = deltaX;
+                            beginPixelEnteringSamplex.Y = deltaY;
+                        }
 
-                                    if (MetaCanvas_S1[position] == 0)
-                                    {
-                                        int value = INITIAL_PIXEL_MARKER; /* a value that is not 0; when the end of the contour is reached it will be replaced
-                               with the real value */
-                                        MetaCanvas_S1[position] = value;
-                                    }
-                                }
-                                    //(STATE) the current pixel is the first for the segment, but not the first for the contour
-                                else
-                                {
-                                    Bitex segmentoidVertex;
-                                    segmentoidVertex.X = beginPointX;
-                                    segmentoidVertex.Y = beginPointY;
-
-                                    Bitex exitingSamplex;
-                                    exitingSamplex.X = oldDeltaX;
-                                    exitingSamplex.Y = oldDeltaY;
-
-                                    Bitex nextSamplex;
-                                    nextSamplex.X = deltaX;
-                                    nextSamplex.Y = deltaY;
-
-                                    unsigned int coverage = SegmentoidCoverage(&segmentoidVertex, &enteringSamplex, &exitingSamplex,
-                                                                               &nextSamplex, contour->IsFilled);
-
-                                    int position = currentPixelMinY * MetaCanvasWidth + currentPixelMinX;
-
-                                    unsigned int marker = MetaCanvas_S1[position];
-
-                                    //if the segmentoid is already crossed once (i.e. this is a +1 crossing)
-                                    if (marker != 0 && marker != INITIAL_PIXEL_MARKER)
-                                    {
-                                        MetaCanvas_S1[position] = MulticrossCoverage(marker, coverage);
-                                    }
-                                        //(STATE) this is the first crossing of the segmentoid
-                                    else
-                                    {
-                                        MetaCanvas_S1[position] = coverage;
-                                    }
-                                }
+                        //if the current pixel is the begin pixel of the segment
+                        if (currentPixelMinX == beginSegmentPixelX && currentPixelMinY == beginSegmentPixelY)
+                        {
+                            //(A) if the current pixel is the begin pixel of the contour
+                            if (beginPixelExitingSamplex.X == -1)
+                            {
+                                beginPixelExitingSamplex.X = oldDeltaX;
+                                beginPixelExitingSamplex.Y = oldDeltaY;
+                                beginPixelNextSamplex.X = deltaX;
+                                beginPixelNextSamplex.Y = deltaY;
 
-                                enteringSamplex.X = deltaX;
-                                enteringSamplex.Y = deltaY;
-                                PreviousPixelX = currentPixelMinX;
-                                PreviousPixelY = currentPixelMinY; //(->)
-                                currentPixelMinX = RoundDown(deltaX);
-                                currentPixelMaxX = RoundUp(deltaX);
-                                currentPixelMinY = RoundDown(deltaY);
-                                currentPixelMaxY = RoundUp(deltaY);
+                                //(NOTE) the coverage of this pixel is determined when the end of the contour is reached
                             }
-                                //(STATE) the pixel is a segmentonom
-                            else if (currentPixelMinX != endPointX || currentPixelMinY != endPointY)
+                                //(STATE) the current pixel is the first for the segment, but not the first for the contour
+                            else
                             {
-                                /* it's possible that the entering and the exiting semplices are equal - this can happen if a pixel is 'missed',
-                                   i.e. if there is corner crossing */
+                                Bitex segmentoidVertex;
+                                segmentoidVertex.X = lineBeginX;
+                                segmentoidVertex.Y = lineBeginY;
 
                                 Bitex exitingSamplex;
                                 exitingSamplex.X = oldDeltaX;
@@ -2972,360 +3470,687 @@ void DrawCharacter(
                                 nextSamplex.X = deltaX;
                                 nextSamplex.Y = deltaY;
 
-                                unsigned int coverage = SegmentonomCoverage(&enteringSamplex, &exitingSamplex, &nextSamplex, contour->IsFilled);
+                                unsigned int coverage = SegmentoidCoverage(_context, &segmentoidVertex, &enteringSamplex,
+                                                                           &exitingSamplex, &nextSamplex);
 
-                                int position = currentPixelMinY * MetaCanvasWidth + currentPixelMinX;
+                                int position = currentPixelMinY * _context->MetaCanvasWidth + currentPixelMinX;
 
-                                unsigned int marker = MetaCanvas_S1[position];
+                                unsigned int marker = _context->MetaCanvas_S1[position];
 
-                                //if the segmentonom is already crossed once (i.e. this is a +1 crossing)
-                                if (marker != 0 && marker != INITIAL_PIXEL_MARKER)
+                                //if the segmentoid is already crossed once (i.e. this is a +1 crossing)
+                                if (marker != 0)
                                 {
-                                    MetaCanvas_S1[position] = MulticrossCoverage(marker, coverage);
+                                    _context->MetaCanvas_S1[position] = MulticrossCoverage(marker, coverage);
                                 }
-                                    //(STATE) this is the first crossing of the segmentonom
+                                    //(STATE) this is the first crossing of the segmentoid
                                 else
                                 {
-                                    MetaCanvas_S1[position] = coverage;
+                                    _context->MetaCanvas_S1[position] = coverage;
                                 }
-
-                                enteringSamplex.X = deltaX;
-                                enteringSamplex.Y = deltaY;
-                                PreviousPixelX = currentPixelMinX;
-                                PreviousPixelY = currentPixelMinY; //(->)
-                                currentPixelMinX = RoundDown(deltaX);
-                                currentPixelMaxX = RoundUp(deltaX);
-                                currentPixelMinY = RoundDown(deltaY);
-                                currentPixelMaxY = RoundUp(deltaY);
                             }
-                        }
 
-                        if (percentage >= 100.0)
+                            enteringSamplex.X = deltaX;
+                            enteringSamplex.Y = deltaY;
+                            _context->PreviousPixelX = currentPixelMinX;
+                            _context->PreviousPixelY = currentPixelMinY; //(->)
+                            currentPixelMinX = RoundDown(deltaX);
+                            currentPixelMaxX = RoundUp(deltaX);
+                            currentPixelMinY = RoundDown(deltaY);
+                            currentPixelMaxY = RoundUp(deltaY);
+                        }
+                            //(STATE) the pixel is a segmentonom
+                        else if (currentPixelMinX != endSegmentPixelX || currentPixelMinY != endSegmentPixelY)
                         {
-                            break;
+                            int position = currentPixelMinY * _context->MetaCanvasWidth + currentPixelMinX;
+
+                            unsigned int marker_ = _context->MetaCanvas_S1[position];
+
+                            /* it's possible that the entering and the exiting semplices are equal - this can happen if a pixel is 'missed',
+                               i.e. if there is corner crossing */
+
+                            Bitex exitingSamplex;
+                            exitingSamplex.X = oldDeltaX;
+                            exitingSamplex.Y = oldDeltaY;
+
+                            Bitex nextSamplex;
+                            nextSamplex.X = deltaX;
+                            nextSamplex.Y = deltaY;
+
+                            unsigned int coverage = SegmentonomCoverage(_context, &enteringSamplex, &exitingSamplex, &nextSamplex);
+
+                            //if the segmentonom is already crossed once (i.e. this is a +1 crossing)
+                            if (marker_ != 0)
+                            {
+                                _context->MetaCanvas_S1[position] = MulticrossCoverage(marker_, coverage);
+                            }
+                                //(STATE) this is the first crossing of the segmentonom
+                            else
+                            {
+                                _context->MetaCanvas_S1[position] = coverage;
+                            }
+
+                            enteringSamplex.X = deltaX;
+                            enteringSamplex.Y = deltaY;
+                            _context->PreviousPixelX = currentPixelMinX;
+                            _context->PreviousPixelY = currentPixelMinY; //(->)
+                            currentPixelMinX = RoundDown(deltaX);
+                            currentPixelMaxX = RoundUp(deltaX);
+                            currentPixelMinY = RoundDown(deltaY);
+                            currentPixelMaxY = RoundUp(deltaY);
                         }
                     }
                 }
-
-                if (endIndex < numberOfPoints - 1 && contourPointIndex == endIndex)
-                {
-                    break;
-                }
-                else if (endIndex == numberOfPoints - 1 && contourPointIndex == numberOfPoints - 1)
-                {
-                    break;
-                }
             }
 
             //determine the coverage of the begin/end pixel of the contour
 
             if (beginPixelEnteringSamplex.X > -1)
             {
-                unsigned int coverage = SegmentoidCoverage(&endSegmentoid, &beginPixelEnteringSamplex, &beginPixelExitingSamplex,
-                                                           &beginPixelNextSamplex, contour->IsFilled);
+                unsigned int coverage = SegmentoidCoverage(_context, &endSegmentoid, &beginPixelEnteringSamplex, &beginPixelExitingSamplex,
+                                                           &beginPixelNextSamplex);
 
-                int position = beginContourPixelY * MetaCanvasWidth + beginContourPixelX;
+                int position = beginContourPixelY * _context->MetaCanvasWidth + beginContourPixelX;
 
-                unsigned int marker = MetaCanvas_S1[position];
+                unsigned int marker = _context->MetaCanvas_S1[position];
 
-                if (marker != 0 && marker != INITIAL_PIXEL_MARKER)
+                if (marker != 0)
                 {
-                    MetaCanvas_S1[position] = MulticrossCoverage(marker, coverage);
+                    _context->MetaCanvas_S1[position] = MulticrossCoverage(marker, coverage);
                 }
                 else
                 {
-                    MetaCanvas_S1[position] = coverage;
+                    _context->MetaCanvas_S1[position] = coverage;
                 }
 
-                PreviousPixelX = currentPixelMinX;
-                PreviousPixelY = currentPixelMinY;
+                _context->PreviousPixelX = currentPixelMinX;
+                _context->PreviousPixelY = currentPixelMinY;
             }
+        }
+
+        ///FILLING THE CONTOURS
+
+        SamplexFill(_context);
+    }
+}
+
+//(PRIVATE)
+//(LOCAL-TO CompositeCoverage)
+//the color of the pixel _pixel of a gradient between _colors, where every two adjacent colors are _colorSegmentSize pixels apart
+tt_rgba GradientColor(const tt_rgba* _colors, int _colorSegmentSize, int _pixel)
+{
+    int currentColorIndex = RoundDown(_pixel / _colorSegmentSize);
+    int currentSegmentPixel = _pixel - (currentColorIndex * _colorSegmentSize);
+
+    const tt_rgba* alphaColor = &_colors[currentColorIndex];
+    const tt_rgba* betaColor = &_colors[currentColorIndex + 1];
+
+    double r_step = (double)(betaColor->R - alphaColor->R) / _colorSegmentSize;
+    double g_step = (double)(betaColor->G - alphaColor->G) / _colorSegmentSize;
+    double b_step = (double)(betaColor->B - alphaColor->B) / _colorSegmentSize;
+
+    tt_rgba color;
+    color.R = alphaColor->R + (r_step * currentSegmentPixel);
+    color.G = alphaColor->G + (g_step * currentSegmentPixel);
+    color.B = alphaColor->B + (b_step * currentSegmentPixel);
+    color.A = 0;
+    return color;
+}
+
+//(PRIVATE)
+//(LOCAL-TO CompositeCoverage)
+//puts _color in _pixel (4 bytes) in the order of the canvas
+void StoreColor(unsigned char* _pixel, tt_rgba _color, ColorComponentOrder _colorComponentOrder)
+{
+    _pixel[0] = _colorComponentOrder == RGBA_ORDER ? _color.R : _color.B;
+    _pixel[1] = _color.G;
+    _pixel[2] = _colorComponentOrder == RGBA_ORDER ? _color.B : _color.R;
+    _pixel[3] = 0;
+}
+
+#if defined(TT_SSE2)
+
+//(PRIVATE)
+//(LOCAL-TO CompositeSpan)
+//(_foreground * _weight + _background * (255 - _weight) + 127) / 255 in every 16-bit lane; the weights are 0..255
+__m128i BlendLanes(__m128i _background, __m128i _foreground, __m128i _weight)
+{
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(_foreground, _weight),
+                                _mm_mullo_epi16(_background, _mm_sub_epi16(_mm_set1_epi16(255), _weight)));
+
+    //(NOTE) (x + 127) / 255 == (y + (y >> 8)) >> 8, where y = x + 128, for every x in 0..65025
+    sum = _mm_add_epi16(sum, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_srli_epi16(sum, 8)), 8);
+}
+
+//(PRIVATE)
+//(LOCAL-TO CompositeSpan and FillSpan)
+//4 pixels; _coverage has the coverage of every pixel in its color components and 0 in its alpha component (see CompositeSpan)
+__m128i BlendPixels(__m128i _background, __m128i _foreground, __m128i _coverage, int _opacity)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i lowBackground = _mm_unpacklo_epi8(_background, zero);
+    __m128i highBackground = _mm_unpackhi_epi8(_background, zero);
+    __m128i low = BlendLanes(lowBackground, _mm_unpacklo_epi8(_foreground, zero), _mm_unpacklo_epi8(_coverage, zero));
+    __m128i high = BlendLanes(highBackground, _mm_unpackhi_epi8(_foreground, zero), _mm_unpackhi_epi8(_coverage, zero));
+
+    if (_opacity != FULL_COVERAGE)
+    {
+        __m128i opacity = _mm_set1_epi16(_opacity);
+        low = BlendLanes(lowBackground, low, opacity);
+        high = BlendLanes(highBackground, high, opacity);
+    }
+
+    return _mm_packus_epi16(low, high);
+}
+
+#endif
+
+#if defined(TT_AVX2)
+
+//(PRIVATE)
+//(LOCAL-TO CompositeSpan)
+//the same as BlendLanes, for 16 lanes
+__m256i BlendLanes_AVX2(__m256i _background, __m256i _foreground, __m256i _weight)
+{
+    __m256i sum = _mm256_add_epi16(_mm256_mullo_epi16(_foreground, _weight),
+                                   _mm256_mullo_epi16(_background, _mm256_sub_epi16(_mm256_set1_epi16(255), _weight)));
+
+    sum = _mm256_add_epi16(sum, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_srli_epi16(sum, 8)), 8);
+}
+
+//(PRIVATE)
+//(LOCAL-TO CompositeSpan and FillSpan)
+//the same as BlendPixels, for 8 pixels
+__m256i BlendPixels_AVX2(__m256i _background, __m256i _foreground, __m256i _coverage, int _opacity)
+{
+    //(NOTE) the unpacking and the packing are within the 128-bit lanes, so the order of the pixels is kept
+    __m256i zero = _mm256_setzero_si256();
+    __m256i lowBackground = _mm256_unpacklo_epi8(_background, zero);
+    __m256i highBackground = _mm256_unpackhi_epi8(_background, zero);
+    __m256i low = BlendLanes_AVX2(lowBackground, _mm256_unpacklo_epi8(_foreground, zero), _mm256_unpacklo_epi8(_coverage, zero));
+    __m256i high = BlendLanes_AVX2(highBackground, _mm256_unpackhi_epi8(_foreground, zero), _mm256_unpackhi_epi8(_coverage, zero));
+
+    if (_opacity != FULL_COVERAGE)
+    {
+        __m256i opacity = _mm256_set1_epi16(_opacity);
+        low = BlendLanes_AVX2(lowBackground, low, opacity);
+        high = BlendLanes_AVX2(highBackground, high, opacity);
+    }
+
+    return _mm256_packus_epi16(low, high);
+}
+
+#endif
+
+//(PRIVATE)
+//(LOCAL-TO CompositeCoverage and CompositeSpan)
+/* the same as CompositeSpan for _count adjacent interoids, without their coverage - without transparency the colors are only stored in the
+   pixels (the alpha of the canvas is kept), and with transparency they are blended with the background by the opacity */
+void FillSpan(unsigned char* _pixels, int _count, const unsigned char* _foreground, const unsigned char* _solidColor, int _transparency)
+{
+    int opacity = (((100 - _transparency) * FULL_COVERAGE) + 50) / 100;
+    int i = 0;
+
+#if defined(TT_AVX2)
+
+    __m256i solid256 = _mm256_set1_epi32(_solidColor[0] | (_solidColor[1] << 8) | (_solidColor[2] << 16));
+    __m256i alpha256 = _mm256_set1_epi32((int) 0xFF000000);
+    __m256i opacity256 = _mm256_set1_epi32(opacity * 0x010101);
+
+    for (; i + 8 <= _count; i += 8)
+    {
+        __m256i* pixels = (__m256i*) &_pixels[i * PIXEL_SIZE];
+        __m256i foreground = _foreground == NULL ? solid256 : _mm256_loadu_si256((const __m256i*) &_foreground[i * PIXEL_SIZE]);
+        __m256i background = _mm256_loadu_si256(pixels);
+
+        //(NOTE) the alpha of the colors is 0 (see StoreColor)
+        _mm256_storeu_si256(pixels, opacity == FULL_COVERAGE ? _mm256_or_si256(_mm256_and_si256(background, alpha256), foreground) :
+                                    BlendPixels_AVX2(background, foreground, opacity256, FULL_COVERAGE));
+    }
+
+#endif
 
-            free(x_coordinates);
-            free(y_coordinates);
-            free(flags);
+#if defined(TT_SSE2)
 
-            ///FILLING THE CONTOUR
+    __m128i solid = _mm_set1_epi32(_solidColor[0] | (_solidColor[1] << 8) | (_solidColor[2] << 16));
+    __m128i alpha = _mm_set1_epi32((int) 0xFF000000);
+    __m128i opacity128 = _mm_set1_epi32(opacity * 0x010101);
 
-            //for every row of the graphema
-            for (int row = 0; row < MetaCanvasHeight; row++)
+    for (; i + 4 <= _count; i += 4)
+    {
+        __m128i* pixels = (__m128i*) &_pixels[i * PIXEL_SIZE];
+        __m128i foreground = _foreground == NULL ? solid : _mm_loadu_si128((const __m128i*) &_foreground[i * PIXEL_SIZE]);
+        __m128i background = _mm_loadu_si128(pixels);
+
+        _mm_storeu_si128(pixels, opacity == FULL_COVERAGE ? _mm_or_si128(_mm_and_si128(background, alpha), foreground) :
+                                 BlendPixels(background, foreground, opacity128, FULL_COVERAGE));
+    }
+
+#endif
+
+    //the rest of the pixels (all of them without SSE2)
+    for (; i < _count; i++)
+    {
+        unsigned char* pixel = &_pixels[i * PIXEL_SIZE];
+        const unsigned char* foreground = _foreground == NULL ? _solidColor : &_foreground[i * PIXEL_SIZE];
+
+        for (int component = 0; component < 3; component++)
+        {
+            if (opacity == FULL_COVERAGE)
+            {
+                pixel[component] = foreground[component];
+            }
+            else
             {
-                bool fillMode = false;
+                pixel[component] = ((foreground[component] * opacity) + (pixel[component] * (FULL_COVERAGE - opacity)) + 127) / FULL_COVERAGE;
+            }
+        }
+    }
+}
 
-                //for every column of the graphema
-                for (int column = 0; column < MetaCanvasWidth; column++)
-                {
-                    unsigned int marker = MetaCanvas_S1[row * MetaCanvasWidth + column];
-                    unsigned int coverage = GetBits(marker, 0, 6);
-                    unsigned int O_Crossing = GetBits(marker, O_BEGIN, O_END);
-                    unsigned int T_Crossing = GetBits(marker, T_BEGIN, T_END);
-                    bool is_O_LEFT = GetBit(marker, O_LEFT);
-                    bool is_T_LEFT = GetBit(marker, T_LEFT);
-                    bool is_O_RIGHT = GetBit(marker, O_RIGHT);
-                    bool is_T_RIGHT = GetBit(marker, T_RIGHT);
-
-                    if (coverage > 0)
-                    {
-                        //only O-crossing
-                        if (O_Crossing > 0 && T_Crossing == 0)
-                        {
-                            fillMode = true;
-                        }
-                            //only T-crossing
-                        else if (O_Crossing == 0 && T_Crossing > 0)
-                        {
-                            fillMode = false;
-                        }
-                            //(BLOCK) O-crossing и T-crossing
-                        else if (is_O_LEFT && !is_T_LEFT)
-                        {
-                            fillMode = O_Crossing > T_Crossing;
-                        }
-                        else if (!is_O_RIGHT && is_T_RIGHT)
-                        {
-                            fillMode = false;
-                        }
-                        else if (is_T_LEFT && !is_O_LEFT && !is_O_RIGHT)
-                        {
-                            fillMode = O_Crossing > T_Crossing;
-                        }
-                        else if (is_T_LEFT && !is_O_LEFT)
-                        {
-                            fillMode = true;
-                        }
-                        else if (!is_T_RIGHT && is_O_RIGHT)
-                        {
-                            fillMode = true;
-                        }
-                        else if (is_O_LEFT && is_T_LEFT)
-                        {
-                            fillMode = O_Crossing > T_Crossing;
-                        }
-                        else if (is_O_RIGHT && is_T_RIGHT)
-                        {
-                            fillMode = false;
-                        }
-                        else if (O_Crossing > 0 && T_Crossing > 0 && !is_O_LEFT && !is_O_RIGHT && !is_T_LEFT && !is_T_RIGHT)
-                        {
-                            fillMode = O_Crossing > T_Crossing;
-                        }
-                    }
+//(PRIVATE)
+//(LOCAL-TO CompositeCoverage)
+/* blends _count adjacent pixels of the canvas (_pixels) with their colors by their coverage (_coverage - in the format of MetaCanvas_S2),
+   and then with the background by _transparency; _foreground :: the color of every pixel (4 bytes per pixel, in the order of the
+   canvas) | NULL => the color of every pixel is _solidColor (4 bytes, in the order of the canvas); the alpha of the canvas is not
+   changed, and the exteroids are not changed at all;
+   (NOTE) the components are blended as integers - the color component is (foreground * coverage + background * (255 - coverage) + 127)
+   / 255, and with transparency it's blended in the same way with the background by the opacity (1.0 - transparency in 8-bit alpha); the
+   pixels are blended in groups of 16 (AVX2) or 8 (SSE2), so the channel order of the canvas is handled only by the order of the colors;
+   a group of exteroids is skipped, and a group of interoids is filled (see FillSpan) */
+void CompositeSpan(unsigned char* _pixels, const unsigned char* _coverage, int _count, const unsigned char* _foreground,
+                   const unsigned char* _solidColor, int _transparency)
+{
+    int opacity = (((100 - _transparency) * FULL_COVERAGE) + 50) / 100;
+    int i = 0;
 
-                    int pixelType = EXTEROID;
+#if defined(TT_AVX2)
 
-                    if (coverage > 0)
-                    {
-                        pixelType = CONTUROID;
-                    }
-                    else if (fillMode)
-                    {
-                        pixelType = INTEROID;
-                    }
+    __m256i solid256 = _mm256_set1_epi32(_solidColor[0] | (_solidColor[1] << 8) | (_solidColor[2] << 16));
 
-                    MetaCanvas_S1[row * MetaCanvasWidth + column] = 0;
-                    unsigned char previousPixelType = GetBits(MetaCanvas_S2[row * MetaCanvasWidth + column], 0, 7);
-                    unsigned char previousCoverage = GetBits(MetaCanvas_S2[row * MetaCanvasWidth + column], 8, 15);
+    for (; i + 16 <= _count; i += 16)
+    {
+        __m128i coverage = _mm_loadu_si128((const __m128i*) &_coverage[i]);
 
-                    if (pixelType == CONTUROID && coverage > previousCoverage)
-                    {
-                        SetBits_USHORT(&MetaCanvas_S2[row * MetaCanvasWidth + column], 8, 15, coverage);
-                    }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(coverage, _mm_setzero_si128())) == 0xFFFF)
+        {
+            continue;
+        }
+        else if (_mm_movemask_epi8(_mm_cmpeq_epi8(coverage, _mm_set1_epi8((char) INTEROID))) == 0xFFFF)
+        {
+            FillSpan(&_pixels[i * PIXEL_SIZE], 16, _foreground == NULL ? NULL : &_foreground[i * PIXEL_SIZE], _solidColor, _transparency);
+            continue;
+        }
 
-                    if (previousPixelType == EXTEROID && pixelType != EXTEROID && contour->IsFilled)
-                    {
-                        SetBits_USHORT(&MetaCanvas_S2[row * MetaCanvasWidth + column], 0, 7, pixelType);
-                    }
-                    else if (previousPixelType == CONTUROID && pixelType == INTEROID)
-                    {
-                        SetBits_USHORT(&MetaCanvas_S2[row * MetaCanvasWidth + column], 0, 7, INTEROID);
-                    }
+        __m128i halves[2] = { coverage, _mm_srli_si128(coverage, 8) };
 
-                    if (previousPixelType != EXTEROID && previousPixelType != CONTUROID && !contour->IsFilled)
-                    {
-                        if (pixelType == EXTEROID)
-                        {
-                            pixelType = INTEROID;
-                        }
-                        else if (pixelType == INTEROID)
-                        {
-                            pixelType = EXTEROID;
-                        }
+        for (int k = 0; k < 2; k++)
+        {
+            //every coverage in the 4 bytes of its pixel, except the alpha
+            __m256i pixelCoverage = _mm256_mullo_epi32(_mm256_cvtepu8_epi32(halves[k]), _mm256_set1_epi32(0x010101));
+            __m256i* pixels = (__m256i*) &_pixels[(i + (k * 8)) * PIXEL_SIZE];
+            __m256i foreground = _foreground == NULL ? solid256 : _mm256_loadu_si256((const __m256i*) &_foreground[(i + (k * 8)) * PIXEL_SIZE]);
+            _mm256_storeu_si256(pixels, BlendPixels_AVX2(_mm256_loadu_si256(pixels), foreground, pixelCoverage, opacity));
+        }
+    }
 
-                        SetBits_USHORT(&MetaCanvas_S2[row * MetaCanvasWidth + column], 0, 7, pixelType);
-                    }
-                }
+#endif
+
+#if defined(TT_SSE2)
+
+    __m128i solid = _mm_set1_epi32(_solidColor[0] | (_solidColor[1] << 8) | (_solidColor[2] << 16));
+    __m128i alphaMask = _mm_set1_epi32(0x00FFFFFF);
+
+    for (; i + 8 <= _count; i += 8)
+    {
+        __m128i coverage = _mm_loadl_epi64((const __m128i*) &_coverage[i]);
+
+        if ((_mm_movemask_epi8(_mm_cmpeq_epi8(coverage, _mm_setzero_si128())) & 0xFF) == 0xFF)
+        {
+            continue;
+        }
+        else if ((_mm_movemask_epi8(_mm_cmpeq_epi8(coverage, _mm_set1_epi8((char) INTEROID))) & 0xFF) == 0xFF)
+        {
+            FillSpan(&_pixels[i * PIXEL_SIZE], 8, _foreground == NULL ? NULL : &_foreground[i * PIXEL_SIZE], _solidColor, _transparency);
+            continue;
+        }
+
+        //every coverage in the 4 bytes of its pixel, except the alpha
+        __m128i doubled = _mm_unpacklo_epi8(coverage, coverage);
+        __m128i pixelCoverage[2] = { _mm_and_si128(_mm_unpacklo_epi16(doubled, doubled), alphaMask),
+                                     _mm_and_si128(_mm_unpackhi_epi16(doubled, doubled), alphaMask) };
+
+        for (int k = 0; k < 2; k++)
+        {
+            __m128i* pixels = (__m128i*) &_pixels[(i + (k * 4)) * PIXEL_SIZE];
+            __m128i foreground = _foreground == NULL ? solid : _mm_loadu_si128((const __m128i*) &_foreground[(i + (k * 4)) * PIXEL_SIZE]);
+            _mm_storeu_si128(pixels, BlendPixels(_mm_loadu_si128(pixels), foreground, pixelCoverage[k], opacity));
+        }
+    }
+
+#endif
+
+    //the rest of the pixels (all of them without SSE2)
+    for (; i < _count; i++)
+    {
+        int coverage = _coverage[i];
+
+        if (coverage == 0)
+        {
+            continue;
+        }
+
+        unsigned char* pixel = &_pixels[i * PIXEL_SIZE];
+        const unsigned char* foreground = _foreground == NULL ? _solidColor : &_foreground[i * PIXEL_SIZE];
+
+        for (int component = 0; component < 3; component++)
+        {
+            int color = ((foreground[component] * coverage) + (pixel[component] * (FULL_COVERAGE - coverage)) + 127) / FULL_COVERAGE;
+
+            if (opacity != FULL_COVERAGE)
+            {
+                color = ((color * opacity) + (pixel[component] * (FULL_COVERAGE - opacity)) + 127) / FULL_COVERAGE;
             }
+
+            pixel[component] = color;
         }
+    }
+}
 
-        //for every row of the graphema
-        for (int row = 0; row < MetaCanvasHeight; row++)
+//(PRIVATE)
+//(LOCAL-TO DrawCharacter)
+/* stage 2 - draws the coverage mask of a glyph (_width x _height pixels, in the format of MetaCanvas_S2) in the canvas, at (_x, _y), with
+   the colors, the colorization mode and the transparency; the mask doesn't depend on them, so a drawn glyph (see CoverageMask) can be
+   drawn with any of them; _coverage is the band of _numberOfRows rows of the mask that begins with the row _firstRow, and _spans and
+   _rowSpans are the spans of its rows (see tt_RasterContext) - only the pixels in the spans are drawn */
+void CompositeCoverage(
+        tt_RasterContext* _context,
+        const unsigned char* _coverage,
+        const CoverageSpan* _spans,
+        const int* _rowSpans,
+        int _width,
+        int _height,
+        int _firstRow,
+        int _numberOfRows,
+        int _x,
+        int _y,
+        unsigned char* _canvas,
+        ColorComponentOrder _colorComponentOrder,
+        int _canvasWidth,
+        int _canvasHeight,
+        GlyphColorizationMode _colorizationMode,
+        const tt_rgba* _colors,
+        int _numberOfColors,
+        int _transparency,
+        int _maxGraphemicX)
+{
+    ///THE COLUMNS OF THE MASK THAT ARE IN THE CANVAS
+
+    int beginColumn = _x < 0 ? 0 - _x : 0;
+    int endColumn = _width;
+
+    if (_x + endColumn > _canvasWidth)
+    {
+        endColumn = _canvasWidth - _x;
+    }
+
+    if (_maxGraphemicX != -1 && _x + endColumn > _maxGraphemicX + 1)
+    {
+        endColumn = (_maxGraphemicX + 1) - _x;
+    }
+
+    if (beginColumn >= endColumn)
+    {
+        return;
+    }
+
+    ///THE COLORS
+
+    unsigned char solidColor[4] = { 0, 0, 0, 0 };
+    unsigned char* columnColors = NULL; //(horizontal gradients) the color of every column
+
+    if (_colorizationMode == GCM_SOLID)
+    {
+        StoreColor(solidColor, _colors[0], _colorComponentOrder);
+    }
+    else if (_colorizationMode == GCM_HORIZONTAL_GRADIENT || _colorizationMode == GCM_S_HORIZONTAL_GRADIENT)
+    {
+        if (_width > _context->ColumnColorsCapacity)
+        {
+            free(_context->ColumnColors);
+            _context->ColumnColorsCapacity = _width > _context->ColumnColorsCapacity * 2 ? _width : _context->ColumnColorsCapacity * 2;
+            _context->ColumnColors = malloc(_context->ColumnColorsCapacity * PIXEL_SIZE);
+        }
+
+        columnColors = _context->ColumnColors;
+
+        for (int column = beginColumn; column < endColumn; column++)
         {
-            //for every column of the graphema
-            for (int column = 0; column < MetaCanvasWidth; column++)
+            tt_rgba color;
+
+            if (_colorizationMode == GCM_HORIZONTAL_GRADIENT)
+            {
+                color = GradientColor(_colors, (_width - 1) / (_numberOfColors - 1), column);
+            }
+            else
             {
-                unsigned char pixelType = GetBits(MetaCanvas_S2[row * MetaCanvasWidth + column], 0, 7);
-                unsigned char coverage = GetBits(MetaCanvas_S2[row * MetaCanvasWidth + column], 8, 14);
+                color = GradientColor(_colors, _context->StringWidth / (_numberOfColors - 1), (_x + column) - _context->StringBeginX);
+            }
 
-                int targetColumn = _horizontalPosition + column;
-                int targetRow = _verticalPosition + row;
+            StoreColor(&columnColors[column * PIXEL_SIZE], color, _colorComponentOrder);
+        }
+    }
 
-                if (targetColumn < 0 || targetColumn >= _canvasWidth || targetRow < 0 || targetRow >= _canvasHeight)
-                {
-                    continue;
-                }
+    ///BLENDING
 
-                if (_maxGraphemicX != -1 && targetColumn > _maxGraphemicX)
-                {
-                    continue;
-                }
+    for (int row = _firstRow; row < _firstRow + _numberOfRows; row++)
+    {
+        int targetRow = _y + row;
 
-                tt_rgba backgroundColor = TT_GetPixel(_canvas, _canvasWidth, targetColumn, targetRow);
+        if (targetRow < 0 || targetRow >= _canvasHeight)
+        {
+            continue;
+        }
 
-                int targetPixelPosition = (targetRow * _canvasWidth + targetColumn) * PIXEL_SIZE;
+        if (_colorizationMode == GCM_VERTICAL_GRADIENT)
+        {
+            StoreColor(solidColor, GradientColor(_colors, (_height - 1) / (_numberOfColors - 1), row), _colorComponentOrder);
+        }
+        else if (_colorizationMode == GCM_S_VERTICAL_GRADIENT)
+        {
+            StoreColor(solidColor, GradientColor(_colors, _context->StringHeight / (_numberOfColors - 1), targetRow - _context->StringBeginY),
+                       _colorComponentOrder);
+        }
 
-                unsigned char betaCoverage = 100.0 - coverage;
+        for (int i = _rowSpans[row - _firstRow]; i < _rowSpans[row - _firstRow + 1]; i++)
+        {
+            int begin = _spans[i].Begin > beginColumn ? _spans[i].Begin : beginColumn;
+            int end = _spans[i].End < endColumn ? _spans[i].End : endColumn;
 
-                tt_rgba color;
-                tt_rgba foregroundColor;
+            if (begin >= end)
+            {
+                continue;
+            }
 
-                if (_colorizationMode == GCM_SOLID)
-                {
-                    foregroundColor = _colors[0];
-                }
-                else if (_colorizationMode == GCM_HORIZONTAL_GRADIENT)
-                {
-                    int maxGraphemicX = MetaCanvasWidth - 1;
-                    int colorSegmentSize = maxGraphemicX / (_numberOfColors - 1);
-                    int currentColorIndex = RoundDown(column / colorSegmentSize);
-                    int currentSegmentPixel = column - (currentColorIndex * colorSegmentSize);
+            unsigned char* pixels = &_canvas[((targetRow * _canvasWidth) + _x + begin) * PIXEL_SIZE];
+            const unsigned char* foreground = columnColors != NULL ? &columnColors[begin * PIXEL_SIZE] : NULL;
 
-                    const tt_rgba* alphaColor = &_colors[currentColorIndex];
-                    const tt_rgba* betaColor = &_colors[currentColorIndex + 1];
+            if (_spans[i].IsInterior)
+            {
+                FillSpan(pixels, end - begin, foreground, solidColor, _transparency);
+            }
+            else
+            {
+                CompositeSpan(pixels, &_coverage[((row - _firstRow) * _width) + begin], end - begin, foreground, solidColor, _transparency);
+            }
+        }
+    }
+}
 
-                    double r_step = (double)(betaColor->R - alphaColor->R) / colorSegmentSize;
-                    double g_step = (double)(betaColor->G - alphaColor->G) / colorSegmentSize;
-                    double b_step = (double)(betaColor->B - alphaColor->B) / colorSegmentSize;
+//(PUBLIC)
+/* _characterIndex is a Unicode codepoint if it's a positive value, and glyph index (within the given font file) if it's a negative value;
+  the function is non-validating - if _characterIndex is a Unicode codepoint, then it must be a valid Unicode codepoint and if
+  _characterIndex is a glyph index, then it must be an index within the valid for the specific font range */
+//_glyph is a Parser::SimpleGlyph or Parser::CompositeGlyph object; if this parameter is used, then _characterIndex is ignored
+//_canvas is (a RGBA or BGRA pixel array) in which the character is drawn
+//Y_Direction specifies the direction in which the Y-coordinates grow (top-to-bottom or bottom-up)
+//_colorComponentOrder specifies if the pixels in _canvas are RGBA or BGRA
+//_canvasWidth and _canvasHeight are the width and height of the canvas(i.e. _canvas) specified in pixels
+//_horizontalPosition specifies the position (in pixels) of the left border of the EM-square; it can be negative or positive value
+//_verticalPosition specifies the position (in pixels) of the baseline in the canvas; it can be negative or positive value
+//_fontSize is the height of the line (not the actual character) in pixels
+//_numberOfColors should be equal (or larger) to the number of elements in _colors
+//_transparency = 0 means fully opaque string, and 100 means fully transparent string
+/*_maxGraphemicX specifies a limiting X coordinate in the canvas (not an X coordinate in the string itself) - i.e. the part of the
+   character after this coordinate will not be visualized; a value of -1 specifies that there is no horizontal limit;
+   this coordinate is inclusive, i.e. the column matching the coordinate will also be visualized */
+/* (!!!) this is a non-validating function; the font must contain the glyph that is represented by the specified _characterIndex
+         value (if set) and the parameters must have correct values */
+void DrawCharacterWithContext(
+        tt_RasterContext* _context,
+        int _characterIndex,
+        void* _glyph,
+        const Font* _font,
+        unsigned char* _canvas,
+        ColorComponentOrder _colorComponentOrder,
+        int _canvasWidth,
+        int _canvasHeight,
+        double _horizontalPosition,
+        double _verticalPosition,
+        double _fontSize,
+        GlyphColorizationMode _colorizationMode,
+        const tt_rgba* _colors,
+        int _numberOfColors,
+        int _transparency,
+        int _maxGraphemicX,
+        double _composite_X_Offset, //(INTERNAL)
+        double _composite_Y_Offset, //(INTERNAL)
+        double _composite_X_Scale, //(INTERNAL)
+        double _composite_Y_Scale) //(INTERNAL)
+{
+    double SCALE = GetScale(_font, _fontSize);
 
-                    foregroundColor.R = alphaColor->R + (r_step * currentSegmentPixel);
-                    foregroundColor.G = alphaColor->G + (g_step * currentSegmentPixel);
-                    foregroundColor.B = alphaColor->B + (b_step * currentSegmentPixel);
-                }
-                else if (_colorizationMode == GCM_VERTICAL_GRADIENT)
-                {
-                    int maxGraphemicY = MetaCanvasHeight - 1;
-                    int colorSegmentSize = maxGraphemicY / (_numberOfColors - 1);
-                    int currentColorIndex = RoundDown(row / colorSegmentSize);
-                    int currentSegmentPixel = row - (currentColorIndex * colorSegmentSize);
+    void* glyph;
 
-                    const tt_rgba* alphaColor = &_colors[currentColorIndex];
-                    const tt_rgba* betaColor = &_colors[currentColorIndex + 1];
+    //if the function receives a glyph, and not (an Unicode codepoint) or (glyph index)
+    if (_glyph != NULL)
+    {
+        glyph = _glyph;
+    }
+        //ако &_characterIndex is an Unicode codepoint
+    else if (_characterIndex > 0)
+    {
+        glyph = GetGlyph(_font, _characterIndex);
+    }
+        //(STATE) _characterIndex is a glyph index (in the table 'glyf')
+    else
+    {
+        glyph = GetGlyphByIndex(_font, 0 - _characterIndex);
+    }
 
-                    double r_step = (double)(betaColor->R - alphaColor->R) / colorSegmentSize;
-                    double g_step = (double)(betaColor->G - alphaColor->G) / colorSegmentSize;
-                    double b_step = (double)(betaColor->B - alphaColor->B) / colorSegmentSize;
+    ///IF THE GLYPH IS EMPTY (NON-CONTOUR GLYPH)
+    if (Is(glyph, EMPTY_GLYPH))
+    {
+        return;
+    }
+        ///IF THE GLYPH IS SIMPLE
+    else if (Is(glyph, SIMPLE_GLYPH))
+    {
+        SimpleGlyph* glyph_ = (SimpleGlyph*) glyph;
 
-                    foregroundColor.R = alphaColor->R + (r_step * currentSegmentPixel);
-                    foregroundColor.G = alphaColor->G + (g_step * currentSegmentPixel);
-                    foregroundColor.B = alphaColor->B + (b_step * currentSegmentPixel);
-                }
-                else if (_colorizationMode == GCM_S_HORIZONTAL_GRADIENT)
-                {
-                    int stringColumn = (_horizontalPosition + column) - StringBeginX;
-                    int maxGraphemicX = StringWidth - 1;
-                    int colorSegmentSize = StringWidth / (_numberOfColors - 1);
-                    int currentColorIndex = RoundDown(stringColumn / colorSegmentSize);
-                    int currentSegmentPixel = stringColumn - (currentColorIndex * colorSegmentSize);
-
-                    const tt_rgba* alphaColor = &_colors[currentColorIndex];
-                    const tt_rgba* betaColor = &_colors[currentColorIndex + 1];
-
-                    double r_step = (double)(betaColor->R - alphaColor->R) / colorSegmentSize;
-                    double g_step = (double)(betaColor->G - alphaColor->G) / colorSegmentSize;
-                    double b_step = (double)(betaColor->B - alphaColor->B) / colorSegmentSize;
-
-                    foregroundColor.R = alphaColor->R + (r_step * currentSegmentPixel);
-                    foregroundColor.G = alphaColor->G + (g_step * currentSegmentPixel);
-                    foregroundColor.B = alphaColor->B + (b_step * currentSegmentPixel);
-                }
-                else if (_colorizationMode == GCM_S_VERTICAL_GRADIENT)
-                {
-                    int stringRow = (_verticalPosition + row) - StringBeginY;
-                    int maxGraphemicY = StringBeginY + StringHeight;
-                    int colorSegmentSize = StringHeight / (_numberOfColors - 1);
-                    int currentColorIndex = RoundDown(stringRow / colorSegmentSize);
-                    int currentSegmentPixel = stringRow - (currentColorIndex * colorSegmentSize);
-
-                    const tt_rgba* alphaColor = &_colors[currentColorIndex];
-                    const tt_rgba* betaColor = &_colors[currentColorIndex + 1];
-
-                    double r_step = (double)(betaColor->R - alphaColor->R) / colorSegmentSize;
-                    double g_step = (double)(betaColor->G - alphaColor->G) / colorSegmentSize;
-                    double b_step = (double)(betaColor->B - alphaColor->B) / colorSegmentSize;
-
-                    foregroundColor.R = alphaColor->R + (r_step * currentSegmentPixel);
-                    foregroundColor.G = alphaColor->G + (g_step * currentSegmentPixel);
-                    foregroundColor.B = alphaColor->B + (b_step * currentSegmentPixel);
-                }
+        //(NOTE) the position is rounded to a subpixel phase, whether the glyph is cached or not, so the result doesn't depend on the cache
+        if (_context->SubpixelPhases > 0)
+        {
+            _horizontalPosition = round(_horizontalPosition * _context->SubpixelPhases) / _context->SubpixelPhases;
+            _verticalPosition = round(_verticalPosition * _context->SubpixelPhases) / _context->SubpixelPhases;
+        }
+
+        int positionX = RoundDown(_horizontalPosition);
+        int positionY = RoundDown(_verticalPosition);
+
+        //(NOTE) only the glyphs from the font are cached - a glyph given by the caller can be changed or released after the drawing
+        GlyphKey key;
+        key.Font = _font;
+        key.FontSerial = _font->Serial;
+        key.GlyphIndex = _characterIndex > 0 ? GetGlyphIndex(_font, _characterIndex) : 0 - _characterIndex;
+        key.Scale = SCALE;
+        key.Composite_X_Offset = _composite_X_Offset;
+        key.Composite_Y_Offset = _composite_Y_Offset;
+        key.Composite_X_Scale = _composite_X_Scale;
+        key.Composite_Y_Scale = _composite_Y_Scale;
+        key.Engine = _context->Engine;
+        key.PhaseX = _horizontalPosition - positionX;
+        key.PhaseY = _verticalPosition - positionY;
+
+        bool isCoverageCacheable = _glyph == NULL && _context->CoverageCache.Budget > 0;
+        const CoverageMask* mask = isCoverageCacheable ? (CoverageMask*) FindInCache(&_context->CoverageCache, &key) : NULL;
+
+        ///THE GLYPH IS ALREADY DRAWN WITH THIS SIZE AND SUBPIXEL PHASE
+        if (mask != NULL)
+        {
+            CompositeCoverage(_context, mask->Coverage, mask->Spans, mask->RowSpans, mask->Width, mask->Height, 0, mask->Height,
+                              positionX + mask->OffsetX, positionY + mask->OffsetY, _canvas, _colorComponentOrder, _canvasWidth,
+                              _canvasHeight, _colorizationMode, _colors, _numberOfColors, _transparency, _maxGraphemicX);
+        }
+        else
+        {
+            int lsb;
+
+            if (_glyph != NULL)
+            {
+                lsb = glyph_->MinX; //(C)
+            }
+            else
+            {
+                lsb = GetLeftSideBearing(_font, _characterIndex);
+            }
+
+            //(NOTE) the edge list doesn't depend on the position
+            GlyphKey edgeKey = key;
+            edgeKey.PhaseX = 0.0;
+            edgeKey.PhaseY = 0.0;
+
+            const EdgeList* edgeList = FindEdgeList(_context, glyph_, &edgeKey, _glyph == NULL);
+
+            //(E) the glyph has no contours, or all the contours contain only one point
+            if (edgeList == NULL)
+            {
+                return;
+            }
+
+            GlyphLayout layout;
+            LayOutGlyph(_context, edgeList, lsb, key.PhaseX, key.PhaseY, &layout);
+
+            //a glyph with more pixels than the band size is drawn in bands of rows, so the size of the meta-canvas is limited
+            int bandHeight = layout.Height;
+
+            if (_context->BandSize > 0 && (long long) layout.Width * layout.Height > _context->BandSize)
+            {
+                bandHeight = _context->BandSize / layout.Width > 0 ? _context->BandSize / layout.Width : 1;
+            }
+
+            for (int firstRow = 0; firstRow < layout.Height; firstRow += bandHeight)
+            {
+                int numberOfRows = layout.Height - firstRow < bandHeight ? layout.Height - firstRow : bandHeight;
+
+                ///STAGE 1
 
-                if (pixelType == CONTUROID)
-                {
-                    //rounding to the nearest value of the (values of the color components) is not needed, as the effect will be neglible
-                    color.R = ((foregroundColor.R / 100.0) * coverage) + ((backgroundColor.R / 100.0) * betaCoverage);
-                    color.G = ((foregroundColor.G / 100.0) * coverage) + ((backgroundColor.G / 100.0) * betaCoverage);
-                    color.B = ((foregroundColor.B / 100.0) * coverage) + ((backgroundColor.B / 100.0) * betaCoverage);
-                }
-                else if (pixelType == INTEROID)
-                {
-                    color.R = foregroundColor.R;
-                    color.G = foregroundColor.G;
-                    color.B = foregroundColor.B;
-                }
-                else
-                {
-                    color.R = backgroundColor.R;
-                    color.G = backgroundColor.G;
-                    color.B = backgroundColor.B;
-                }
+                RasterizeGlyph(_context, edgeList, &layout, firstRow, numberOfRows);
 
-                if (_transparency == 0)
-                {
-                    if (_colorComponentOrder == RGBA_ORDER)
-                    {
-                        _canvas[targetPixelPosition] = color.R;
-                        _canvas[targetPixelPosition + 1] = color.G;
-                        _canvas[targetPixelPosition + 2] = color.B;
-                    }
-                    else
-                    {
-                        _canvas[targetPixelPosition] = color.B;
-                        _canvas[targetPixelPosition + 1] = color.G;
-                        _canvas[targetPixelPosition + 2] = color.R;
-                    }
-                }
-                else
+                //(NOTE) only a glyph drawn in one band is cached
+                if (isCoverageCacheable && numberOfRows == layout.Height)
                 {
-                    if (_colorComponentOrder == RGBA_ORDER)
-                    {
-                        _canvas[targetPixelPosition] = GetColorComponent(backgroundColor.R, color.R, _transparency);
-                        _canvas[targetPixelPosition + 1] = GetColorComponent(backgroundColor.G, color.G, _transparency);
-                        _canvas[targetPixelPosition + 2] = GetColorComponent(backgroundColor.B, color.B, _transparency);
-                    }
-                    else
-                    {
-                        _canvas[targetPixelPosition] = GetColorComponent(backgroundColor.B, color.B, _transparency);
-                        _canvas[targetPixelPosition + 1] = GetColorComponent(backgroundColor.G, color.G, _transparency);
-                        _canvas[targetPixelPosition + 2] = GetColorComponent(backgroundColor.R, color.R, _transparency);
-                    }
+                    StoreCoverageMask(_context, &key, layout.OffsetX, layout.OffsetY);
                 }
-            }
-        }
 
-        if (orderedContours != unorderedContours)
-        {
-            free(orderedContours);
+                ///STAGE 2
+
+                CompositeCoverage(_context, _context->MetaCanvas_S2, _context->Spans, _context->RowSpans, layout.Width, layout.Height,
+                                  firstRow, numberOfRows, positionX + layout.OffsetX, positionY + layout.OffsetY, _canvas, _colorComponentOrder,
+                                  _canvasWidth, _canvasHeight, _colorizationMode, _colors, _numberOfColors, _transparency, _maxGraphemicX);
+            }
         }
-        //(->)
-        free(unorderedContours);
     }
         ///(STATE) THE GLYPH IS COMPOSITE
     else
@@ -3334,7 +4159,7 @@ void DrawCharacter(
 
         for (int i = 0; i < glyph_->NumberOfComponents; i++)
         {
-            GlyphComponent* component = glyph_->Components[i];
+            GlyphComponent* component = &glyph_->Components[i];
 
             double x_scale;
             double y_scale;
@@ -3381,7 +4206,8 @@ void DrawCharacter(
                 y_scale = x_scale;
             }
 
-            DrawCharacter(
+            DrawCharacterWithContext(
+                    _context,
                     -component->GlyphIndex,
                     NULL,
                     _font,
@@ -3403,49 +4229,82 @@ void DrawCharacter(
                     y_scale);
         }
     }
+}
 
-    if (MetaCanvas_S1 != NULL)
-    {
-        free(MetaCanvas_S1);
-        free(MetaCanvas_S2);
-        MetaCanvas_S1 = NULL;
-        MetaCanvas_S2 = NULL;
-    }
+//(PUBLIC)
+//the same as DrawCharacterWithContext, using the default context (see tt_RasterContext)
+void DrawCharacter(
+        int _characterIndex,
+        void* _glyph,
+        const Font* _font,
+        unsigned char* _canvas,
+        ColorComponentOrder _colorComponentOrder,
+        int _canvasWidth,
+        int _canvasHeight,
+        double _horizontalPosition,
+        double _verticalPosition,
+        double _fontSize,
+        GlyphColorizationMode _colorizationMode,
+        const tt_rgba* _colors,
+        int _numberOfColors,
+        int _transparency,
+        int _maxGraphemicX,
+        double _composite_X_Offset, //(INTERNAL)
+        double _composite_Y_Offset, //(INTERNAL)
+        double _composite_X_Scale, //(INTERNAL)
+        double _composite_Y_Scale) //(INTERNAL)
+{
+    DrawCharacterWithContext(
+            &DefaultRasterContext,
+            _characterIndex,
+            _glyph,
+            _font,
+            _canvas,
+            _colorComponentOrder,
+            _canvasWidth,
+            _canvasHeight,
+            _horizontalPosition,
+            _verticalPosition,
+            _fontSize,
+            _colorizationMode,
+            _colors,
+            _numberOfColors,
+            _transparency,
+            _maxGraphemicX,
+            _composite_X_Offset,
+            _composite_Y_Offset,
+            _composite_X_Scale,
+            _composite_Y_Scale);
 }
 
 //(PUBLIC)
-//returns the width of the string in pixels (with the left-side bearing of the first character and the right-side bearing of the last character)
-double GetTypographicWidth(const Font* _font, const wchar_t* _string, double _fontSize)
+//returns the width of the glyphs in pixels (with the left-side bearing of the first glyph and the right-side bearing of the last glyph)
+//_numberOfGlyphs >= 1 ->
+double GetGlyphRunTypographicWidth(const Font* _font, const unsigned short* _glyphIndexes, int _numberOfGlyphs, double _fontSize)
 {
     int currentWidth = 0;
 
-    HMTX_Table* hmtx = (HMTX_Table*) GetTable(_font, HMTX_TABLE);
+    //the first glyph
 
-    //the first character in the string
+    currentWidth += GetGlyphAdvanceWidth(_font, _glyphIndexes[0]);
 
-    int index = GetGlyphIndex(_font, _string[0]);
-    currentWidth += hmtx->HorizontalMetrics[index].AdvanceWidth;
-
-    double firstCharacterLeftSideBearing = GetLeftSideBearing(_font, _string[0]);
+    double firstCharacterLeftSideBearing = GetGlyphLeftSideBearing(_font, _glyphIndexes[0]);
 
     if (firstCharacterLeftSideBearing < 0)
     {
         currentWidth += Absolute(firstCharacterLeftSideBearing);
     }
 
-    //characters (1..last)
-
-    int stringLength = wcslen(_string);
+    //glyphs (1..last)
 
-    for (int i = 1; i < stringLength; i++)
+    for (int i = 1; i < _numberOfGlyphs; i++)
     {
-        int index = GetGlyphIndex(_font, _string[i]);
-        currentWidth += hmtx->HorizontalMetrics[index].AdvanceWidth;
+        currentWidth += GetGlyphAdvanceWidth(_font, _glyphIndexes[i]);
     }
 
-    //the last character in the string
+    //the last glyph
 
-    double lastCharacterRightSideBearing = GetRightSideBearing(_font, _string[stringLength - 1]);
+    double lastCharacterRightSideBearing = GetGlyphRightSideBearing(_font, _glyphIndexes[_numberOfGlyphs - 1]);
 
     if (lastCharacterRightSideBearing < 0)
     {
@@ -3458,42 +4317,51 @@ double GetTypographicWidth(const Font* _font, const wchar_t* _string, double _fo
 }
 
 //(PUBLIC)
-//returns the width of the string in pixels (without the left-side bearing of the first character and the right-side bearing of the last character)
-//_fontSize is specified in pixels
-//_string.length() >= 1 ->
-double GetGraphemicWidth(const Font* _font, const wchar_t* _string, double _fontSize)
+//returns the width of the string in pixels (with the left-side bearing of the first character and the right-side bearing of the last character)
+double GetTypographicWidth(const Font* _font, const wchar_t* _string, double _fontSize)
 {
-    //(STATE) the string has more than 1 character
+    int stringLength = wcslen(_string);
+    unsigned short* glyphIndexes = malloc(sizeof(unsigned short) * stringLength);
+    MapString(_font, _string, stringLength, glyphIndexes);
 
-    HMTX_Table* hmtx = (HMTX_Table*) GetTable(_font, HMTX_TABLE);
+    double width = GetGlyphRunTypographicWidth(_font, glyphIndexes, stringLength, _fontSize);
+
+    free(glyphIndexes);
+    return width;
+}
 
+//(PUBLIC)
+//returns the width of the glyphs in pixels (without the left-side bearing of the first glyph and the right-side bearing of the last glyph)
+//the glyphs are positioned by their advance widths and the kerning between them
+//_fontSize is specified in pixels
+//_numberOfGlyphs >= 1 ->
+double GetGlyphRunGraphemicWidth(const Font* _font, const unsigned short* _glyphIndexes, int _numberOfGlyphs, double _fontSize)
+{
     double SCALE = GetScale(_font, _fontSize);
 
     int currentWidth = 0;
-    int stringLength = wcslen(_string);
 
-    ///characters (0..last)
+    ///glyphs (0..last)
 
-    for (int i = 0; i < stringLength; i++)
+    for (int i = 0; i < _numberOfGlyphs; i++)
     {
-        int index = GetGlyphIndex(_font, _string[i]);
-        double advanceWidth = hmtx->HorizontalMetrics[index].AdvanceWidth;
+        double advanceWidth = GetGlyphAdvanceWidth(_font, _glyphIndexes[i]);
 
-        if (i < stringLength - 1)
+        if (i < _numberOfGlyphs - 1)
         {
-            int kerning = GetKerning(_font, _string[i], _string[i + 1]);
+            int kerning = GetGlyphKerning(_font, _glyphIndexes[i], _glyphIndexes[i + 1]);
 
-            //if there is no kerning between the two characters
+            //if there is no kerning between the two glyphs
             if (kerning == INT_MIN)
             {
                 currentWidth += advanceWidth;
             }
-                //if there is negative kerning between the two characters
+                //if there is negative kerning between the two glyphs
             else if (kerning < 0)
             {
                 currentWidth += advanceWidth - (0 - kerning);
             }
-                //if there is positive kerning between the two characters
+                //if there is positive kerning between the two glyphs
             else
             {
                 currentWidth += advanceWidth + kerning;
@@ -3505,9 +4373,9 @@ double GetGraphemicWidth(const Font* _font, const wchar_t* _string, double _font
         }
     }
 
-    ///left-side bearing of the first character in the string
+    ///left-side bearing of the first glyph
 
-    double firstCharacterLeftSideBearing = GetLeftSideBearing(_font, _string[0]);
+    double firstCharacterLeftSideBearing = GetGlyphLeftSideBearing(_font, _glyphIndexes[0]);
 
     //negative left-side bearing
     if (firstCharacterLeftSideBearing < 0)
@@ -3520,9 +4388,9 @@ double GetGraphemicWidth(const Font* _font, const wchar_t* _string, double _font
         currentWidth -= firstCharacterLeftSideBearing;
     }
 
-    ///right-side bearing of the last character in the string
+    ///right-side bearing of the last glyph
 
-    double lastCharacterRightSideBearing = GetRightSideBearing(_font,  _string[stringLength - 1]);
+    double lastCharacterRightSideBearing = GetGlyphRightSideBearing(_font, _glyphIndexes[_numberOfGlyphs - 1]);
 
     //negative right-side bearing
     if (lastCharacterRightSideBearing < 0)
@@ -3541,17 +4409,32 @@ double GetGraphemicWidth(const Font* _font, const wchar_t* _string, double _font
 }
 
 //(PUBLIC)
-//returns the graphemic height of the string in pixels (the distance between the lowest and the highest graphemic point in the string)
+//returns the width of the string in pixels (without the left-side bearing of the first character and the right-side bearing of the last character)
 //_fontSize is specified in pixels
-double GetGraphemicHeight(const Font* _font, const wchar_t* _string, double _fontSize)
+//_string.length() >= 1 ->
+double GetGraphemicWidth(const Font* _font, const wchar_t* _string, double _fontSize)
+{
+    int stringLength = wcslen(_string);
+    unsigned short* glyphIndexes = malloc(sizeof(unsigned short) * stringLength);
+    MapString(_font, _string, stringLength, glyphIndexes);
+
+    double width = GetGlyphRunGraphemicWidth(_font, glyphIndexes, stringLength, _fontSize);
+
+    free(glyphIndexes);
+    return width;
+}
+
+//(PUBLIC)
+//returns the graphemic height of the glyphs in pixels (the distance between the lowest and the highest graphemic point of the glyphs)
+//_fontSize is specified in pixels
+double GetGlyphRunGraphemicHeight(const Font* _font, const unsigned short* _glyphIndexes, int _numberOfGlyphs, double _fontSize)
 {
     int minY = -1;
     int maxY = -1;
-    int stringLength = wcslen(_string);
 
-    for (int i = 0; i < stringLength; i++)
+    for (int i = 0; i < _numberOfGlyphs; i++)
     {
-        void* glyph = GetGlyph(_font, _string[i]);
+        void* glyph = GetGlyphByIndex(_font, _glyphIndexes[i]);
 
         if (Is(glyph, EMPTY_GLYPH))
         {
@@ -3590,6 +4473,53 @@ double GetGraphemicHeight(const Font* _font, const wchar_t* _string, double _fon
     return (maxY - minY) * GetScale(_font, _fontSize);
 }
 
+//(PUBLIC)
+//returns the graphemic height of the string in pixels (the distance between the lowest and the highest graphemic point in the string)
+//_fontSize is specified in pixels
+double GetGraphemicHeight(const Font* _font, const wchar_t* _string, double _fontSize)
+{
+    int stringLength = wcslen(_string);
+    unsigned short* glyphIndexes = malloc(sizeof(unsigned short) * stringLength);
+    MapString(_font, _string, stringLength, glyphIndexes);
+
+    double height = GetGlyphRunGraphemicHeight(_font, glyphIndexes, stringLength, _fontSize);
+
+    free(glyphIndexes);
+    return height;
+}
+
+//(PUBLIC)
+/* computes the horizontal positions (in pixels) of the glyphs - every glyph is positioned after the previous one using its advance width and
+   the kerning between them; _positions[0] is 0 and the positions are relative to it (the format used by DrawGlyphRun) */
+//_positions has space for (atleast) _numberOfGlyphs elements ->
+void GetGlyphRunPositions(const Font* _font, const unsigned short* _glyphIndexes, int _numberOfGlyphs, double _fontSize, double* _positions)
+{
+    double SCALE = GetScale(_font, _fontSize);
+
+    double position = 0;
+
+    for (int i = 0; i < _numberOfGlyphs; i++)
+    {
+        _positions[i] = position;
+
+        if (i < _numberOfGlyphs - 1)
+        {
+            int kerning = GetGlyphKerning(_font, _glyphIndexes[i], _glyphIndexes[i + 1]);
+            double advanceWidth = GetGlyphAdvanceWidth(_font, _glyphIndexes[i]) * SCALE;
+
+            //if there is no kerning between the two glyphs
+            if (kerning == INT_MIN)
+            {
+                position += advanceWidth;
+            }
+            else
+            {
+                position += advanceWidth + kerning * SCALE;
+            }
+        }
+    }
+}
+
 //(PRIVATE)
 //(LOCAL-TO DrawString)
 bool IsWhitespace(int _character)
@@ -3600,29 +4530,21 @@ bool IsWhitespace(int _character)
            _character == 8232 || _character == 8233 || _character == 8239 || _character == 8287 || _character == 12288;
 }
 
-//(PUBLIC)
-//_canvas is (a RGBA or BGRA pixel array) in which the character is drawn
-//Y_Direction specifies the direction in which the Y-coordinates grow (top-to-bottom or bottom-up)
-//_colorComponentOrder specifies if the pixels in _canvas are RGBA or BGRA
-//_canvasWidth and _canvasHeight are the width and height of the canvas specified in pixels
-//_horizonalPosition specifies the position (in pixels) of the leftmost graphemic point of the string
-//_verticalPosition specifies the position (in pixels) of the baseline
-//_fontSize is the height of the line in pixels
-//_numberOfColors should be equal (or larger) to the number of elements in _colors
-//_transparency = 0 means fully opaque string, and 100 means fully transparent string
-/*_maxGraphemicX specifies a limiting X coordinate in the canvas (not an X coordinate in the string itself) - i.e. the part of the
-   string after this coordinate will not be visualized; a value of -1 specifies that there is no horizontal limit;
-   this coordinate is inclusive, i.e. the column matching the coordinate will also be visualized */
-/* (!!!) this is a non-validating function; the font must contain all the (glyphs corresponding to the characters in the specified string)
-         and the parameters must have correct values */
-void DrawString(
+//(LOCAL-TO DrawString and DrawGlyphRun)
+/* draws the glyphs at the specified horizontal positions (in pixels, in the canvas); the string bounds in _context (StringBeginX, StringBeginY,
+   StringWidth and StringHeight) have to be set by the caller; _string contains the characters corresponding to the glyphs, if they are known, or it's NULL - it's used only
+   for detection of the whitespace characters (without it the empty glyphs are treated as whitespace) */
+void drawGlyphs(
+        tt_RasterContext* _context,
         const wchar_t* _string,
+        const unsigned short* _glyphIndexes,
+        const double* _positions,
+        int _numberOfGlyphs,
         const Font* _font,
         unsigned char* _canvas,
         ColorComponentOrder _colorComponentOrder,
         int _canvasWidth,
         int _canvasHeight,
-        double _horizontalPosition,
         double _verticalPosition,
         double _fontSize,
         StringColorizationMode _colorizationMode,
@@ -3631,24 +4553,15 @@ void DrawString(
         int _transparency,
         int _maxGraphemicX)
 {
-    double SCALE = GetScale(_font, _fontSize);
-    HMTX_Table* hmtx = (HMTX_Table*) GetTable(_font, HMTX_TABLE);
-    int stringLength = wcslen(_string);
-    int lsb = GetLeftSideBearing(_font, _string[0]);
-    _horizontalPosition -= lsb * SCALE;
-
-    StringBeginX = _horizontalPosition;
-    StringBeginY = _verticalPosition + GetDescent(_font, _string, stringLength) * SCALE;
-    StringWidth = GetGraphemicWidth(_font, _string, _fontSize);
-    StringHeight = GetGraphemicHeight(_font, _string, _fontSize);
-
     int groupElementIndex = 0;
-    for (int i = 0; i < stringLength; i++)
+    for (int i = 0; i < _numberOfGlyphs; i++)
     {
         const tt_rgba* colors;
 
         enum GlyphColorizationMode glyphColorizationMode;
 
+        bool isWhitespace = _string != NULL ? IsWhitespace(_string[i]) : Is(GetGlyphByIndex(_font, _glyphIndexes[i]), EMPTY_GLYPH);
+
         if (_colorizationMode == SCM_SOLID_IDENTICAL)
         {
             colors = &_colors[0];
@@ -3657,7 +4570,7 @@ void DrawString(
         else if (_colorizationMode == SCM_SOLID_INDIVIDUAL)
         {
             //move to the next color if the glyph is not empty
-            if (!IsWhitespace(_string[i]))
+            if (!isWhitespace)
             {
                 if (groupElementIndex + 1 < _numberOfColors)
                 {
@@ -3675,7 +4588,7 @@ void DrawString(
         }
         else if (_colorizationMode == SCM_SOLID_WORD)
         {
-            if (IsWhitespace(_string[i]))
+            if (isWhitespace)
             {
                 if (groupElementIndex + 1 < _numberOfColors)
                 {
@@ -3712,15 +4625,16 @@ void DrawString(
             glyphColorizationMode = GCM_S_VERTICAL_GRADIENT;
         }
 
-        DrawCharacter(
-                _string[i],
+        DrawCharacterWithContext(
+                _context,
+                0 - _glyphIndexes[i],
                 NULL,
                 _font,
                 _canvas,
                 _colorComponentOrder,
                 _canvasWidth,
                 _canvasHeight,
-                _horizontalPosition,
+                _positions[i],
                 _verticalPosition,
                 _fontSize,
                 glyphColorizationMode,
@@ -3732,37 +4646,254 @@ void DrawString(
                 0.0,
                 0.0,
                 0.0);
+    }
+}
+
+//(PUBLIC)
+//_canvas is (a RGBA or BGRA pixel array) in which the character is drawn
+//Y_Direction specifies the direction in which the Y-coordinates grow (top-to-bottom or bottom-up)
+//_colorComponentOrder specifies if the pixels in _canvas are RGBA or BGRA
+//_canvasWidth and _canvasHeight are the width and height of the canvas specified in pixels
+//_horizonalPosition specifies the position (in pixels) of the leftmost graphemic point of the string
+//_verticalPosition specifies the position (in pixels) of the baseline
+//_fontSize is the height of the line in pixels
+//_numberOfColors should be equal (or larger) to the number of elements in _colors
+//_transparency = 0 means fully opaque string, and 100 means fully transparent string
+/*_maxGraphemicX specifies a limiting X coordinate in the canvas (not an X coordinate in the string itself) - i.e. the part of the
+   string after this coordinate will not be visualized; a value of -1 specifies that there is no horizontal limit;
+   this coordinate is inclusive, i.e. the column matching the coordinate will also be visualized */
+/* (!!!) this is a non-validating function; the font must contain all the (glyphs corresponding to the characters in the specified string)
+         and the parameters must have correct values */
+void DrawStringWithContext(
+        tt_RasterContext* _context,
+        const wchar_t* _string,
+        const Font* _font,
+        unsigned char* _canvas,
+        ColorComponentOrder _colorComponentOrder,
+        int _canvasWidth,
+        int _canvasHeight,
+        double _horizontalPosition,
+        double _verticalPosition,
+        double _fontSize,
+        StringColorizationMode _colorizationMode,
+        const tt_rgba* _colors,
+        int _numberOfColors,
+        int _transparency,
+        int _maxGraphemicX)
+{
+    int stringLength = wcslen(_string);
+
+    if (stringLength < 1)
+    {
+        return;
+    }
 
-        double scaledKerning = 0;
+    double SCALE = GetScale(_font, _fontSize);
 
-        if (i < stringLength - 1)
-        {
-            int kerning = GetKerning(_font, _string[i], _string[i + 1]);
+    //(NOTE) the characters are converted to glyph indexes only once; everything below works with the glyph indexes
+    unsigned short* glyphIndexes = malloc(sizeof(unsigned short) * stringLength);
+    double* positions = malloc(sizeof(double) * stringLength);
+    MapString(_font, _string, stringLength, glyphIndexes);
 
-            //if there is kerning between the two characters
-            if (kerning != INT_MIN)
-            {
-                scaledKerning = kerning * SCALE;
-            }
+    int lsb = GetGlyphLeftSideBearing(_font, glyphIndexes[0]);
+    _horizontalPosition -= lsb * SCALE;
+
+    _context->StringBeginX = _horizontalPosition;
+    _context->StringBeginY = _verticalPosition + GetGlyphRunDescent(_font, glyphIndexes, stringLength) * SCALE;
+    _context->StringWidth = GetGlyphRunGraphemicWidth(_font, glyphIndexes, stringLength, _fontSize);
+    _context->StringHeight = GetGlyphRunGraphemicHeight(_font, glyphIndexes, stringLength, _fontSize);
 
-            int glyphIndex = GetGlyphIndex(_font, _string[i]);
-            double advanceWidth = hmtx->HorizontalMetrics[glyphIndex].AdvanceWidth * SCALE;
+    //the positions are accumulated from the beginning of the string (instead of using GetGlyphRunPositions) to avoid rounding differences
+    for (int i = 0; i < stringLength; i++)
+    {
+        positions[i] = _horizontalPosition;
+
+        if (i < stringLength - 1)
+        {
+            int kerning = GetGlyphKerning(_font, glyphIndexes[i], glyphIndexes[i + 1]);
+            double advanceWidth = GetGlyphAdvanceWidth(_font, glyphIndexes[i]) * SCALE;
 
             //if there is no kerning between the two characters
             if (kerning == INT_MIN)
             {
                 _horizontalPosition += advanceWidth;
             }
-                //if there is negative kerning between the two characters
-            else if (scaledKerning < 0)
-            {
-                _horizontalPosition += advanceWidth - (0 - scaledKerning);
-            }
-                //if there is positive kerning between the two characters
             else
             {
-                _horizontalPosition += advanceWidth + scaledKerning;
+                _horizontalPosition += advanceWidth + kerning * SCALE;
             }
         }
     }
+
+    drawGlyphs(
+            _context,
+            _string,
+            glyphIndexes,
+            positions,
+            stringLength,
+            _font,
+            _canvas,
+            _colorComponentOrder,
+            _canvasWidth,
+            _canvasHeight,
+            _verticalPosition,
+            _fontSize,
+            _colorizationMode,
+            _colors,
+            _numberOfColors,
+            _transparency,
+            _maxGraphemicX);
+
+    free(glyphIndexes);
+    free(positions);
+}
+
+//(PUBLIC)
+//the same as DrawStringWithContext, using the default context (see tt_RasterContext)
+void DrawString(
+        const wchar_t* _string,
+        const Font* _font,
+        unsigned char* _canvas,
+        ColorComponentOrder _colorComponentOrder,
+        int _canvasWidth,
+        int _canvasHeight,
+        double _horizontalPosition,
+        double _verticalPosition,
+        double _fontSize,
+        StringColorizationMode _colorizationMode,
+        const tt_rgba* _colors,
+        int _numberOfColors,
+        int _transparency,
+        int _maxGraphemicX)
+{
+    DrawStringWithContext(
+            &DefaultRasterContext,
+            _string,
+            _font,
+            _canvas,
+            _colorComponentOrder,
+            _canvasWidth,
+            _canvasHeight,
+            _horizontalPosition,
+            _verticalPosition,
+            _fontSize,
+            _colorizationMode,
+            _colors,
+            _numberOfColors,
+            _transparency,
+            _maxGraphemicX);
+}
+
+//(PUBLIC)
+//the same as DrawStringWithContext, but it draws glyphs that are already resolved (for example by MapString) instead of characters
+//_glyphIndexes are the glyphs (in the table 'glyf') that are drawn
+/* _positions are the horizontal positions (in pixels) of the glyphs, relative to the first glyph, i.e. _positions[0] should be 0;
+   the positions for the default layout (advance widths and kerning) can be computed with GetGlyphRunPositions */
+//_horizonalPosition specifies the position (in pixels) of the leftmost graphemic point of the first glyph
+//(!!!) this is a non-validating function; the glyph indexes must be valid and the parameters must have correct values
+void DrawGlyphRunWithContext(
+        tt_RasterContext* _context,
+        const unsigned short* _glyphIndexes,
+        const double* _positions,
+        int _numberOfGlyphs,
+        const Font* _font,
+        unsigned char* _canvas,
+        ColorComponentOrder _colorComponentOrder,
+        int _canvasWidth,
+        int _canvasHeight,
+        double _horizontalPosition,
+        double _verticalPosition,
+        double _fontSize,
+        StringColorizationMode _colorizationMode,
+        const tt_rgba* _colors,
+        int _numberOfColors,
+        int _transparency,
+        int _maxGraphemicX)
+{
+    if (_numberOfGlyphs < 1)
+    {
+        return;
+    }
+
+    double SCALE = GetScale(_font, _fontSize);
+    double* positions = malloc(sizeof(double) * _numberOfGlyphs);
+
+    int lsb = GetGlyphLeftSideBearing(_font, _glyphIndexes[0]);
+    _horizontalPosition -= lsb * SCALE;
+
+    for (int i = 0; i < _numberOfGlyphs; i++)
+    {
+        positions[i] = _horizontalPosition + _positions[i];
+    }
+
+    ///the bounds of the run (used by the string gradients)
+
+    int last = _numberOfGlyphs - 1;
+    double right = positions[last] + (GetGlyphAdvanceWidth(_font, _glyphIndexes[last]) - GetGlyphRightSideBearing(_font, _glyphIndexes[last])) * SCALE;
+
+    _context->StringBeginX = _horizontalPosition;
+    _context->StringBeginY = _verticalPosition + GetGlyphRunDescent(_font, _glyphIndexes, _numberOfGlyphs) * SCALE;
+    _context->StringWidth = right - (_horizontalPosition + lsb * SCALE);
+    _context->StringHeight = GetGlyphRunGraphemicHeight(_font, _glyphIndexes, _numberOfGlyphs, _fontSize);
+
+    drawGlyphs(
+            _context,
+            NULL,
+            _glyphIndexes,
+            positions,
+            _numberOfGlyphs,
+            _font,
+            _canvas,
+            _colorComponentOrder,
+            _canvasWidth,
+            _canvasHeight,
+            _verticalPosition,
+            _fontSize,
+            _colorizationMode,
+            _colors,
+            _numberOfColors,
+            _transparency,
+            _maxGraphemicX);
+
+    free(positions);
+}
+
+//(PUBLIC)
+//the same as DrawGlyphRunWithContext, using the default context (see tt_RasterContext)
+void DrawGlyphRun(
+        const unsigned short* _glyphIndexes,
+        const double* _positions,
+        int _numberOfGlyphs,
+        const Font* _font,
+        unsigned char* _canvas,
+        ColorComponentOrder _colorComponentOrder,
+        int _canvasWidth,
+        int _canvasHeight,
+        double _horizontalPosition,
+        double _verticalPosition,
+        double _fontSize,
+        StringColorizationMode _colorizationMode,
+        const tt_rgba* _colors,
+        int _numberOfColors,
+        int _transparency,
+        int _maxGraphemicX)
+{
+    DrawGlyphRunWithContext(
+            &DefaultRasterContext,
+            _glyphIndexes,
+            _positions,
+            _numberOfGlyphs,
+            _font,
+            _canvas,
+            _colorComponentOrder,
+            _canvasWidth,
+            _canvasHeight,
+            _horizontalPosition,
+            _verticalPosition,
+            _fontSize,
+            _colorizationMode,
+            _colors,
+            _numberOfColors,
+            _transparency,
+            _maxGraphemicX);
 }